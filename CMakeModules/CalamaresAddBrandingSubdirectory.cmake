@@ -28,6 +28,7 @@
 include( CMakeParseArguments)
 
 include( CMakeColors )
+include( CalamaresQmlCache )
 
 # Usage calamares_add_branding( <name> [DIRECTORY <dir>] [SUBDIRECTORIES <dir> ...])
 #
@@ -44,6 +45,8 @@ include( CMakeColors )
 #
 # If SUBDIRECTORIES are given, then those are copied (each one level deep)
 # to the installation location as well, preserving the subdirectory name.
+#
+# QML files (e.g. the slideshow) are precompiled, see calamares_qmlcache().
 function( calamares_add_branding NAME )
     cmake_parse_arguments( _CABT "" "DIRECTORY" "SUBDIRECTORIES" ${ARGN} )
     if (NOT _CABT_DIRECTORY)
@@ -57,6 +60,7 @@ function( calamares_add_branding NAME )
     set( BRANDING_COMPONENT_DESTINATION ${BRANDING_DIR}/${NAME} )
 
     foreach( _subdir "" ${_CABT_SUBDIRECTORIES} )
+        set( _qml_files "" )
         file( GLOB BRANDING_COMPONENT_FILES RELATIVE ${CMAKE_CURRENT_SOURCE_DIR}/${_brand_dir} "${_brand_dir}/${_subdir}/*" )
         foreach( BRANDING_COMPONENT_FILE ${BRANDING_COMPONENT_FILES} )
             set( _subpath ${_brand_dir}/${BRANDING_COMPONENT_FILE} )
@@ -69,8 +73,15 @@ function( calamares_add_branding NAME )
 
                 install( FILES ${CMAKE_CURRENT_BINARY_DIR}/${_subpath}
                             DESTINATION ${BRANDING_COMPONENT_DESTINATION}/${_subdir}/ )
+                list( APPEND _qml_files ${_subpath} )
             endif()
         endforeach()
+        string( MAKE_C_IDENTIFIER "branding-qmlcache-${NAME}-${_subdir}" _qml_target )
+        calamares_qmlcache(
+            TARGET ${_qml_target}
+            DESTINATION ${BRANDING_COMPONENT_DESTINATION}/${_subdir}/
+            FILES ${_qml_files}
+        )
     endforeach()
 
     message( "-- ${BoldYellow}Found ${CALAMARES_APPLICATION_NAME} branding component: ${BoldRed}${NAME}${ColorReset}" )
@@ -52,9 +52,17 @@ function(calamares_add_library)
     include_directories(${CMAKE_CURRENT_LIST_DIR})
     include_directories(${CMAKE_CURRENT_BINARY_DIR})
 
-    # add resources from current dir
+    # add resources from current dir; QML in resources is precompiled
+    # with the Qt Quick Compiler, if available.
+    set(_library_compiled_resources OFF)
     if(LIBRARY_RESOURCES)
-        list(APPEND LIBRARY_SOURCES ${LIBRARY_RESOURCES})
+        if(BUILD_QMLCACHE AND Qt5QuickCompiler_FOUND)
+            qtquick_compiler_add_resources(_library_resource_sources ${LIBRARY_RESOURCES})
+            list(APPEND LIBRARY_SOURCES ${_library_resource_sources})
+            set(_library_compiled_resources ON)
+        else()
+            list(APPEND LIBRARY_SOURCES ${LIBRARY_RESOURCES})
+        endif()
     endif()
 
     # add target
@@ -70,7 +78,7 @@ function(calamares_add_library)
     if(LIBRARY_UI)
         calamares_autouic(${target} ${LIBRARY_UI})
     endif()
-    if(LIBRARY_RESOURCES)
+    if(LIBRARY_RESOURCES AND NOT _library_compiled_resources)
         calamares_autorcc(${target} ${LIBRARY_RESOURCES})
     endif()
 
@@ -0,0 +1,75 @@
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+#   Calamares is Free Software: see the License-Identifier above.
+#
+#
+###
+#
+# Support functions for precompiling QML files.
+#
+# QML files that are installed as plain files (e.g. the QML modules
+# in src/qml and branding slideshows) are compiled by the QML engine
+# when they are first loaded. Qt can use a compilation unit (.qmlc)
+# that lives next to the .qml file instead, which is produced at
+# build-time by qmlcachegen. The .qmlc file is only used if it
+# matches the .qml file exactly (including timestamp), so the .qml
+# files must be installed from the same place the .qmlc was
+# generated from.
+#
+# QML files that are compiled into resources (.qrc) are handled by
+# calamares_add_library() using the Qt Quick Compiler, if it is found.
+#
+# Usage:
+#
+# calamares_qmlcache(
+#   TARGET target-name
+#   DESTINATION install-dir
+#   FILES qml-file...
+# )
+#
+# The FILES are relative to the current binary directory (where they
+# should have been copied already, e.g. with configure_file()). For each
+# file, a .qmlc is generated next to it and installed to the DESTINATION,
+# which should be where the .qml file is installed as well. If qmlcachegen
+# cannot be found (or BUILD_QMLCACHE is OFF), nothing is done.
+include( CMakeParseArguments )
+
+if( NOT DEFINED BUILD_QMLCACHE )
+    set( BUILD_QMLCACHE ON )
+endif()
+
+if( BUILD_QMLCACHE AND NOT QMLCACHEGEN_EXECUTABLE AND TARGET Qt5::qmake )
+    get_target_property( _qmake_location Qt5::qmake IMPORTED_LOCATION )
+    get_filename_component( _qt_bin_dir ${_qmake_location} DIRECTORY )
+    find_program( QMLCACHEGEN_EXECUTABLE qmlcachegen HINTS ${_qt_bin_dir} )
+endif()
+
+function( calamares_qmlcache )
+    cmake_parse_arguments( _CAQC "" "TARGET;DESTINATION" "FILES" ${ARGN} )
+    if( NOT BUILD_QMLCACHE OR NOT QMLCACHEGEN_EXECUTABLE )
+        return()
+    endif()
+
+    set( _outputs "" )
+    foreach( _qml ${_CAQC_FILES} )
+        if( _qml MATCHES "\\.qml$" )
+            set( _src ${CMAKE_CURRENT_BINARY_DIR}/${_qml} )
+            set( _dst ${_src}c )
+            add_custom_command(
+                OUTPUT ${_dst}
+                COMMAND ${QMLCACHEGEN_EXECUTABLE} -o ${_dst} ${_src}
+                DEPENDS ${_src}
+                COMMENT "Precompiling QML ${_qml}"
+            )
+            list( APPEND _outputs ${_dst} )
+            install( FILES ${_dst} DESTINATION ${_CAQC_DESTINATION} )
+        endif()
+    endforeach()
+
+    if( _outputs )
+        add_custom_target( ${_CAQC_TARGET} ALL DEPENDS ${_outputs} )
+    endif()
+endfunction()
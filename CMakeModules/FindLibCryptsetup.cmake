@@ -0,0 +1,50 @@
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+###
+#
+# Locate libcryptsetup
+#   https://gitlab.com/cryptsetup/cryptsetup
+#
+# This module defines
+#  LibCryptsetup_FOUND
+#  LibCryptsetup_LIBRARIES, where to find the library
+#  LibCryptsetup_INCLUDE_DIRS, where to find libcryptsetup.h
+#
+find_package(PkgConfig)
+include(FindPackageHandleStandardArgs)
+
+if(PkgConfig_FOUND)
+    pkg_search_module(pc_cryptsetup QUIET libcryptsetup)
+else()
+    # It's just possible that the find_path and find_library will
+    # find it **anyway**, so let's pretend it was there.
+    set(pc_cryptsetup_FOUND ON)
+endif()
+
+find_path(LibCryptsetup_INCLUDE_DIR
+    NAMES libcryptsetup.h
+    PATHS ${pc_cryptsetup_INCLUDE_DIRS}
+)
+find_library(LibCryptsetup_LIBRARY
+    NAMES cryptsetup
+    PATHS ${pc_cryptsetup_LIBRARY_DIRS}
+)
+if(pc_cryptsetup_FOUND)
+    set(LibCryptsetup_LIBRARIES ${LibCryptsetup_LIBRARY})
+    set(LibCryptsetup_INCLUDE_DIRS ${LibCryptsetup_INCLUDE_DIR} ${pc_cryptsetup_INCLUDE_DIRS})
+endif()
+
+find_package_handle_standard_args(LibCryptsetup DEFAULT_MSG
+    LibCryptsetup_INCLUDE_DIRS
+    LibCryptsetup_LIBRARIES
+)
+mark_as_advanced(LibCryptsetup_INCLUDE_DIRS LibCryptsetup_LIBRARIES)
+
+set_package_properties(
+    LibCryptsetup PROPERTIES
+    DESCRIPTION "Disk encryption setup library"
+    URL "https://gitlab.com/cryptsetup/cryptsetup"
+)
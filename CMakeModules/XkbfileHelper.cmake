@@ -0,0 +1,30 @@
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 agent <agent@local>
+#   SPDX-License-Identifier: BSD-2-Clause
+#
+###
+#
+# Finds X11 with libxkbfile, for the keyboard modules which talk to
+# the XKB extension directly (instead of running setxkbmap).
+# Sets Xkbfile_LIBRARIES and Xkbfile_INCLUDE_DIRS, and adds
+# HAVE_XKBFILE to Xkbfile_DEFINITIONS, if it is found.
+#
+if ( NOT Xkbfile_searched_for )
+    set( Xkbfile_searched_for TRUE )
+
+    find_package( X11 )
+    set_package_properties(
+        X11 PROPERTIES
+        PURPOSE "Switch keyboard layouts without running setxkbmap (needs libxkbfile)"
+    )
+
+    set( Xkbfile_LIBRARIES "" )
+    set( Xkbfile_INCLUDE_DIRS "" )
+    set( Xkbfile_DEFINITIONS "" )
+    if( X11_FOUND AND X11_Xkbfile_FOUND )
+        set( Xkbfile_LIBRARIES ${X11_X11_LIB} ${X11_Xkbfile_LIB} )
+        set( Xkbfile_INCLUDE_DIRS ${X11_INCLUDE_DIR} ${X11_Xkbfile_INCLUDE_PATH} )
+        set( Xkbfile_DEFINITIONS HAVE_XKBFILE )
+    endif()
+endif()
@@ -22,6 +22,7 @@
 #include "utils/CalamaresUtilsGui.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Dirs.h"
+#include "utils/HostInfo.h"
 #include "utils/Logger.h"
 #ifdef WITH_QML
 #include "utils/Qml.h"
@@ -75,6 +76,8 @@ CalamaresApplication::init()
         cError() << "Must create Calamares::Settings before the application.";
         ::exit( 1 );
     }
+    // Modules ask about the machine, so find out while the rest starts up
+    CalamaresUtils::startHostInfo();
     initQmlPath();
     initBranding();
 
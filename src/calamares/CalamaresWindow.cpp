@@ -85,7 +85,10 @@ CalamaresWindow::getWidgetSidebar( QWidget* parent, int desiredWidth )
     }
     logoLabel->setAlignment( Qt::AlignCenter );
     logoLabel->setFixedSize( 80, 80 );
-    logoLabel->setPixmap( branding->image( Calamares::Branding::ProductLogo, logoLabel->size() ) );
+    branding->imageAsync( Calamares::Branding::ProductLogo,
+                          logoLabel->size(),
+                          logoLabel,
+                          [logoLabel]( const QPixmap& pixmap ) { logoLabel->setPixmap( pixmap ); } );
     logoLayout->addWidget( logoLabel );
     logoLayout->addStretch();
 
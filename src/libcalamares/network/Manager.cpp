@@ -12,11 +12,15 @@
 #include "utils/Logger.h"
 
 #include <QEventLoop>
+#include <QCoreApplication>
+#include <QDir>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QStandardPaths>
 #include <QThread>
 #include <QTimer>
 
@@ -39,6 +43,19 @@ RequestOptions::applyToRequest( QNetworkRequest* request ) const
         // sourceforge.net), so let's set a more descriptive one.
         request->setRawHeader( "User-Agent", "Mozilla/5.0 (compatible; Calamares)" );
     }
+
+    if ( m_flags & Flag::UseDiskCache )
+    {
+        // Use the network, but send a conditional request if there is a cached copy;
+        // a 304 Not Modified reply then delivers the cached data.
+        request->setAttribute( QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork );
+        request->setAttribute( QNetworkRequest::CacheSaveControlAttribute, true );
+    }
+    else
+    {
+        request->setAttribute( QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork );
+        request->setAttribute( QNetworkRequest::CacheSaveControlAttribute, false );
+    }
 }
 
 class Manager::Private : public QObject
@@ -60,6 +77,8 @@ public:
     Private();
 
     QNetworkAccessManager* nam();
+    /// @brief Gives @p nam a disk cache, if it does not have one yet
+    static void ensureDiskCache( QNetworkAccessManager* nam );
 };
 
 Manager::Private::Private()
@@ -101,6 +120,33 @@ Manager::Private::nam()
     return nam;
 }
 
+void
+Manager::Private::ensureDiskCache( QNetworkAccessManager* nam )
+{
+    if ( nam->cache() )
+    {
+        return;
+    }
+
+    // The cache directory cannot be shared between NAMs, so only the
+    // one in the main thread gets a cache.
+    if ( !QCoreApplication::instance() || QThread::currentThread() != QCoreApplication::instance()->thread() )
+    {
+        return;
+    }
+    QString dir = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+    if ( dir.isEmpty() )
+    {
+        cWarning() << "No cache location for network data.";
+        return;
+    }
+    dir = QDir( dir ).filePath( QStringLiteral( "network" ) );
+
+    auto* cache = new QNetworkDiskCache( nam );
+    cache->setCacheDirectory( dir );
+    nam->setCache( cache );
+}
+
 void
 Manager::Private::cleanupNam()
 {
@@ -274,14 +320,24 @@ Manager::synchronousGet( const QUrl& url, const RequestOptions& options )
         return QByteArray();
     }
 
-    auto reply = synchronousRun( d->nam(), url, options );
+    auto* nam = d->nam();
+    if ( options.useDiskCache() )
+    {
+        Private::ensureDiskCache( nam );
+    }
+    auto reply = synchronousRun( nam, url, options );
     return reply.first ? reply.second->readAll() : QByteArray();
 }
 
 QNetworkReply*
 Manager::asynchronousGet( const QUrl& url, const CalamaresUtils::Network::RequestOptions& options )
 {
-    return asynchronousRun( d->nam(), url, options );
+    auto* nam = d->nam();
+    if ( options.useDiskCache() )
+    {
+        Private::ensureDiskCache( nam );
+    }
+    return asynchronousRun( nam, url, options );
 }
 
 QDebug&
@@ -35,7 +35,17 @@ public:
     enum Flag
     {
         FollowRedirect = 0x1,
-        FakeUserAgent = 0x100
+        FakeUserAgent = 0x100,
+        /** @brief Keep a copy of the data on disk
+         *
+         * The reply is stored in an on-disk cache (in the user's
+         * cache directory). Subsequent requests for the same URL
+         * are conditional (using ETag or Last-Modified from the
+         * cached copy), so unchanged data is not downloaded again.
+         * Requests without this flag never use the cache. Only
+         * requests made from the main thread are cached.
+         */
+        UseDiskCache = 0x200
     };
     Q_DECLARE_FLAGS( Flags, Flag )
 
@@ -56,6 +66,8 @@ public:
     bool hasTimeout() const { return m_timeout > milliseconds( 0 ); }
     auto timeout() const { return m_timeout; }
 
+    bool useDiskCache() const { return m_flags & Flag::UseDiskCache; }
+
 private:
     Flags m_flags;
     milliseconds m_timeout;
@@ -12,6 +12,7 @@
 #include "Manager.h"
 #include "utils/Logger.h"
 
+#include <QNetworkRequest>
 #include <QtTest/QtTest>
 
 QTEST_GUILESS_MAIN( NetworkTests )
@@ -60,3 +61,23 @@ NetworkTests::testPing()
         QVERIFY( canPing_www_kde_org );
     }
 }
+
+void
+NetworkTests::testCacheOptions()
+{
+    using namespace CalamaresUtils::Network;
+
+    QNetworkRequest plain( QUrl( "http://example.com" ) );
+    RequestOptions( RequestOptions::FollowRedirect ).applyToRequest( &plain );
+    QCOMPARE( plain.attribute( QNetworkRequest::CacheSaveControlAttribute ).toBool(), false );
+    QCOMPARE( plain.attribute( QNetworkRequest::CacheLoadControlAttribute ).toInt(),
+              int( QNetworkRequest::AlwaysNetwork ) );
+
+    QNetworkRequest cached( QUrl( "http://example.com" ) );
+    RequestOptions options( RequestOptions::FollowRedirect | RequestOptions::UseDiskCache );
+    QVERIFY( options.useDiskCache() );
+    options.applyToRequest( &cached );
+    QCOMPARE( cached.attribute( QNetworkRequest::CacheSaveControlAttribute ).toBool(), true );
+    QCOMPARE( cached.attribute( QNetworkRequest::CacheLoadControlAttribute ).toInt(),
+              int( QNetworkRequest::PreferNetwork ) );
+}
@@ -24,6 +24,7 @@ private Q_SLOTS:
 
     void testInstance();
     void testPing();
+    void testCacheOptions();
 };
 
 #endif
@@ -0,0 +1,119 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Disks.h"
+
+#include "utils/Logger.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/// @brief Reads the number in (sysfs) file @p path, or returns @p defaultValue
+static qint64
+readNumber( const QString& path, qint64 defaultValue )
+{
+    QFile f( path );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return defaultValue;
+    }
+    bool ok = false;
+    const qint64 value = f.readAll().trimmed().toLongLong( &ok );
+    return ok ? value : defaultValue;
+}
+
+static DiskType
+diskType( const QString& name, const QDir& dir )
+{
+    if ( name.startsWith( "ram" ) || name.startsWith( "zram" ) )
+    {
+        return DiskType::Memory;
+    }
+    if ( name.startsWith( "loop" ) )
+    {
+        return DiskType::Loop;
+    }
+    if ( name.startsWith( "dm-" ) )
+    {
+        return DiskType::Mapper;
+    }
+    if ( name.startsWith( "fd" ) )
+    {
+        return DiskType::Floppy;
+    }
+    // SCSI type 5 is a CD/DVD drive
+    if ( name.startsWith( "sr" ) || readNumber( dir.filePath( "device/type" ), 0 ) == 5 )
+    {
+        return DiskType::Optical;
+    }
+    return DiskType::Disk;
+}
+
+DiskList
+readDisks( const QString& sysBlockPath )
+{
+    DiskList disks;
+    const QDir sysBlock( sysBlockPath );
+    const auto names = sysBlock.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+    for ( const QString& name : names )
+    {
+        const QDir dir( sysBlock.filePath( name ) );
+        DiskInfo d;
+        d.name = name;
+        // Names like cciss!c0d0 stand for cciss/c0d0
+        d.devicePath = QStringLiteral( "/dev/" ) + QString( name ).replace( '!', '/' );
+        d.type = diskType( name, dir );
+        // The size is always in 512-byte sectors, whatever the block size
+        d.size = readNumber( dir.filePath( "size" ), 0 ) * 512;
+        d.logicalBlockSize = int( readNumber( dir.filePath( "queue/logical_block_size" ), 512 ) );
+        d.physicalBlockSize = int( readNumber( dir.filePath( "queue/physical_block_size" ), d.logicalBlockSize ) );
+        d.isRotational = readNumber( dir.filePath( "queue/rotational" ), 0 ) != 0;
+        d.isRemovable = readNumber( dir.filePath( "removable" ), 0 ) != 0;
+        d.isReadOnly = readNumber( dir.filePath( "ro" ), 0 ) != 0;
+        d.hasDiscard = readNumber( dir.filePath( "queue/discard_max_bytes" ), 0 ) > 0;
+        disks.append( d );
+    }
+    return disks;
+}
+
+static QMutex s_disksMutex;
+static DiskList s_disks;
+static bool s_disksRead = false;
+
+DiskList
+disks()
+{
+    QMutexLocker lock( &s_disksMutex );
+    if ( !s_disksRead )
+    {
+        s_disks = readDisks( QStringLiteral( "/sys/block" ) );
+        s_disksRead = true;
+    }
+    return s_disks;
+}
+
+DiskList
+rescanDisks()
+{
+    DiskList newDisks = readDisks( QStringLiteral( "/sys/block" ) );
+    QMutexLocker lock( &s_disksMutex );
+    s_disks = newDisks;
+    s_disksRead = true;
+    return s_disks;
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
@@ -0,0 +1,79 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_DISKS_H
+#define PARTITION_DISKS_H
+
+#include "DllMacro.h"
+
+#include <QList>
+#include <QString>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/// @brief What kind of block device a disk is, as far as installing goes
+enum class DiskType
+{
+    Disk,  ///< A (possibly removable) disk, including NVMe, MMC and software RAID
+    Memory,  ///< ram or zram devices
+    Loop,
+    Mapper,  ///< device-mapper devices (e.g. LVM or LUKS)
+    Floppy,
+    Optical
+};
+
+/** @brief What the kernel knows about a block device
+ *
+ * This is read from /sys/block, without opening the device; it is
+ * cheap enough for requirements checks, unlike a full scan with
+ * KPMcore or libparted.
+ */
+struct DLLEXPORT DiskInfo
+{
+    QString name;  ///< Kernel name, e.g. "sda" or "nvme0n1"
+    QString devicePath;  ///< e.g. "/dev/sda"
+    DiskType type = DiskType::Disk;
+    qint64 size = 0;  ///< In bytes
+    int logicalBlockSize = 512;
+    int physicalBlockSize = 512;
+    bool isRotational = false;
+    bool isRemovable = false;
+    bool isReadOnly = false;
+    bool hasDiscard = false;  ///< Supports TRIM / discard
+
+    /// @brief Could this disk be installed to?
+    bool isInstallTarget() const { return type == DiskType::Disk && !isReadOnly && size > 0; }
+};
+
+using DiskList = QList< DiskInfo >;
+
+/** @brief The block devices in the system
+ *
+ * The devices are read once, and the list is shared after that; call
+ * rescanDisks() when disks may have been added or removed. This is
+ * safe to call from any thread. The list is empty on systems without
+ * /sys/block (e.g. FreeBSD).
+ */
+DLLEXPORT DiskList disks();
+/// @brief Reads the block devices again, and returns the new list
+DLLEXPORT DiskList rescanDisks();
+
+/** @brief Reads the block devices from a sysfs directory like /sys/block
+ *
+ * This is the uncached implementation of disks(), for tests.
+ */
+DLLEXPORT DiskList readDisks( const QString& sysBlockPath );
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif
@@ -14,17 +14,367 @@
 #include "partition/Sync.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
+#include "utils/String.h"
 
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QTemporaryDir>
 
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <unistd.h>
+
 namespace CalamaresUtils
 {
 namespace Partition
 {
 
+/// Exit code of mount(8) and umount(8) for a failed (un)mount
+static constexpr int mountFailure = 32;
+
+namespace
+{
+/** @brief What to do after mounting or before unmounting
+ *
+ * Mounting (and unmounting) an existing filesystem does not change
+ * the block devices, so TemporaryMount does not need to wait for udev,
+ * nor to flush every filesystem in the system.
+ */
+enum class SyncPolicy
+{
+    None,  ///< Do nothing more, e.g. for read-only mounts
+    Filesystem,  ///< Flush the affected filesystem (syncfs) after mounting or before unmounting
+    Settle  ///< Call sync(), waiting for udev and flushing everything
+};
+
+struct MountFlag
+{
+    const char* name;
+    unsigned long set;
+    unsigned long clear;
+};
+
+// The options that mount(8) turns into flags; see mount(8) "FILESYSTEM-INDEPENDENT MOUNT OPTIONS"
+const MountFlag mountFlags[] = {
+    { "ro", MS_RDONLY, 0 },
+    { "rw", 0, MS_RDONLY },
+    { "nosuid", MS_NOSUID, 0 },
+    { "suid", 0, MS_NOSUID },
+    { "nodev", MS_NODEV, 0 },
+    { "dev", 0, MS_NODEV },
+    { "noexec", MS_NOEXEC, 0 },
+    { "exec", 0, MS_NOEXEC },
+    { "sync", MS_SYNCHRONOUS, 0 },
+    { "async", 0, MS_SYNCHRONOUS },
+    { "dirsync", MS_DIRSYNC, 0 },
+    { "remount", MS_REMOUNT, 0 },
+    { "mand", MS_MANDLOCK, 0 },
+    { "nomand", 0, MS_MANDLOCK },
+    { "noatime", MS_NOATIME, 0 },
+    { "atime", 0, MS_NOATIME },
+    { "nodiratime", MS_NODIRATIME, 0 },
+    { "diratime", 0, MS_NODIRATIME },
+    { "relatime", MS_RELATIME, 0 },
+    { "norelatime", 0, MS_RELATIME },
+    { "strictatime", MS_STRICTATIME, 0 },
+    { "bind", MS_BIND, 0 },
+    { "rbind", MS_BIND | MS_REC, 0 },
+    { "silent", MS_SILENT, 0 },
+    { "loud", 0, MS_SILENT },
+};
+
+// Options that are only meaningful to mount(8) when reading fstab
+const char* const ignoredOptions[]
+    = { "defaults", "auto", "noauto", "user", "nouser", "users", "owner", "group", "nofail", "_netdev" };
+
+// The flags that apply to a mount point, rather than to the filesystem
+constexpr unsigned long perMountPointFlags
+    = MS_RDONLY | MS_NOSUID | MS_NODEV | MS_NOEXEC | MS_NOATIME | MS_NODIRATIME | MS_RELATIME | MS_STRICTATIME;
+}  // namespace
+
+MountArguments
+parseMountOptions( const QString& options )
+{
+    MountArguments args;
+    if ( options.startsWith( '-' ) )
+    {
+        // Command-line style, e.g. --bind
+        const QStringList parts = options.split( ' ', SplitSkipEmptyParts );
+        for ( const auto& part : parts )
+        {
+            if ( part == QStringLiteral( "--bind" ) || part == QStringLiteral( "-B" ) )
+            {
+                args.flags |= MS_BIND;
+            }
+            else if ( part == QStringLiteral( "--rbind" ) || part == QStringLiteral( "-R" ) )
+            {
+                args.flags |= MS_BIND | MS_REC;
+            }
+            else
+            {
+                args.needsProgram = true;
+            }
+        }
+        return args;
+    }
+
+    for ( const auto& option : options.split( ',', SplitSkipEmptyParts ) )
+    {
+        const QByteArray o = option.toLatin1();
+        if ( o == "loop" || o.startsWith( "loop=" ) || o.startsWith( "offset=" ) || o.startsWith( "sizelimit=" )
+             || o.startsWith( "helper=" ) )
+        {
+            args.needsProgram = true;
+            continue;
+        }
+        // x-* options are for userspace tools, and may be written X-*
+        if ( o.toLower().startsWith( "x-" ) || o.startsWith( "comment=" )
+             || std::find_if( std::begin( ignoredOptions ),
+                              std::end( ignoredOptions ),
+                              [&o]( const char* ignored ) { return o == ignored; } )
+                 != std::end( ignoredOptions ) )
+        {
+            continue;
+        }
+        auto flag = std::find_if(
+            std::begin( mountFlags ), std::end( mountFlags ), [&o]( const MountFlag& f ) { return o == f.name; } );
+        if ( flag != std::end( mountFlags ) )
+        {
+            args.flags = ( args.flags & ~flag->clear ) | flag->set;
+        }
+        else
+        {
+            args.data.append( option );
+        }
+    }
+    return args;
+}
+
+namespace
+{
+/// @brief Is there a mount.<type> helper, which only mount(8) knows how to call?
+bool
+hasMountHelper( const QString& filesystemName )
+{
+    for ( const char* dir : { "/sbin/", "/usr/sbin/", "/bin/", "/usr/bin/" } )
+    {
+        if ( QFile::exists( QString( dir ) + QStringLiteral( "mount." ) + filesystemName ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Calls mount(2); returns errno, or 0 on success
+ *
+ * Like mount(8), this retries read-only if the device is write-protected,
+ * and applies flags like ro to a bind mount with a second call.
+ */
 int
-mount( const QString& devicePath, const QString& mountPoint, const QString& filesystemName, const QString& options )
+mountOnce( const QByteArray& device, const QByteArray& mountPoint, const QByteArray& type, const MountArguments& args )
+{
+    const QByteArray data = args.data.join( ',' ).toLocal8Bit();
+    auto call = [&]( unsigned long flags ) {
+        return ::mount( device.constData(),
+                        mountPoint.constData(),
+                        type.isEmpty() ? nullptr : type.constData(),
+                        flags,
+                        data.isEmpty() ? nullptr : data.constData() )
+            ? errno
+            : 0;
+    };
+
+    int error = call( args.flags );
+    if ( ( error == EROFS || error == EACCES ) && !( args.flags & ( MS_RDONLY | MS_BIND | MS_REMOUNT ) ) )
+    {
+        error = call( args.flags | MS_RDONLY );
+        if ( !error )
+        {
+            cWarning() << "Device" << device << "is write-protected, mounted read-only.";
+        }
+    }
+
+    // The kernel ignores these flags when it creates a bind mount
+    const unsigned long bindFlags = args.flags & perMountPointFlags;
+    if ( !error && ( args.flags & MS_BIND ) && !( args.flags & MS_REMOUNT ) && bindFlags )
+    {
+        if ( ::mount( device.constData(), mountPoint.constData(), nullptr, MS_REMOUNT | MS_BIND | bindFlags, nullptr ) )
+        {
+            error = errno;
+            ::umount2( mountPoint.constData(), MNT_DETACH );
+        }
+    }
+    return error;
+}
+
+/** @brief Mounts with mount(2)
+ *
+ * Returns false (without mounting) if mount(8) is needed, otherwise
+ * sets @p result to 0 or to the mount(8) failure code.
+ */
+bool
+mountDirectly( const QString& devicePath,
+               const QString& mountPoint,
+               const QString& filesystemName,
+               const QString& options,
+               int& result )
+{
+    const MountArguments args = parseMountOptions( options );
+    const bool isBind = args.flags & MS_BIND;
+    // Without a type, mount(8) finds it with blkid (and the kernel loads the module)
+    if ( args.needsProgram || ( !isBind && filesystemName.isEmpty() )
+         || ( !filesystemName.isEmpty() && hasMountHelper( filesystemName ) )
+         || ( !isBind && QFileInfo( devicePath ).isFile() ) )
+    {
+        return false;
+    }
+
+    const int error = mountOnce(
+        QFile::encodeName( devicePath ), QFile::encodeName( mountPoint ), filesystemName.toLatin1(), args );
+
+    if ( error )
+    {
+        cWarning() << "Could not mount" << devicePath << "on" << mountPoint << ':' << strerror( error );
+    }
+    result = error ? mountFailure : 0;
+    return true;
+}
+
+/// @brief Calls syncfs() for the filesystem mounted at @p path
+void
+syncFilesystem( const QString& path )
+{
+    int fd = ::open( QFile::encodeName( path ).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        cWarning() << "Could not open" << path << "to sync it.";
+        return;
+    }
+    if ( ::syncfs( fd ) )
+    {
+        cWarning() << "Could not sync" << path << ':' << strerror( errno );
+    }
+    ::close( fd );
+}
+
+}  // namespace
+
+QString
+unescapeMountPoint( const QByteArray& s )
+{
+    QByteArray r;
+    for ( int i = 0; i < s.length(); ++i )
+    {
+        if ( s.at( i ) == '\\' && i + 3 < s.length() )
+        {
+            r.append( char( s.mid( i + 1, 3 ).toInt( nullptr, 8 ) ) );
+            i += 3;
+        }
+        else
+        {
+            r.append( s.at( i ) );
+        }
+    }
+    return QFile::decodeName( r );
+}
+
+QStringList
+mountPointsUnder( const QString& path, const QByteArray& mountTable )
+{
+    const QString prefix = path.endsWith( '/' ) ? path : ( path + '/' );
+    QStringList mountPoints;
+    for ( const auto& line : mountTable.split( '\n' ) )
+    {
+        const QList< QByteArray > fields = line.split( ' ' );
+        if ( fields.count() < 2 )
+        {
+            continue;
+        }
+        const QString mountPoint = unescapeMountPoint( fields.at( 1 ) );
+        if ( mountPoint == path || mountPoint.startsWith( prefix ) )
+        {
+            mountPoints.append( mountPoint );
+        }
+    }
+    // Later mounts may be stacked on earlier ones, so go in reverse, and then by depth
+    std::reverse( mountPoints.begin(), mountPoints.end() );
+    std::stable_sort( mountPoints.begin(), mountPoints.end(), []( const QString& a, const QString& b ) {
+        return a.count( '/' ) > b.count( '/' );
+    } );
+    return mountPoints;
+}
+
+namespace
+{
+/** @brief Unmounts with umount2(2)
+ *
+ * Returns false (without unmounting) if umount(8) is needed, otherwise
+ * sets @p result to 0 or to the umount(8) failure code.
+ */
+bool
+unmountDirectly( const QString& path, const QStringList& options, SyncPolicy policy, int& result )
+{
+    int flags = 0;
+    bool recursive = false;
+    for ( const auto& o : options )
+    {
+        if ( o == QStringLiteral( "-R" ) || o == QStringLiteral( "--recursive" ) )
+        {
+            recursive = true;
+        }
+        else if ( o == QStringLiteral( "-l" ) || o == QStringLiteral( "--lazy" ) )
+        {
+            flags |= MNT_DETACH;
+        }
+        else if ( o == QStringLiteral( "-f" ) || o == QStringLiteral( "--force" ) )
+        {
+            flags |= MNT_FORCE;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    // A device path needs a lookup of where it is mounted
+    if ( !QFileInfo( path ).isDir() )
+    {
+        return false;
+    }
+
+    QStringList mountPoints { path };
+    if ( recursive )
+    {
+        QFile f( QStringLiteral( "/proc/self/mounts" ) );
+        mountPoints = mountPointsUnder( path, f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray() );
+    }
+    result = 0;
+    for ( const auto& mountPoint : mountPoints )
+    {
+        if ( policy == SyncPolicy::Filesystem )
+        {
+            syncFilesystem( mountPoint );
+        }
+        if ( ::umount2( QFile::encodeName( mountPoint ).constData(), flags ) )
+        {
+            cWarning() << "Could not unmount" << mountPoint << ':' << strerror( errno );
+            result = mountFailure;
+        }
+    }
+    return true;
+}
+
+int
+mountWithPolicy( const QString& devicePath,
+                 const QString& mountPoint,
+                 const QString& filesystemName,
+                 const QString& options,
+                 SyncPolicy policy )
 {
     if ( devicePath.isEmpty() || mountPoint.isEmpty() )
     {
@@ -51,43 +401,78 @@ mount( const QString& devicePath, const QString& mountPoint, const QString& file
         }
     }
 
-    QStringList args = { "mount" };
-
-    if ( !filesystemName.isEmpty() )
-    {
-        args << "-t" << filesystemName;
-    }
-    if ( !options.isEmpty() )
+    int result = 0;
+    if ( !mountDirectly( devicePath, mountPoint, filesystemName, options, result ) )
     {
-        if ( options.startsWith( '-' ) )
+        QStringList args = { "mount" };
+
+        if ( !filesystemName.isEmpty() )
         {
-            args << options;
+            args << "-t" << filesystemName;
         }
-        else
+        if ( !options.isEmpty() )
         {
-            args << "-o" << options;
+            if ( options.startsWith( '-' ) )
+            {
+                args << options;
+            }
+            else
+            {
+                args << "-o" << options;
+            }
         }
+        args << devicePath << mountPoint;
+
+        result = CalamaresUtils::System::runCommand( args, std::chrono::seconds( 10 ) ).getExitCode();
+    }
+
+    if ( policy == SyncPolicy::Settle )
+    {
+        sync();
     }
-    args << devicePath << mountPoint;
+    else if ( policy == SyncPolicy::Filesystem && result == 0 )
+    {
+        syncFilesystem( mountPoint );
+    }
+    return result;
+}
 
-    auto r = CalamaresUtils::System::runCommand( args, std::chrono::seconds( 10 ) );
-    sync();
-    return r.getExitCode();
+int
+unmountWithPolicy( const QString& path, const QStringList& options, SyncPolicy policy )
+{
+    int result = 0;
+    if ( !unmountDirectly( path, options, policy, result ) )
+    {
+        result = CalamaresUtils::System::runCommand( QStringList { "umount" } << options << path,
+                                                     std::chrono::seconds( 10 ) )
+                     .getExitCode();
+    }
+    if ( policy == SyncPolicy::Settle )
+    {
+        sync();
+    }
+    return result;
+}
+
+}  // namespace
+
+int
+mount( const QString& devicePath, const QString& mountPoint, const QString& filesystemName, const QString& options )
+{
+    return mountWithPolicy( devicePath, mountPoint, filesystemName, options, SyncPolicy::Settle );
 }
 
 int
 unmount( const QString& path, const QStringList& options )
 {
-    auto r
-        = CalamaresUtils::System::runCommand( QStringList { "umount" } << options << path, std::chrono::seconds( 10 ) );
-    sync();
-    return r.getExitCode();
+    return unmountWithPolicy( path, options, SyncPolicy::Settle );
 }
 
 struct TemporaryMount::Private
 {
     QString m_devicePath;
     QTemporaryDir m_mountDir;
+    SyncPolicy m_unmountPolicy = SyncPolicy::Filesystem;
 };
 
 
@@ -96,7 +481,11 @@ TemporaryMount::TemporaryMount( const QString& devicePath, const QString& filesy
 {
     m_d->m_devicePath = devicePath;
     m_d->m_mountDir.setAutoRemove( false );
-    int r = mount( devicePath, m_d->m_mountDir.path(), filesystemName, options );
+    if ( options.split( ',' ).contains( QStringLiteral( "ro" ) ) )
+    {
+        m_d->m_unmountPolicy = SyncPolicy::None;
+    }
+    int r = mountWithPolicy( devicePath, m_d->m_mountDir.path(), filesystemName, options, SyncPolicy::None );
     if ( r )
     {
         cWarning() << "Mount of" << devicePath << "on" << m_d->m_mountDir.path() << "failed, code" << r;
@@ -109,7 +498,7 @@ TemporaryMount::~TemporaryMount()
 {
     if ( m_d )
     {
-        int r = unmount( m_d->m_mountDir.path(), { "-R" } );
+        int r = unmountWithPolicy( m_d->m_mountDir.path(), { "-R" }, m_d->m_unmountPolicy );
         if ( r )
         {
             cWarning() << "UnMount of temporary" << m_d->m_devicePath << "on" << m_d->m_mountDir.path()
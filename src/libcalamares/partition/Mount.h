@@ -22,18 +22,50 @@ namespace CalamaresUtils
 namespace Partition
 {
 
+/// @brief The arguments for mount(2) that correspond to mount -o options
+struct MountArguments
+{
+    unsigned long flags = 0;  ///< MS_* flags
+    QStringList data;  ///< Filesystem-specific options
+    bool needsProgram = false;  ///< Are there options that only mount(8) understands?
+};
+
+/// @brief Splits the comma-separated mount(8) @p options into flags and data
+DLLEXPORT MountArguments parseMountOptions( const QString& options );
+
+/// @brief Undoes the octal escapes (e.g. \040 for space) of /proc/self/mounts and /etc/fstab
+DLLEXPORT QString unescapeMountPoint( const QByteArray& s );
+
+/** @brief The mount points at, and under, @p path; the deepest come first
+ *
+ * The @p mountTable is the contents of /proc/self/mounts. Mount points
+ * that are stacked on the same path are listed last-mounted first,
+ * which is the order in which to unmount them.
+ */
+DLLEXPORT QStringList mountPointsUnder( const QString& path, const QByteArray& mountTable );
+
 /**
- * Runs the mount utility with the specified parameters.
+ * Mounts @p devicePath on @p mountPoint.
+ *
+ * This calls mount(2) directly, unless the mount needs the mount(8)
+ * program: if the filesystem type must be detected, if the @p options
+ * include a loop device, or if there is a mount helper for the
+ * filesystem (e.g. mount.ntfs-3g).
+ *
  * @param devicePath the path of the partition to mount.
  * @param mountPoint the full path of the target mount point.
  * @param filesystemName the name of the filesystem (optional).
+ *          If it is empty, mount(8) detects the filesystem type.
  * @param options any additional options as passed to mount -o (optional).
  *          If @p options starts with a dash (-) then it is passed unchanged
  *          and no -o option is added; this is used in handling --bind mounts.
- * @returns the program's exit code, or:
+ * @returns 0 on success, or an exit code like that of mount(8), or:
  *             Crashed = QProcess crash
  *             FailedToStart = QProcess cannot start
  *             NoWorkingDirectory = bad arguments
+ *
+ * After mounting, this calls sync(), which is what modules expect when
+ * they mount (new) partitions during installation.
  */
 DLLEXPORT int mount( const QString& devicePath,
                      const QString& mountPoint,
@@ -42,12 +74,22 @@ DLLEXPORT int mount( const QString& devicePath,
 
 /** @brief Unmount the given @p path (device or mount point).
  *
- * Runs umount(8) in the host system.
+ * Calls umount2(2) directly if the @p options are "-R" (recursive),
+ * "-l" (lazy) and "-f" (force) only; otherwise runs umount(8) in
+ * the host system. Afterwards, calls sync().
  *
- * @returns the program's exit code, or special codes like mount().
+ * @returns 0 on success, an exit code like that of umount(8),
+ *          or special codes like mount().
  */
 DLLEXPORT int unmount( const QString& path, const QStringList& options = QStringList() );
 
+/** @brief Mounts a partition in a temporary directory
+ *
+ * This is meant for a quick look at an existing filesystem, e.g. to
+ * read a file from it: no sync() is done, since the block devices do
+ * not change. Only the mounted filesystem is flushed when unmounting,
+ * and not even that if @p options makes it a read-only mount.
+ */
 class DLLEXPORT TemporaryMount
 {
 public:
@@ -10,6 +10,8 @@
 
 #include "Tests.h"
 
+#include "Disks.h"
+#include "Mount.h"
 #include "PartitionSize.h"
 
 using SizeUnit = CalamaresUtils::Partition::SizeUnit;
@@ -19,8 +21,11 @@ Q_DECLARE_METATYPE( SizeUnit )
 
 #include "utils/Logger.h"
 
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
+#include <sys/mount.h>
+
 QTEST_GUILESS_MAIN( PartitionSizeTests )
 
 PartitionSizeTests::PartitionSizeTests() {}
@@ -139,3 +144,150 @@ PartitionSizeTests::testUnitNormalisation()
 
     QCOMPARE( PartitionSize( v, u1 ).toBytes(), bytes );
 }
+
+/// @brief Writes @p value to file @p name in a fake sysfs directory @p dir
+static bool
+writeSys( const QDir& dir, const QString& name, const QByteArray& value )
+{
+    if ( !dir.mkpath( QFileInfo( dir.filePath( name ) ).path() ) )
+    {
+        return false;
+    }
+    QFile f( dir.filePath( name ) );
+    return f.open( QIODevice::WriteOnly ) && f.write( value + '\n' ) == value.size() + 1;
+}
+
+void
+PartitionSizeTests::testReadDisks()
+{
+    using namespace CalamaresUtils::Partition;
+
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir sys( tempRoot.path() );
+
+    // A 4Kn SSD, a removable stick, a CD and a loop device
+    QVERIFY( writeSys( sys, "nvme0n1/size", "1953525168" ) );
+    QVERIFY( writeSys( sys, "nvme0n1/queue/logical_block_size", "4096" ) );
+    QVERIFY( writeSys( sys, "nvme0n1/queue/physical_block_size", "4096" ) );
+    QVERIFY( writeSys( sys, "nvme0n1/queue/rotational", "0" ) );
+    QVERIFY( writeSys( sys, "nvme0n1/queue/discard_max_bytes", "2199023255040" ) );
+    QVERIFY( writeSys( sys, "sdb/size", "30031872" ) );
+    QVERIFY( writeSys( sys, "sdb/queue/rotational", "1" ) );
+    QVERIFY( writeSys( sys, "sdb/removable", "1" ) );
+    QVERIFY( writeSys( sys, "sr0/size", "4194304" ) );
+    QVERIFY( writeSys( sys, "sr0/ro", "1" ) );
+    QVERIFY( writeSys( sys, "loop0/size", "0" ) );
+    QVERIFY( writeSys( sys, "cciss!c0d0/size", "2048" ) );
+
+    const auto list = readDisks( tempRoot.path() );
+    QCOMPARE( list.count(), 5 );
+    // Sorted by name
+    QCOMPARE( list.at( 0 ).name, QStringLiteral( "cciss!c0d0" ) );
+    QCOMPARE( list.at( 0 ).devicePath, QStringLiteral( "/dev/cciss/c0d0" ) );
+
+    const auto& nvme = list.at( 2 );
+    QCOMPARE( nvme.name, QStringLiteral( "nvme0n1" ) );
+    QCOMPARE( nvme.devicePath, QStringLiteral( "/dev/nvme0n1" ) );
+    QCOMPARE( nvme.type, DiskType::Disk );
+    QCOMPARE( nvme.size, Q_INT64_C( 1953525168 ) * 512 );
+    QCOMPARE( nvme.logicalBlockSize, 4096 );
+    QCOMPARE( nvme.physicalBlockSize, 4096 );
+    QVERIFY( !nvme.isRotational );
+    QVERIFY( !nvme.isRemovable );
+    QVERIFY( nvme.hasDiscard );
+    QVERIFY( nvme.isInstallTarget() );
+
+    const auto& stick = list.at( 3 );
+    QCOMPARE( stick.logicalBlockSize, 512 );
+    QVERIFY( stick.isRotational );
+    QVERIFY( stick.isRemovable );
+    QVERIFY( !stick.hasDiscard );
+    QVERIFY( stick.isInstallTarget() );
+
+    QCOMPARE( list.at( 1 ).type, DiskType::Loop );
+    QVERIFY( !list.at( 1 ).isInstallTarget() );
+    QCOMPARE( list.at( 4 ).type, DiskType::Optical );
+    QVERIFY( list.at( 4 ).isReadOnly );
+    QVERIFY( !list.at( 4 ).isInstallTarget() );
+
+    QVERIFY( readDisks( sys.filePath( "nonexistent" ) ).isEmpty() );
+}
+
+void
+PartitionSizeTests::testParseMountOptions()
+{
+    using namespace CalamaresUtils::Partition;
+
+    auto args = parseMountOptions( QString() );
+    QCOMPARE( args.flags, 0ul );
+    QVERIFY( args.data.isEmpty() );
+    QVERIFY( !args.needsProgram );
+
+    args = parseMountOptions( QStringLiteral( "defaults,noatime,compress=zstd,nodev,subvol=@home" ) );
+    QCOMPARE( args.flags, static_cast< unsigned long >( MS_NOATIME | MS_NODEV ) );
+    QCOMPARE( args.data, QStringList( { QStringLiteral( "compress=zstd" ), QStringLiteral( "subvol=@home" ) } ) );
+    QVERIFY( !args.needsProgram );
+
+    // Later options override earlier ones
+    args = parseMountOptions( QStringLiteral( "ro,nosuid,rw" ) );
+    QCOMPARE( args.flags, static_cast< unsigned long >( MS_NOSUID ) );
+
+    args = parseMountOptions( QStringLiteral( "bind,ro" ) );
+    QCOMPARE( args.flags, static_cast< unsigned long >( MS_BIND | MS_RDONLY ) );
+    QVERIFY( args.data.isEmpty() );
+
+    args = parseMountOptions( QStringLiteral( "rbind" ) );
+    QCOMPARE( args.flags, static_cast< unsigned long >( MS_BIND | MS_REC ) );
+
+    // Options for userspace tools are not passed to the kernel
+    args = parseMountOptions( QStringLiteral( "x-systemd.automount,X-mount.mkdir,comment=x,nofail" ) );
+    QCOMPARE( args.flags, 0ul );
+    QVERIFY( args.data.isEmpty() );
+
+    QVERIFY( parseMountOptions( QStringLiteral( "loop" ) ).needsProgram );
+    QVERIFY( parseMountOptions( QStringLiteral( "ro,loop=/dev/loop3" ) ).needsProgram );
+}
+
+void
+PartitionSizeTests::testUnescapeMountPoint()
+{
+    using CalamaresUtils::Partition::unescapeMountPoint;
+
+    QCOMPARE( unescapeMountPoint( QByteArray() ), QString() );
+    QCOMPARE( unescapeMountPoint( "/mnt/plain" ), QStringLiteral( "/mnt/plain" ) );
+    QCOMPARE( unescapeMountPoint( "/mnt/with\\040space" ), QStringLiteral( "/mnt/with space" ) );
+    QCOMPARE( unescapeMountPoint( "/mnt/tab\\011and\\012newline" ), QStringLiteral( "/mnt/tab\tand\nnewline" ) );
+    QCOMPARE( unescapeMountPoint( "/mnt/back\\134slash" ), QStringLiteral( "/mnt/back\\slash" ) );
+    // A truncated escape is left alone
+    QCOMPARE( unescapeMountPoint( "/mnt/end\\04" ), QStringLiteral( "/mnt/end\\04" ) );
+}
+
+void
+PartitionSizeTests::testMountPointsUnder()
+{
+    using CalamaresUtils::Partition::mountPointsUnder;
+
+    const QByteArray mounts( "/dev/sda2 / ext4 rw,relatime 0 0\n"
+                             "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\n"
+                             "/dev/sdb2 /tmp/calamares-root ext4 rw,relatime 0 0\n"
+                             "/dev/sdb1 /tmp/calamares-root/boot/efi vfat rw,relatime 0 0\n"
+                             "/dev/sdb3 /tmp/calamares-root/home ext4 rw,relatime 0 0\n"
+                             "/dev/sdb4 /tmp/calamares-root/my\\040data xfs rw,relatime 0 0\n"
+                             "/dev/sdc1 /tmp/calamares-root-other ext4 rw,relatime 0 0\n"
+                             "tmpfs /tmp/calamares-root/home tmpfs rw 0 0\n"
+                             "proc /tmp/calamares-root/proc proc rw 0 0\n" );
+
+    const QStringList under = mountPointsUnder( QStringLiteral( "/tmp/calamares-root" ), mounts );
+    // Deepest first; the tmpfs on /home was mounted last, so it comes before the ext4 there
+    QCOMPARE( under,
+              QStringList( { QStringLiteral( "/tmp/calamares-root/boot/efi" ),
+                             QStringLiteral( "/tmp/calamares-root/proc" ),
+                             QStringLiteral( "/tmp/calamares-root/home" ),
+                             QStringLiteral( "/tmp/calamares-root/my data" ),
+                             QStringLiteral( "/tmp/calamares-root/home" ),
+                             QStringLiteral( "/tmp/calamares-root" ) } ) );
+    QCOMPARE( mountPointsUnder( QStringLiteral( "/tmp/calamares-root/" ), mounts ).count(), 5 );
+    QCOMPARE( mountPointsUnder( QStringLiteral( "/srv" ), mounts ), QStringList() );
+    QCOMPARE( mountPointsUnder( QStringLiteral( "/tmp/calamares-root" ), QByteArray() ), QStringList() );
+}
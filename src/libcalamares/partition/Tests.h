@@ -28,6 +28,12 @@ private Q_SLOTS:
 
     void testUnitNormalisation_data();
     void testUnitNormalisation();
+
+    void testReadDisks();
+
+    void testParseMountOptions();
+    void testUnescapeMountPoint();
+    void testMountPointsUnder();
 };
 
 #endif
@@ -14,6 +14,8 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
+#include "partition/Disks.h"
+#include "utils/HostInfo.h"
 #include "utils/Logger.h"
 
 #include <QCoreApplication>
@@ -21,17 +23,13 @@
 #include <QProcess>
 #include <QRegularExpression>
 
-#ifdef Q_OS_LINUX
-#include <sys/sysinfo.h>
-#endif
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-#ifdef Q_OS_FREEBSD
-// clang-format off
-// these includes need to stay in-order (that's a FreeBSD thing)
-#include <sys/types.h>
-#include <sys/sysctl.h>
-// clang-format on
-#endif
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
 
 /** @brief When logging commands, don't log everything.
  *
@@ -244,39 +242,9 @@ System::targetPath( const QString& path ) const
 CreationResult
 System::createTargetFile( const QString& path, const QByteArray& contents, WriteMode mode ) const
 {
-    QString completePath = targetPath( path );
-    if ( completePath.isEmpty() )
-    {
-        return CreationResult( CreationResult::Code::Invalid );
-    }
-
-    QFile f( completePath );
-    if ( ( mode == WriteMode::KeepExisting ) && f.exists() )
-    {
-        return CreationResult( CreationResult::Code::AlreadyExists );
-    }
-
-    QIODevice::OpenMode m =
-#if QT_VERSION >= QT_VERSION_CHECK( 5, 11, 0 )
-        // New flag from Qt 5.11, implies WriteOnly
-        ( mode == WriteMode::KeepExisting ? QIODevice::NewOnly : QIODevice::WriteOnly ) |
-#endif
-        QIODevice::WriteOnly | QIODevice::Truncate;
-
-    if ( !f.open( m ) )
-    {
-        return CreationResult( CreationResult::Code::Failed );
-    }
-
-    if ( f.write( contents ) != contents.size() )
-    {
-        f.close();
-        f.remove();
-        return CreationResult( CreationResult::Code::Failed );
-    }
-
-    f.close();
-    return CreationResult( QFileInfo( f ).canonicalFilePath() );
+    TargetFileWriter w( path, mode );
+    w.write( contents );  // A failure is reported by commit()
+    return w.commit();
 }
 
 void
@@ -336,60 +304,28 @@ System::createTargetParentDirs( const QString& filePath ) const
 QPair< quint64, float >
 System::getTotalMemoryB() const
 {
-#ifdef Q_OS_LINUX
-    struct sysinfo i;
-    int r = sysinfo( &i );
-
-    if ( r )
-    {
-        return qMakePair( 0, 0.0 );
-    }
-
-    return qMakePair( quint64( i.mem_unit ) * quint64( i.totalram ), 1.1 );
-#elif defined( Q_OS_FREEBSD )
-    unsigned long memsize;
-    size_t s = sizeof( memsize );
-
-    int r = sysctlbyname( "vm.kmem_size", &memsize, &s, NULL, 0 );
-    if ( r )
-    {
-        return qMakePair( 0, 0.0 );
-    }
-
-    return qMakePair( memsize, 1.01 );
-#else
-    return qMakePair( 0, 0.0 );  // Unsupported
-#endif
+    return hostInfo().memory;
 }
 
 
 QString
 System::getCpuDescription() const
 {
-    QString model;
-
-#ifdef Q_OS_LINUX
-    QFile file( "/proc/cpuinfo" );
-    if ( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-        while ( !file.atEnd() )
-        {
-            QByteArray line = file.readLine();
-            if ( line.startsWith( "model name" ) && ( line.indexOf( ':' ) > 0 ) )
-            {
-                model = QString::fromLatin1( line.right( line.length() - line.indexOf( ':' ) ) );
-                break;
-            }
-        }
-#elif defined( Q_OS_FREEBSD )
-    // This would use sysctl "hw.model", which has a string value
-#endif
-    return model.simplified();
+    return hostInfo().cpuModel;
 }
 
 quint64
 System::getTotalDiskB() const
 {
-    return 0;
+    quint64 total = 0;
+    for ( const auto& d : CalamaresUtils::Partition::disks() )
+    {
+        if ( d.type == CalamaresUtils::Partition::DiskType::Disk )
+        {
+            total += quint64( d.size );
+        }
+    }
+    return total;
 }
 
 bool
@@ -445,4 +381,183 @@ ProcessResult::explainProcess( int ec, const QString& command, const QString& ou
             + outputMessage );
 }
 
+/** @brief Renames @p from to @p to, unless @p to exists
+ *
+ * Fails with EEXIST if @p to exists, even if it was created just now.
+ */
+static bool
+renameNoReplace( const QByteArray& from, const QByteArray& to )
+{
+#if defined( Q_OS_LINUX ) && defined( RENAME_NOREPLACE )
+    if ( ::renameat2( AT_FDCWD, from.constData(), AT_FDCWD, to.constData(), RENAME_NOREPLACE ) == 0 )
+    {
+        return true;
+    }
+    if ( errno != EINVAL && errno != ENOSYS )
+    {
+        return false;
+    }
+#endif
+    // Not every filesystem (or kernel) can do that; link(2) fails on an existing file, too
+    if ( ::link( from.constData(), to.constData() ) != 0 )
+    {
+        return false;
+    }
+    ::unlink( from.constData() );
+    return true;
+}
+
+TargetFileWriter::TargetFileWriter( const QString& path, System::WriteMode mode, System::SyncMode sync )
+    : m_mode( mode )
+    , m_sync( sync )
+{
+    m_path = System::instance() ? System::instance()->targetPath( path ) : QString();
+    if ( m_path.isEmpty() )
+    {
+        m_code = CreationResult::Code::Invalid;
+        return;
+    }
+
+    const QFileInfo fi( m_path );
+    if ( mode == System::WriteMode::KeepExisting && fi.exists() )
+    {
+        m_code = CreationResult::Code::AlreadyExists;
+        return;
+    }
+    // Writing in place would change what a link points to, not the link
+    if ( fi.isSymLink() && fi.exists() )
+    {
+        m_path = fi.canonicalFilePath();
+    }
+
+    static std::atomic< int > serial { 0 };
+    m_newPath = QFile::encodeName( m_path ) + ".calamares-" + QByteArray::number( qint64( ::getpid() ) ) + '-'
+        + QByteArray::number( serial++ );
+
+    struct stat st;
+    const bool replacing = ::stat( QFile::encodeName( m_path ).constData(), &st ) == 0;
+    m_fd = ::open(
+        m_newPath.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, replacing ? ( st.st_mode & 07777 ) : 0666 );
+    if ( m_fd < 0 )
+    {
+        cWarning() << "Could not create" << m_newPath;
+        m_newPath.clear();
+        m_code = CreationResult::Code::Failed;
+        return;
+    }
+    if ( replacing )
+    {
+        // The owner can only be kept when running as root, which is the usual case;
+        // the mode is set afterwards because chown clears setuid bits.
+        if ( ::fchown( m_fd, st.st_uid, st.st_gid ) != 0 )
+        {
+            cDebug() << Logger::SubEntry << "Could not keep the owner of" << m_path;
+        }
+        ::fchmod( m_fd, st.st_mode & 07777 );
+    }
+}
+
+TargetFileWriter::~TargetFileWriter()
+{
+    discard();
+}
+
+bool
+TargetFileWriter::write( const QByteArray& data )
+{
+    if ( m_fd < 0 )
+    {
+        return false;
+    }
+
+    const char* p = data.constData();
+    qint64 remaining = data.size();
+    while ( remaining > 0 )
+    {
+        const ssize_t n = ::write( m_fd, p, size_t( remaining ) );
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            cWarning() << "Could not write" << m_newPath;
+            discard();
+            return false;
+        }
+        p += n;
+        remaining -= n;
+    }
+    return true;
+}
+
+CreationResult
+TargetFileWriter::commit()
+{
+    if ( m_fd < 0 )
+    {
+        return CreationResult( m_code );
+    }
+
+    bool ok = m_sync == System::SyncMode::NoSync || ::fsync( m_fd ) == 0;
+    ok = ::close( m_fd ) == 0 && ok;
+    m_fd = -1;
+
+    const QByteArray path = QFile::encodeName( m_path );
+    if ( ok )
+    {
+        ok = m_mode == System::WriteMode::KeepExisting
+            ? renameNoReplace( m_newPath, path )
+            : ::rename( m_newPath.constData(), path.constData() ) == 0;
+        if ( !ok && errno == EEXIST && m_mode == System::WriteMode::KeepExisting )
+        {
+            // Someone else got there first
+            ::unlink( m_newPath.constData() );
+            m_newPath.clear();
+            m_code = CreationResult::Code::AlreadyExists;
+            return CreationResult( m_code );
+        }
+    }
+    if ( !ok )
+    {
+        cWarning() << "Could not replace" << m_path;
+        discard();
+        return CreationResult( m_code );
+    }
+    m_newPath.clear();
+    m_code = CreationResult::Code::Failed;  // There is nothing left to commit
+
+    if ( m_sync == System::SyncMode::Sync )
+    {
+        // The rename itself is only durable once the directory is synced
+        const QByteArray dir = QFile::encodeName( QFileInfo( m_path ).absolutePath() );
+        const int dirFd = ::open( dir.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+        if ( dirFd >= 0 )
+        {
+            ::fsync( dirFd );
+            ::close( dirFd );
+        }
+    }
+    return CreationResult( QFileInfo( m_path ).canonicalFilePath() );
+}
+
+void
+TargetFileWriter::discard()
+{
+    if ( m_fd >= 0 )
+    {
+        ::close( m_fd );
+        m_fd = -1;
+    }
+    if ( !m_newPath.isEmpty() )
+    {
+        ::unlink( m_newPath.constData() );
+        m_newPath.clear();
+    }
+    if ( m_code == CreationResult::Code::OK )
+    {
+        m_code = CreationResult::Code::Failed;
+    }
+}
+
 }  // namespace CalamaresUtils
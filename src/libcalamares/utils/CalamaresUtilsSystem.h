@@ -256,6 +256,13 @@ public:
         Overwrite
     };
 
+    /// @brief How carefully a target file is written, @see TargetFileWriter
+    enum class SyncMode
+    {
+        NoSync,  ///< Leave it to the kernel when the data reaches the disk
+        Sync  ///< Sync the file, and its directory, before reporting success
+    };
+
     /** @brief Create a (small-ish) file in the target system.
      *
      * @param path Path to the file; this is interpreted
@@ -268,6 +275,9 @@ public:
      *  - **unless** @p mode is set to Overwrite, then it tries writing as
      *    usual and will not return AlreadyExists.
      *
+     * The file is replaced as a whole, @see TargetFileWriter, which can
+     * also be used to write bigger files in pieces.
+     *
      * @return The complete canonical path to the target file from the
      *      root of the host system, or empty on failure. (Here, it is
      *      possible to be canonical because the file exists).
@@ -314,6 +324,7 @@ public:
      * available is size * guesstimate.
      *
      * If nothing can be found, returns a 0 size and 0 guesstimate.
+     * This is found only once, @see CalamaresUtils::hostInfo()
      *
      * @return size, guesstimate-factor
      */
@@ -322,13 +333,16 @@ public:
     /**
      * @brief getCpuDescription returns a string describing the CPU.
      *
-     * Returns the value of the "model name" line in /proc/cpuinfo.
+     * Returns the value of the "model name" line in /proc/cpuinfo
+     * (or hw.model on FreeBSD), @see CalamaresUtils::hostInfo()
      */
     DLLEXPORT QString getCpuDescription() const;
 
     /**
      * @brief getTotalDiskB returns the total disk attached, in bytes.
      *
+     * This counts the disks (not loop devices, CDs and the like) that
+     * CalamaresUtils::Partition::disks() finds.
      * If nothing can be found, returns a 0.
      */
     DLLEXPORT quint64 getTotalDiskB() const;
@@ -341,6 +355,63 @@ private:
     bool m_doChroot;
 };
 
+/** @brief Writes a file in the target system, in pieces
+ *
+ * The data goes to a new file next to @p path, which replaces the
+ * file at @p path (with rename(2)) only when commit() is called. Other
+ * programs never see a half-written file, and a failure (or a crash)
+ * leaves the original as it was. The new file gets the mode and owner
+ * of the file it replaces. A writer that is destroyed without commit()
+ * removes what it wrote.
+ *
+ * With WriteMode::KeepExisting, a file that exists already is never
+ * replaced; not even one that appears while writing. commit() then
+ * returns AlreadyExists, just like System::createTargetFile() does.
+ *
+ * @code
+ *  CalamaresUtils::TargetFileWriter w( "/etc/fstab", System::WriteMode::Overwrite );
+ *  for ( const auto& line : lines )
+ *  {
+ *      w.write( line );
+ *  }
+ *  auto r = w.commit();
+ * @endcode
+ */
+class DLLEXPORT TargetFileWriter
+{
+public:
+    /// @brief Starts writing @p path (interpreted like System::targetPath() does)
+    TargetFileWriter( const QString& path,
+                      System::WriteMode mode = System::WriteMode::KeepExisting,
+                      System::SyncMode sync = System::SyncMode::NoSync );
+    ~TargetFileWriter();
+
+    TargetFileWriter( const TargetFileWriter& ) = delete;
+    TargetFileWriter& operator=( const TargetFileWriter& ) = delete;
+
+    /// @brief Can data be written? If not, commit() says why
+    bool isValid() const { return m_fd >= 0; }
+
+    /// @brief Appends @p data to the new file; returns @c false on failure
+    bool write( const QByteArray& data );
+    /** @brief Puts the new file in place
+     *
+     * @return The result, like System::createTargetFile(). After a failed
+     *      write(), this returns Failed and the original is left alone.
+     */
+    CreationResult commit();
+    /// @brief Removes the new file, leaving the original alone
+    void discard();
+
+private:
+    QString m_path;  ///< In the host system
+    QByteArray m_newPath;  ///< The file that is being written
+    int m_fd = -1;
+    System::WriteMode m_mode;
+    System::SyncMode m_sync;
+    CreationResult::Code m_code = CreationResult::Code::OK;  ///< Set when something failed
+};
+
 }  // namespace CalamaresUtils
 
 #endif
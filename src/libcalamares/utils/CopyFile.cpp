@@ -0,0 +1,207 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "CopyFile.h"
+
+#include "Logger.h"
+#include "Units.h"
+
+#include <QFile>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/sendfile.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace CalamaresUtils
+{
+
+namespace
+{
+/// @brief Closes a file descriptor when it goes out of scope
+struct FileDescriptor
+{
+    explicit FileDescriptor( int d )
+        : fd( d )
+    {
+    }
+    ~FileDescriptor()
+    {
+        if ( fd >= 0 )
+        {
+            ::close( fd );
+        }
+    }
+    FileDescriptor( const FileDescriptor& ) = delete;
+    FileDescriptor& operator=( const FileDescriptor& ) = delete;
+
+    int fd;
+};
+
+/// How much the kernel is asked to copy in one go
+constexpr size_t kernelChunk = 64_MiB;
+
+/// @brief Result of one of the kernel copy methods
+enum class Copied
+{
+    All,  ///< Up to the end of the source
+    Failed,  ///< Something went wrong, errno is set
+    Unsupported  ///< Nothing copied, try the next method
+};
+
+/** @brief Has a copy-call that failed before copying anything failed for good?
+ *
+ * These are the errors for filesystems (or kernels) that can't do it
+ * and for files that aren't regular; anything else is a real error.
+ */
+bool
+isUnsupported( int error )
+{
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP || error == EBADF;
+}
+
+#ifdef Q_OS_LINUX
+Copied
+copyFileRange( int in, int out )
+{
+    bool copiedAny = false;
+    while ( true )
+    {
+        const ssize_t n = ::copy_file_range( in, nullptr, out, nullptr, kernelChunk, 0 );
+        if ( n == 0 )
+        {
+            return Copied::All;
+        }
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return ( !copiedAny && isUnsupported( errno ) ) ? Copied::Unsupported : Copied::Failed;
+        }
+        copiedAny = true;
+    }
+}
+
+Copied
+sendFile( int in, int out )
+{
+    bool copiedAny = false;
+    while ( true )
+    {
+        const ssize_t n = ::sendfile( out, in, nullptr, kernelChunk );
+        if ( n == 0 )
+        {
+            return Copied::All;
+        }
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return ( !copiedAny && isUnsupported( errno ) ) ? Copied::Unsupported : Copied::Failed;
+        }
+        copiedAny = true;
+    }
+}
+#endif
+
+/// @brief Copies by reading and writing, for when the kernel can't do it
+bool
+readWrite( int in, int out )
+{
+    std::vector< char > buffer( 1_MiB );
+    while ( true )
+    {
+        const ssize_t n = ::read( in, buffer.data(), buffer.size() );
+        if ( n == 0 )
+        {
+            return true;
+        }
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+        for ( ssize_t written = 0; written < n; )
+        {
+            const ssize_t w = ::write( out, buffer.data() + written, size_t( n - written ) );
+            if ( w < 0 && errno != EINTR )
+            {
+                return false;
+            }
+            written += w > 0 ? w : 0;
+        }
+    }
+}
+}  // namespace
+
+bool
+copyFile( const QString& source, const QString& destination, CopyMetadata metadata )
+{
+    FileDescriptor in( ::open( QFile::encodeName( source ).constData(), O_RDONLY | O_CLOEXEC ) );
+    struct stat st;
+    if ( in.fd < 0 || ::fstat( in.fd, &st ) != 0 )
+    {
+        cWarning() << "Could not read" << source;
+        return false;
+    }
+
+    const mode_t mode = metadata == CopyMetadata::ModeAndTimes ? ( st.st_mode & 07777 ) : 0666;
+    FileDescriptor out(
+        ::open( QFile::encodeName( destination ).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode ) );
+    if ( out.fd < 0 )
+    {
+        cWarning() << "Could not open" << destination << "for writing; could not copy" << source;
+        return false;
+    }
+
+    // Files in /proc and /sys claim to be empty, the kernel copies nothing from them
+    const bool tryKernel = S_ISREG( st.st_mode ) && st.st_size > 0;
+    Copied copied = Copied::Unsupported;
+#ifdef Q_OS_LINUX
+    if ( tryKernel )
+    {
+        copied = copyFileRange( in.fd, out.fd );
+        if ( copied == Copied::Unsupported )
+        {
+            copied = sendFile( in.fd, out.fd );
+        }
+    }
+#else
+    Q_UNUSED( tryKernel )
+#endif
+    bool ok = copied == Copied::Unsupported ? readWrite( in.fd, out.fd ) : copied == Copied::All;
+
+    if ( ok && metadata == CopyMetadata::ModeAndTimes )
+    {
+        // The mode given to open() is limited by the umask, and it doesn't
+        // apply at all to an existing file.
+        const struct timespec times[ 2 ] = { st.st_atim, st.st_mtim };
+        ok = ::fchmod( out.fd, st.st_mode & 07777 ) == 0 && ::futimens( out.fd, times ) == 0;
+    }
+    if ( !ok )
+    {
+        cWarning() << "Could not copy" << source << "to" << destination << ':' << strerror( errno );
+    }
+    return ok;
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,44 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_COPYFILE_H
+#define UTILS_COPYFILE_H
+
+#include "DllMacro.h"
+
+#include <QString>
+
+namespace CalamaresUtils
+{
+/// @brief What copyFile() takes over from the source, besides the contents
+enum class CopyMetadata
+{
+    None,  ///< The new file gets the usual mode (0666 minus the umask)
+    ModeAndTimes  ///< The new file gets the mode bits and modification time of the source
+};
+
+/** @brief Copies the file @p source to @p destination
+ *
+ * The data is copied by the kernel (with copy_file_range(2) or
+ * sendfile(2)) where possible, so it never passes through Calamares;
+ * otherwise it is copied in chunks. Either way the file is never held
+ * in memory as a whole, and a file that is still growing (like the
+ * session log) is copied up to where it ends when the copy gets there.
+ *
+ * An existing @p destination is overwritten. Both are paths in the
+ * **host** system, use System::targetPath() for the target.
+ *
+ * @return @c true on success; on failure a warning is logged and
+ *      @p destination may be incomplete.
+ */
+DLLEXPORT bool
+copyFile( const QString& source, const QString& destination, CopyMetadata metadata = CopyMetadata::ModeAndTimes );
+}  // namespace CalamaresUtils
+
+#endif
@@ -0,0 +1,210 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "HostInfo.h"
+
+#include "Logger.h"
+#include "partition/Disks.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <unistd.h>
+
+#ifdef Q_OS_LINUX
+#include <sys/sysinfo.h>
+#endif
+
+#ifdef Q_OS_FREEBSD
+// clang-format off
+// these includes need to stay in-order (that's a FreeBSD thing)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+// clang-format on
+#endif
+
+#include <cstring>
+#include <mutex>
+
+namespace CalamaresUtils
+{
+
+static QString
+cpuVendorMatch( const QString& s )
+{
+    const QString line = s.toLower();
+    if ( line.contains( "intel" ) )
+    {
+        return QStringLiteral( "Intel" );
+    }
+    else if ( line.contains( "amd" ) )
+    {
+        return QStringLiteral( "AMD" );
+    }
+    return QString();
+}
+
+#if defined( Q_OS_LINUX )
+/// @brief The value of a "key : value" line from /proc/cpuinfo
+static QString
+cpuinfoValue( const QByteArray& line )
+{
+    return QString::fromLatin1( line.mid( line.indexOf( ':' ) + 1 ) ).simplified();
+}
+
+static void
+readCpu( HostInfo& h )
+{
+    QFile cpuinfo( "/proc/cpuinfo" );
+    if ( !cpuinfo.open( QIODevice::ReadOnly ) )
+    {
+        return;
+    }
+
+    // Only the first processor is interesting, the rest are the same (or close enough)
+    const auto lines = cpuinfo.readAll().split( '\n' );
+    for ( const QByteArray& line : lines )
+    {
+        if ( line.trimmed().isEmpty() && !h.cpuVendor.isEmpty() )
+        {
+            break;
+        }
+        if ( h.cpuVendor.isEmpty() && line.startsWith( "vendor_id" ) )
+        {
+            h.cpuVendor = cpuVendorMatch( cpuinfoValue( line ) );
+        }
+        else if ( h.cpuVendor.isEmpty() && line.startsWith( "CPU implementer" ) )
+        {
+            /* The "CPU implementer" line is for ARM CPUs in general.
+             *
+             * The specific value given distinguishes *which designer*
+             * (or architecture licensee, who cares) produced the current
+             * silicon, e.g. 0x41 is ARM, 0x51 is Qualcomm (see lscpu-arm.c).
+             * Since the specific implementor isn't interesting, just
+             * map everything to "ARM".
+             */
+            h.cpuVendor = QStringLiteral( "ARM" );
+        }
+        else if ( h.cpuModel.isEmpty() && line.startsWith( "model name" ) )
+        {
+            h.cpuModel = cpuinfoValue( line );
+        }
+    }
+}
+
+static void
+readMemory( HostInfo& h )
+{
+    struct sysinfo i;
+    if ( sysinfo( &i ) == 0 )
+    {
+        h.memory = qMakePair( quint64( i.mem_unit ) * quint64( i.totalram ), 1.1f );
+    }
+}
+#elif defined( Q_OS_FREEBSD )
+static void
+readCpu( HostInfo& h )
+{
+    constexpr const size_t sysctl_buffer_size = 128;
+    char sysctl_buffer[ sysctl_buffer_size ];
+    size_t s = sysctl_buffer_size;
+
+    memset( sysctl_buffer, 0, sizeof( sysctl_buffer ) );
+    if ( sysctlbyname( "hw.model", &sysctl_buffer, &s, NULL, 0 ) == 0 )
+    {
+        sysctl_buffer[ sysctl_buffer_size - 1 ] = 0;
+        h.cpuModel = QString( sysctl_buffer ).simplified();
+        h.cpuVendor = cpuVendorMatch( h.cpuModel );
+    }
+}
+
+static void
+readMemory( HostInfo& h )
+{
+    unsigned long memsize;
+    size_t s = sizeof( memsize );
+
+    if ( sysctlbyname( "vm.kmem_size", &memsize, &s, NULL, 0 ) == 0 )
+    {
+        h.memory = qMakePair( quint64( memsize ), 1.01f );
+    }
+}
+#else
+static void
+readCpu( HostInfo& )
+{
+}
+
+static void
+readMemory( HostInfo& )
+{
+}
+#endif
+
+static bool
+hasBattery()
+{
+    QDir baseDir( "/sys/class/power_supply" );
+    const auto entries = baseDir.entryList( QDir::AllDirs | QDir::Readable | QDir::NoDotAndDotDot );
+    for ( const auto& item : entries )
+    {
+        QFile typeFile( baseDir.absoluteFilePath( QString( "%1/type" ).arg( item ) ) );
+        if ( typeFile.open( QIODevice::ReadOnly | QIODevice::Text ) && typeFile.readAll().startsWith( "Battery" ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static HostInfo
+readHostInfo()
+{
+    HostInfo h;
+    readCpu( h );
+    const long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+    h.cpuCount = cpus > 0 ? int( cpus ) : 1;
+    readMemory( h );
+    h.isEfi = QDir( "/sys/firmware/efi/efivars" ).exists();
+    h.hasBattery = hasBattery();
+    // Not kept here, since it may be rescanned, but this reads the list in the background too
+    const int diskCount = CalamaresUtils::Partition::disks().count();
+
+    cDebug() << "Host" << h.cpuVendor << h.cpuModel << h.cpuCount << "CPUs," << h.memory.first << "bytes RAM,"
+             << ( h.isEfi ? "EFI," : "BIOS," ) << diskCount << "block devices";
+    return h;
+}
+
+const HostInfo&
+hostInfo()
+{
+    static std::once_flag once;
+    static HostInfo info;
+    std::call_once( once, [] { info = readHostInfo(); } );
+    return info;
+}
+
+namespace
+{
+class HostInfoReader : public QRunnable
+{
+public:
+    void run() override { (void)hostInfo(); }
+};
+}  // namespace
+
+void
+startHostInfo()
+{
+    QThreadPool::globalInstance()->start( new HostInfoReader );
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,57 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef UTILS_HOSTINFO_H
+#define UTILS_HOSTINFO_H
+
+#include "DllMacro.h"
+
+#include <QPair>
+#include <QString>
+
+namespace CalamaresUtils
+{
+/** @brief Facts about the machine Calamares is running on
+ *
+ * These don't change while Calamares runs, so they are found only
+ * once: @see hostInfo(). Disks can come and go, so they are not here;
+ * use CalamaresUtils::Partition::disks() for those.
+ */
+struct DLLEXPORT HostInfo
+{
+    QString cpuVendor;  ///< "Intel", "AMD" or "ARM", or empty if unknown
+    QString cpuModel;  ///< e.g. "Intel(R) Core(TM) i5-8250U CPU @ 1.60GHz", may be empty
+    int cpuCount = 0;  ///< Logical CPUs that are online
+
+    /// Size (in bytes) and guesstimate factor, @see System::getTotalMemoryB()
+    QPair< quint64, float > memory { 0, 0.0 };
+
+    bool isEfi = false;  ///< Booted with UEFI (rather than BIOS)
+    bool hasBattery = false;  ///< There is a battery (whether it is in use or not)
+};
+
+/** @brief Information about the host, found once and shared
+ *
+ * The first call finds the information, which involves reading a
+ * handful of files in /proc and /sys (and the list of disks is read,
+ * too); later calls (from any thread) return the same object. If startHostInfo() was called, this waits
+ * for it to finish instead.
+ */
+DLLEXPORT const HostInfo& hostInfo();
+
+/** @brief Starts finding the host information in the background
+ *
+ * Call this early at startup, so that hostInfo() is ready when a
+ * module asks for it.
+ */
+DLLEXPORT void startHostInfo();
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -9,15 +9,220 @@
 
 #include "Logger.h"
 
-#include <QProcess>
+#include <QByteArrayList>
+#include <QMutex>
+#include <QRunnable>
 #include <QString>
 #include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <grp.h>
+#include <pwd.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <vector>
 
 namespace CalamaresUtils
 {
 
+namespace
+{
+/** @brief Shared state of applyRecursive()
+ *
+ * Directories that still need to be walked are queued. Each worker
+ * takes one, changes everything in it and queues the subdirectories
+ * it finds. The walk is done when the queue is empty and no worker is
+ * busy (a busy worker may still queue more directories).
+ */
+class TreeWalk
+{
+public:
+    TreeWalk( int uid, int gid, int mode )
+        : m_uid( uid_t( uid ) )
+        , m_gid( gid_t( gid ) )
+        , m_mode( mode )
+    {
+    }
+
+    /// @brief Changes @p name relative to directory @p dirFd
+    void change( int dirFd, const char* name, bool isLink )
+    {
+        if ( ::fchownat( dirFd, name, m_uid, m_gid, AT_SYMLINK_NOFOLLOW ) != 0 )
+        {
+            fail( name );
+        }
+        // Linux has no lchmod(), and links have no mode of their own anyway
+        if ( m_mode >= 0 && !isLink && ::fchmodat( dirFd, name, mode_t( m_mode ), 0 ) != 0 )
+        {
+            fail( name );
+        }
+    }
+
+    void enqueue( const QByteArrayList& directories )
+    {
+        if ( directories.isEmpty() )
+        {
+            return;
+        }
+        QMutexLocker lock( &m_mutex );
+        m_queue.append( directories );
+        m_changed.wakeAll();
+    }
+
+    /// @brief Walks queued directories until there are none left
+    void run()
+    {
+        QMutexLocker lock( &m_mutex );
+        while ( true )
+        {
+            while ( m_queue.isEmpty() && m_busy > 0 )
+            {
+                m_changed.wait( &m_mutex );
+            }
+            if ( m_queue.isEmpty() )
+            {
+                // Nothing queued and nobody busy: wake the other idle workers
+                m_changed.wakeAll();
+                return;
+            }
+            const QByteArray directory = m_queue.takeLast();
+            ++m_busy;
+            lock.unlock();
+
+            enqueue( walk( directory ) );
+
+            lock.relock();
+            --m_busy;
+            m_changed.wakeAll();
+        }
+    }
+
+    bool isOk() const { return !m_failed; }
+
+private:
+    /// @brief Changes everything in @p directory, returns the subdirectories
+    QByteArrayList walk( const QByteArray& directory )
+    {
+        QByteArrayList subdirectories;
+        const int fd = ::open( directory.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC );
+        DIR* dir = fd < 0 ? nullptr : ::fdopendir( fd );
+        if ( !dir )
+        {
+            if ( fd >= 0 )
+            {
+                ::close( fd );
+            }
+            fail( directory.constData() );
+            return subdirectories;
+        }
+
+        while ( const struct dirent* entry = ::readdir( dir ) )
+        {
+            const char* name = entry->d_name;
+            if ( name[ 0 ] == '.' && ( name[ 1 ] == '\0' || ( name[ 1 ] == '.' && name[ 2 ] == '\0' ) ) )
+            {
+                continue;
+            }
+
+            bool isDirectory = entry->d_type == DT_DIR;
+            bool isLink = entry->d_type == DT_LNK;
+            // Not all filesystems fill in the type
+            struct stat st;
+            if ( entry->d_type == DT_UNKNOWN && ::fstatat( fd, name, &st, AT_SYMLINK_NOFOLLOW ) == 0 )
+            {
+                isDirectory = S_ISDIR( st.st_mode );
+                isLink = S_ISLNK( st.st_mode );
+            }
+
+            change( fd, name, isLink );
+            if ( isDirectory )
+            {
+                subdirectories.append( directory + '/' + name );
+            }
+        }
+        ::closedir( dir );
+        return subdirectories;
+    }
+
+    void fail( const char* name )
+    {
+        // Only the first one is logged, the rest likely fail for the same reason
+        if ( !m_failed.exchange( true ) )
+        {
+            cDebug() << Logger::SubEntry << "Could not change" << name << "in a recursive chown/chmod.";
+        }
+    }
+
+    const uid_t m_uid;
+    const gid_t m_gid;
+    const int m_mode;
+
+    QMutex m_mutex;
+    QWaitCondition m_changed;
+    QByteArrayList m_queue;
+    int m_busy = 0;
+    std::atomic< bool > m_failed { false };
+};
+
+class TreeWalker : public QRunnable
+{
+public:
+    TreeWalker( TreeWalk& walk )
+        : m_walk( walk )
+    {
+    }
+    void run() override { m_walk.run(); }
+
+private:
+    TreeWalk& m_walk;
+};
+
+/** @brief Looks up user @p name in the host system
+ *
+ * Like chown(8), a number that is not a user name is taken as a uid.
+ */
+bool
+lookupUser( const QString& name, uid_t& uid )
+{
+    const QByteArray n = name.toUtf8();
+    struct passwd pw;
+    struct passwd* result = nullptr;
+    std::vector< char > buffer( 4096 );
+    if ( ::getpwnam_r( n.constData(), &pw, buffer.data(), buffer.size(), &result ) == 0 && result )
+    {
+        uid = pw.pw_uid;
+        return true;
+    }
+    bool ok = false;
+    uid = uid_t( name.toUInt( &ok ) );
+    return ok;
+}
+
+/// @brief Looks up group @p name in the host system, like lookupUser()
+bool
+lookupGroup( const QString& name, gid_t& gid )
+{
+    const QByteArray n = name.toUtf8();
+    struct group gr;
+    struct group* result = nullptr;
+    std::vector< char > buffer( 4096 );
+    if ( ::getgrnam_r( n.constData(), &gr, buffer.data(), buffer.size(), &result ) == 0 && result )
+    {
+        gid = gr.gr_gid;
+        return true;
+    }
+    bool ok = false;
+    gid = gid_t( name.toUInt( &ok ) );
+    return ok;
+}
+}  // namespace
+
 Permissions::Permissions()
     : m_username()
     , m_group()
@@ -100,12 +305,12 @@ Permissions::apply( const QString& path, const CalamaresUtils::Permissions& p )
     bool r = apply( path, p.value() );
     if ( r )
     {
-        // We don't use chgrp(2) or chown(2) here because then we need to
-        // go through the users list (which one, target or source?) to get
-        // uid_t and gid_t values to pass to that system call.
-        //
-        // Do a lame cop-out and let the chown(8) utility do the heavy lifting.
-        if ( QProcess::execute( "chown", { p.username() + ':' + p.group(), path } ) )
+        // The names are looked up in the host system, like chown(8) would
+        // (that used to be run here, one process per file).
+        uid_t uid = 0;
+        gid_t gid = 0;
+        if ( !lookupUser( p.username(), uid ) || !lookupGroup( p.group(), gid )
+             || ::chown( path.toUtf8().constData(), uid, gid ) != 0 )
         {
             r = false;
             cDebug() << Logger::SubEntry << "Could not set owner of" << path << "to"
@@ -119,5 +324,34 @@ Permissions::apply( const QString& path, const CalamaresUtils::Permissions& p )
     return r;
 }
 
+bool
+Permissions::applyRecursive( const QString& path, int uid, int gid, int mode )
+{
+    const QByteArray top = path.toUtf8();
+    struct stat st;
+    if ( ::lstat( top.constData(), &st ) != 0 )
+    {
+        cDebug() << Logger::SubEntry << "Could not find" << path;
+        return false;
+    }
+
+    TreeWalk walk( uid, gid, mode );
+    walk.change( AT_FDCWD, top.constData(), S_ISLNK( st.st_mode ) );
+    if ( S_ISDIR( st.st_mode ) )
+    {
+        walk.enqueue( { top } );
+
+        // A pool of our own, so that the walk doesn't wait on (or block) other work;
+        // the workers are auto-deleted by the pool.
+        QThreadPool pool;
+        pool.setMaxThreadCount( qBound( 1, QThread::idealThreadCount(), 8 ) );
+        for ( int i = 0; i < pool.maxThreadCount(); ++i )
+        {
+            pool.start( new TreeWalker( walk ) );
+        }
+        pool.waitForDone();
+    }
+    return walk.isOk();
+}
 
 }  // namespace CalamaresUtils
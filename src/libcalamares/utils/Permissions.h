@@ -81,6 +81,22 @@ public:
     /// Convenience method for apply(const QString&, const Permissions& )
     bool apply( const QString& path ) const { return apply( path, *this ); }
 
+    /** @brief Sets the owner of @p path and of everything below it
+     *
+     * This is like chown -R (and chmod -R, if @p mode is not -1),
+     * without running the tools. Symbolic links are changed themselves,
+     * never followed, and they do not get a @p mode. The directories
+     * are walked by a pool of threads, which matters for big trees
+     * (e.g. a home directory filled from a large /etc/skel).
+     *
+     * The @p uid and @p gid are numeric, so they mean the same thing in
+     * the host and the target system; pass -1 to leave either unchanged.
+     * Pass a path that is relative (or absolute) in the **host** system.
+     *
+     * @return @c true if everything was changed
+     */
+    static bool applyRecursive( const QString& path, int uid, int gid, int mode = -1 );
+
 private:
     void parsePermissions( QString const& p );
 
@@ -39,6 +39,7 @@ private Q_SLOTS:
     void testCreateTargetExists();
     void testCreateTargetOverwrite();
     void testCreateTargetBasedirs();
+    void testTargetFileWriter();
 
 private:
     CalamaresUtils::System* m_system = nullptr;  // Points to singleton instance, not owned
@@ -257,6 +258,88 @@ TestPaths::testCreateTargetBasedirs()
     QCOMPARE( QFileInfo( "/tmp/var/lib/dbus/bogus" ).dir().path(), QStringLiteral( "/tmp/var/lib/dbus" ) );
 }
 
+void
+TestPaths::testTargetFileWriter()
+{
+    using CalamaresUtils::System;
+    using CalamaresUtils::TargetFileWriter;
+
+    static const char ltestFile[] = "cala-test-writer";
+    GSRollback g( QStringLiteral( "rootMountPoint" ) );
+
+    QTemporaryDir d;
+    d.setAutoRemove( true );
+    Calamares::JobQueue::instance()->globalStorage()->insert( QStringLiteral( "rootMountPoint" ), d.path() );
+    const QString target = d.filePath( QString( ltestFile ) );
+
+    {
+        TargetFileWriter w( ltestFile );
+        QVERIFY( w.isValid() );
+        QVERIFY( w.write( "Hello" ) );
+        QVERIFY( w.write( ", world" ) );
+        QVERIFY( !QFileInfo::exists( target ) );  // Not there until commit
+        auto r = w.commit();
+        QVERIFY( r );
+        QCOMPARE( r.path(), QFileInfo( target ).canonicalFilePath() );
+        QVERIFY( !w.isValid() );
+        QVERIFY( !w.commit() );
+    }
+    QCOMPARE( QFileInfo( target ).size(), 12 );
+    QVERIFY( QFile::setPermissions( target, QFileDevice::ReadOwner | QFileDevice::WriteOwner ) );
+
+    // Not committed, the original is unchanged and no new files are left behind
+    {
+        TargetFileWriter w( ltestFile, System::WriteMode::Overwrite );
+        QVERIFY( w.isValid() );
+        QVERIFY( w.write( "Goodbye" ) );
+    }
+    QCOMPARE( QFileInfo( target ).size(), 12 );
+    QCOMPARE( QDir( d.path() ).entryList( QDir::Files ).count(), 1 );
+
+    // Replacing keeps the mode
+    {
+        TargetFileWriter w( ltestFile, System::WriteMode::Overwrite, System::SyncMode::Sync );
+        QVERIFY( w.write( "Goodbye" ) );
+        QVERIFY( w.commit() );
+    }
+    QCOMPARE( QFileInfo( target ).size(), 7 );
+    // Owner, group and other bits; the user bits depend on who runs the test
+    QCOMPARE( QFile::permissions( target ) & 0x7077, QFileDevice::ReadOwner | QFileDevice::WriteOwner );
+
+    // A file that appears while writing is kept
+    QVERIFY( QFile::remove( target ) );
+    {
+        TargetFileWriter w( ltestFile );
+        QVERIFY( w.isValid() );
+        QVERIFY( w.write( "Mine" ) );
+        QFile other( target );
+        QVERIFY( other.open( QIODevice::WriteOnly ) );
+        other.write( "Theirs!" );
+        other.close();
+
+        auto r = w.commit();
+        QVERIFY( !r );
+        QVERIFY( !r.failed() );
+        QCOMPARE( r.code(), CalamaresUtils::CreationResult::Code::AlreadyExists );
+    }
+    QCOMPARE( QFileInfo( target ).size(), 7 );
+    QCOMPARE( QDir( d.path() ).entryList( QDir::Files ).count(), 1 );
+
+    // Existing file, or no directory to write in
+    {
+        TargetFileWriter w( ltestFile );
+        QVERIFY( !w.isValid() );
+        QVERIFY( !w.write( "Hello" ) );
+        QCOMPARE( w.commit().code(), CalamaresUtils::CreationResult::Code::AlreadyExists );
+    }
+    {
+        TargetFileWriter w( QStringLiteral( "/nonexistent/file" ) );
+        QVERIFY( !w.isValid() );
+        QVERIFY( w.commit().failed() );
+    }
+}
+
+
 QTEST_GUILESS_MAIN( TestPaths )
 
 #include "utils/moc-warnings.h"
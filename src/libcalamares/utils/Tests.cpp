@@ -10,8 +10,11 @@
  */
 
 #include "CalamaresUtilsSystem.h"
+#include "CopyFile.h"
 #include "Entropy.h"
+#include "HostInfo.h"
 #include "Logger.h"
+#include "Permissions.h"
 #include "RAII.h"
 #include "Traits.h"
 #include "UMask.h"
@@ -21,6 +24,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 
 #include <QtTest/QtTest>
@@ -45,9 +49,19 @@ private Q_SLOTS:
 
     void testCommands();
 
+    /** @brief Test the cached host information. */
+    void testHostInfo();
+
     /** @brief Test that all the UMask objects work correctly. */
     void testUmask();
 
+    /** @brief Tests copying files, with and without metadata. */
+    void testCopyFile();
+
+    /** @brief Tests recursive chown/chmod (and how fast it is). */
+    void testPermissionsRecursive();
+    void benchmarkPermissionsRecursive();
+
     /** @brief Tests the entropy functions. */
     void testEntropy();
     void testPrintableEntropy();
@@ -217,6 +231,21 @@ LibCalamaresTests::testCommands()
     QVERIFY( r.getOutput().contains( tfn.fileName() ) );
 }
 
+void
+LibCalamaresTests::testHostInfo()
+{
+    using namespace CalamaresUtils;
+
+    const HostInfo& info = hostInfo();
+    QCOMPARE( &hostInfo(), &info );  // Read only once
+    QVERIFY( info.cpuCount >= 1 );
+    QCOMPARE( System::instance()->getCpuDescription(), info.cpuModel );
+#ifdef Q_OS_LINUX
+    QVERIFY( info.memory.first > 0 );
+    QCOMPARE( System::instance()->getTotalMemoryB(), info.memory );
+#endif
+}
+
 void
 LibCalamaresTests::testUmask()
 {
@@ -247,6 +276,145 @@ LibCalamaresTests::testUmask()
     QCOMPARE( CalamaresUtils::setUMask( m ), mode_t( 022 ) );
 }
 
+void
+LibCalamaresTests::testCopyFile()
+{
+    using CalamaresUtils::copyFile;
+    using CalamaresUtils::CopyMetadata;
+
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QString source = tempRoot.filePath( QStringLiteral( "source" ) );
+    const QString dest = tempRoot.filePath( QStringLiteral( "dest" ) );
+
+    // Bigger than one chunk of the fallback copy, and not a multiple of it
+    QByteArray data( 3 * 1024 * 1024 + 17, 'c' );
+    data[ 12345 ] = 'x';
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        QCOMPARE( f.write( data ), qint64( data.size() ) );
+    }
+    QVERIFY( chmod( QFile::encodeName( source ), 0604 ) == 0 );
+    const struct timespec times[ 2 ] = { { 1000000000, 0 }, { 1000000000, 0 } };
+    QVERIFY( utimensat( AT_FDCWD, QFile::encodeName( source ), times, 0 ) == 0 );
+
+    struct stat st;
+    QVERIFY( copyFile( source, dest ) );
+    {
+        QFile f( dest );
+        QVERIFY( f.open( QIODevice::ReadOnly ) );
+        QCOMPARE( f.readAll(), data );
+    }
+    QCOMPARE( stat( QFile::encodeName( dest ), &st ), 0 );
+    QCOMPARE( st.st_mode & 07777, mode_t( 0604 ) );
+    QCOMPARE( st.st_mtim.tv_sec, time_t( 1000000000 ) );
+
+    // Overwrites, and a shorter file truncates
+    {
+        QFile f( source );
+        QVERIFY( f.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+        QCOMPARE( f.write( "short" ), qint64( 5 ) );
+    }
+    QVERIFY( copyFile( source, dest, CopyMetadata::None ) );
+    QCOMPARE( QFileInfo( dest ).size(), qint64( 5 ) );
+    QCOMPARE( stat( QFile::encodeName( dest ), &st ), 0 );
+    QVERIFY( st.st_mtim.tv_sec != time_t( 1000000000 ) );
+
+#ifdef Q_OS_LINUX
+    // Files that claim to be empty are still copied
+    QVERIFY( copyFile( QStringLiteral( "/proc/self/status" ), dest ) );
+    QVERIFY( QFileInfo( dest ).size() > 0 );
+#endif
+
+    QVERIFY( !copyFile( tempRoot.filePath( QStringLiteral( "nonexistent" ) ), dest ) );
+    QVERIFY( !copyFile( source, tempRoot.filePath( QStringLiteral( "nonexistent/dest" ) ) ) );
+}
+
+/// @brief Creates @p dirs directories with @p files files each below @p root, returns the count
+static int
+makeTree( const QString& root, int dirs, int files )
+{
+    int count = 0;
+    for ( int d = 0; d < dirs; ++d )
+    {
+        const QString dir = QStringLiteral( "%1/%2/%3" ).arg( root ).arg( d % 10 ).arg( d );
+        if ( !QDir().mkpath( dir ) )
+        {
+            return -1;
+        }
+        for ( int f = 0; f < files; ++f )
+        {
+            QFile file( QStringLiteral( "%1/%2" ).arg( dir ).arg( f ) );
+            if ( !file.open( QIODevice::WriteOnly ) )
+            {
+                return -1;
+            }
+            ++count;
+        }
+    }
+    return count;
+}
+
+void
+LibCalamaresTests::testPermissionsRecursive()
+{
+    using CalamaresUtils::Permissions;
+
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QString root = tempRoot.path();
+    QCOMPARE( makeTree( root, 20, 5 ), 100 );
+    QVERIFY( QFile::link( QStringLiteral( "/nonexistent" ), root + QStringLiteral( "/3/3/link" ) ) );
+
+    struct stat st;
+    const QByteArray deepFile = ( root + QStringLiteral( "/7/17/4" ) ).toUtf8();
+    const QByteArray deepDir = ( root + QStringLiteral( "/7/17" ) ).toUtf8();
+
+    // Our own uid and gid, so that this works as a regular user
+    QVERIFY( Permissions::applyRecursive( root, int( getuid() ), int( getgid() ), 0700 ) );
+    QCOMPARE( stat( deepFile, &st ), 0 );
+    QCOMPARE( st.st_mode & 07777, mode_t( 0700 ) );
+    QCOMPARE( stat( deepDir, &st ), 0 );
+    QCOMPARE( st.st_mode & 07777, mode_t( 0700 ) );
+    QCOMPARE( st.st_uid, getuid() );
+
+    // Owner only, the modes stay as they are
+    QVERIFY( Permissions::applyRecursive( root, -1, int( getgid() ) ) );
+    QCOMPARE( stat( deepFile, &st ), 0 );
+    QCOMPARE( st.st_mode & 07777, mode_t( 0700 ) );
+
+    // A single file is fine, a missing one isn't
+    QVERIFY( Permissions::applyRecursive( QString::fromUtf8( deepFile ), -1, -1, 0600 ) );
+    QCOMPARE( stat( deepFile, &st ), 0 );
+    QCOMPARE( st.st_mode & 07777, mode_t( 0600 ) );
+    QVERIFY( !Permissions::applyRecursive( root + QStringLiteral( "/nonexistent" ), -1, -1 ) );
+
+    if ( getuid() != 0 )
+    {
+        // Giving files away is not allowed
+        QVERIFY( !Permissions::applyRecursive( root, 0, 0 ) );
+    }
+}
+
+void
+LibCalamaresTests::benchmarkPermissionsRecursive()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    // This runs with the normal tests, so the tree is small; to compare
+    // with a big home directory, use 1000 directories of 100 files.
+    QCOMPARE( makeTree( tempRoot.path(), 50, 40 ), 2000 );
+
+    int mode = 0700;
+    QBENCHMARK
+    {
+        QVERIFY( CalamaresUtils::Permissions::applyRecursive(
+            tempRoot.path(), int( getuid() ), int( getgid() ), mode ) );
+        mode ^= 0050;
+    }
+}
+
 void
 LibCalamaresTests::testEntropy()
 {
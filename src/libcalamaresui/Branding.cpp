@@ -141,6 +141,7 @@ Branding::Branding( const QString& brandingFilePath, QObject* parent )
     : QObject( parent )
     , m_descriptorPath( brandingFilePath )
     , m_slideshowAPI( 1 )
+    , m_slideshowWarmup( false )
     , m_welcomeStyleCalamares( false )
     , m_welcomeExpandingLogo( true )
 {
@@ -299,6 +300,23 @@ Branding::image( Branding::ImageEntry imageEntry, const QSize& size ) const
     }
 }
 
+void
+Branding::imageAsync( Branding::ImageEntry imageEntry,
+                      const QSize& size,
+                      QObject* context,
+                      std::function< void( const QPixmap& ) > callback ) const
+{
+    const auto path = imagePath( imageEntry );
+    if ( path.contains( '/' ) )
+    {
+        ImageRegistry::instance()->pixmapAsync( path, size, CalamaresUtils::Original, context, std::move( callback ) );
+    }
+    else
+    {
+        callback( image( imageEntry, size ) );
+    }
+}
+
 QPixmap
 Branding::image( const QString& imageName, const QSize& size ) const
 {
@@ -559,6 +577,7 @@ Branding::initSlideshowSettings( const YAML::Node& doc )
             api = 1;
         }
         m_slideshowAPI = api;
+        m_slideshowWarmup = doc[ "slideshowWarmup" ].as< bool >( false );
     }
 #else
     else if ( slideshow.IsScalar() )
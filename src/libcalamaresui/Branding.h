@@ -23,6 +23,8 @@
 #include <QSize>
 #include <QStringList>
 
+#include <functional>
+
 namespace YAML
 {
 class Node;
@@ -172,8 +174,26 @@ public:
      *  - -1    For oldschool image-slideshows.
      */
     int slideshowAPI() const { return m_slideshowAPI; }
+    /** @brief Should the QML slideshow be prepared before it is shown?
+     *
+     * If true, the slideshow is loaded (API 2) or compiled (API 1)
+     * while the step before the execution step (usually the summary)
+     * is shown, rather than at startup or at the start of the
+     * execution step.
+     */
+    bool slideshowWarmup() const { return m_slideshowWarmup; }
 
     QPixmap image( Branding::ImageEntry imageEntry, const QSize& size ) const;
+    /** @brief Load a branding image in the background
+     *
+     * Like image(), but the @p callback gets the pixmap once it is
+     * rendered, @see ImageRegistry::pixmapAsync(). Theme icons are
+     * passed to the @p callback right away.
+     */
+    void imageAsync( Branding::ImageEntry imageEntry,
+                     const QSize& size,
+                     QObject* context,
+                     std::function< void( const QPixmap& ) > callback ) const;
 
     /** @brief Look up an image in the branding directory or as an icon
      *
@@ -251,6 +271,7 @@ private:
     QStringList m_slideshowFilenames;
     QString m_slideshowPath;
     int m_slideshowAPI;
+    bool m_slideshowWarmup;
     QString m_translationsPathPrefix;
 
     /** @brief Initialize the simple settings below */
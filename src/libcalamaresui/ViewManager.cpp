@@ -287,6 +287,21 @@ stepIsExecute( const ViewStepList& steps, int index )
         && ( qobject_cast< ExecutionViewStep* >( steps.at( index ) ) != nullptr );
 }
 
+/** @brief Prepare the execution step after @p index, if there is one
+ *
+ * When the step at @p index is shown, and the next step is an
+ * execution step, this gives the execution step a chance to
+ * prepare its slideshow.
+ */
+static inline void
+warmUpNextExecute( const ViewStepList& steps, int index )
+{
+    if ( stepIsExecute( steps, index + 1 ) )
+    {
+        qobject_cast< ExecutionViewStep* >( steps.at( index + 1 ) )->warmUp();
+    }
+}
+
 static inline bool
 isAtVeryEnd( const ViewStepList& steps, int index )
 {
@@ -359,6 +374,7 @@ ViewManager::next()
         {
             m_steps.at( m_currentStep )->onActivate();
             executing = qobject_cast< ExecutionViewStep* >( m_steps.at( m_currentStep ) ) != nullptr;
+            warmUpNextExecute( m_steps, m_currentStep );
             emit currentStepChanged();
         }
         else
@@ -456,6 +472,7 @@ ViewManager::back()
         m_stack->setCurrentIndex( m_currentStep );
         step->onLeave();
         m_steps.at( m_currentStep )->onActivate();
+        warmUpNextExecute( m_steps, m_currentStep );
         emit currentStepChanged();
     }
     else if ( !step->isAtBeginning() )
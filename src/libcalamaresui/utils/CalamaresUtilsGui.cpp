@@ -11,6 +11,7 @@
 #include "CalamaresUtilsGui.h"
 
 #include "ImageRegistry.h"
+#include "utils/Logger.h"
 
 #include <QBrush>
 #include <QFont>
@@ -29,94 +30,62 @@ static int s_defaultFontSize = 0;
 static int s_defaultFontHeight = 0;
 
 
-QPixmap
-defaultPixmap( ImageType type, ImageMode mode, const QSize& size )
+/// @brief The resource path of the image for @p type
+static QString
+defaultPixmapPath( ImageType type )
 {
-    Q_UNUSED( mode )
-    QPixmap pixmap;
-
     switch ( type )
     {
     case Yes:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/yes.svgz", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/yes.svgz" );
     case No:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/no.svgz", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/no.svgz" );
     case Information:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/information.svgz", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/information.svgz" );
     case Fail:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/fail.svgz", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/fail.svgz" );
     case Bugs:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/bugs.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/bugs.svg" );
     case Help:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/help.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/help.svg" );
     case Release:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/release.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/release.svg" );
     case Donate:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/donate.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/donate.svg" );
     case PartitionDisk:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-disk.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-disk.svg" );
     case PartitionPartition:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-partition.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-partition.svg" );
     case PartitionAlongside:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-alongside.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-alongside.svg" );
     case PartitionEraseAuto:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-erase-auto.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-erase-auto.svg" );
     case PartitionManual:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-manual.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-manual.svg" );
     case PartitionReplaceOs:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-replace-os.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-replace-os.svg" );
     case PartitionTable:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/partition-table.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/partition-table.svg" );
     case BootEnvironment:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/boot-environment.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/boot-environment.svg" );
     case Squid:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/squid.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/squid.svg" );
     case StatusOk:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/state-ok.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/state-ok.svg" );
     case StatusWarning:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/state-warning.svg", size );
-        break;
-
+        return QStringLiteral( RESPATH "images/state-warning.svg" );
     case StatusError:
-        pixmap = ImageRegistry::instance()->pixmap( RESPATH "images/state-error.svg", size );
-        break;
+        return QStringLiteral( RESPATH "images/state-error.svg" );
     }
+    return QString();
+}
+
+
+QPixmap
+defaultPixmap( ImageType type, ImageMode mode, const QSize& size )
+{
+    Q_UNUSED( mode )
+    QPixmap pixmap = ImageRegistry::instance()->pixmap( defaultPixmapPath( type ), size );
 
     if ( pixmap.isNull() )
     {
@@ -128,6 +97,32 @@ defaultPixmap( ImageType type, ImageMode mode, const QSize& size )
 }
 
 
+void
+defaultPixmapAsync( ImageType type,
+                    ImageMode mode,
+                    const QSize& size,
+                    QObject* context,
+                    std::function< void( const QPixmap& ) > callback )
+{
+    Q_UNUSED( mode )
+    // Like defaultPixmap(), a missing image is a bug; don't hand out an empty icon
+    ImageRegistry::instance()->pixmapAsync(
+        defaultPixmapPath( type ),
+        size,
+        CalamaresUtils::Original,
+        context,
+        [type, callback = std::move( callback )]( const QPixmap& pixmap ) {
+            if ( pixmap.isNull() )
+            {
+                cWarning() << "Default pixmap" << type << "could not be rendered.";
+                Q_ASSERT( false );
+                return;
+            }
+            callback( pixmap );
+        } );
+}
+
+
 QPixmap
 createRoundedImage( const QPixmap& pixmap, const QSize& size, float frameWidthPct )
 {
@@ -17,6 +17,8 @@
 #include <QPixmap>
 #include <QSize>
 
+#include <functional>
+
 class QLayout;
 
 namespace CalamaresUtils
@@ -78,6 +80,21 @@ UIDLLEXPORT QPixmap defaultPixmap( ImageType type,
                                    ImageMode mode = CalamaresUtils::Original,
                                    const QSize& size = QSize( 0, 0 ) );
 
+/**
+ * @brief defaultPixmapAsync is defaultPixmap(), rendered in the background
+ *
+ * The @p callback is called (in the GUI thread) with the pixmap once it is
+ * ready; use this for icons that need not be there when a page is created.
+ * If the image cannot be rendered (which, like for defaultPixmap(), is a bug)
+ * the @p callback is not called at all, so it never gets a null pixmap.
+ * @see ImageRegistry::pixmapAsync()
+ */
+UIDLLEXPORT void defaultPixmapAsync( ImageType type,
+                                     ImageMode mode,
+                                     const QSize& size,
+                                     QObject* context,
+                                     std::function< void( const QPixmap& ) > callback );
+
 // TODO:3.3:This has only one consumer, move to ImageRegistry, make static
 /**
  * @brief createRoundedImage returns a rounded version of a pixmap.
@@ -8,11 +8,160 @@
 
 #include "ImageRegistry.h"
 
+#include <QCache>
+#include <QFutureWatcher>
 #include <QIcon>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QtConcurrent/QtConcurrent>
 
-static QHash< QString, QHash< int, QHash< qint64, QPixmap > > > s_cache;
+namespace
+{
+/** @brief Identifies one rendering of an image
+ *
+ * An image file can be rendered in different sizes (and
+ * modes, and for different screens), so all of those
+ * go into the key.
+ */
+struct ImageKey
+{
+    QString path;
+    int mode;
+    QSize size;
+    qreal devicePixelRatio;
+};
+
+/** @brief The device-pixel-ratio as it is compared in keys
+ *
+ * Ratios are compared in hundredths, so that equal keys also
+ * have equal hashes.
+ */
+int
+ratioKey( qreal devicePixelRatio )
+{
+    return qRound( devicePixelRatio * 100 );
+}
+
+bool
+operator==( const ImageKey& lhs, const ImageKey& rhs )
+{
+    return lhs.mode == rhs.mode && lhs.size == rhs.size
+        && ratioKey( lhs.devicePixelRatio ) == ratioKey( rhs.devicePixelRatio ) && lhs.path == rhs.path;
+}
+
+uint
+qHash( const ImageKey& key, uint seed = 0 )
+{
+    const int size = ( key.size.width() << 16 ) + key.size.height();
+    return qHash( key.path, seed ) ^ qHash( key.mode, seed ) ^ qHash( size, seed )
+        ^ qHash( ratioKey( key.devicePixelRatio ), seed );
+}
+
+/// @brief Cache cost (in KiB) of a pixmap
+int
+costOf( const QPixmap& pixmap )
+{
+    return qMax( 1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024 );
+}
+
+/// Default memory budget for the image cache: 32MiB
+constexpr int defaultCacheLimit = 32 * 1024;
+}  // namespace
+
+static QMutex s_cacheMutex;
+static QCache< ImageKey, QPixmap > s_cache( defaultCacheLimit );
+
+
+/** @brief Loads and scales an image
+ *
+ * This does all the work that can be done outside of the GUI thread:
+ * SVG images are rasterized directly at the requested size, and
+ * other images are loaded and scaled.
+ */
+static QImage
+renderImage( const QString& image, const QSize& size, qreal devicePixelRatio )
+{
+    const QSize deviceSize = size * devicePixelRatio;
+
+    QImage img;
+    if ( image.toLower().endsWith( ".svg" ) || image.toLower().endsWith( ".svgz" ) )
+    {
+        QSvgRenderer svgRenderer( image );
+        const bool useDefault = size.isNull() || size.height() == 0 || size.width() == 0;
+        img = QImage( useDefault ? svgRenderer.defaultSize() * devicePixelRatio : deviceSize,
+                      QImage::Format_ARGB32_Premultiplied );
+        img.fill( Qt::transparent );
+
+        QPainter imgPainter( &img );
+        svgRenderer.render( &imgPainter );
+        imgPainter.end();
+    }
+    else
+    {
+        img = QImage( image );
+    }
+
+    if ( !img.isNull() && !size.isNull() && img.size() != deviceSize )
+    {
+        if ( size.width() == 0 )
+        {
+            img = img.scaledToHeight( deviceSize.height(), Qt::SmoothTransformation );
+        }
+        else if ( size.height() == 0 )
+        {
+            img = img.scaledToWidth( deviceSize.width(), Qt::SmoothTransformation );
+        }
+        else
+        {
+            img = img.scaled( deviceSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+        }
+    }
+
+    return img;
+}
+
+/** @brief Turns a rendered image into a pixmap and caches it
+ *
+ * This must be called from the GUI thread.
+ */
+static QPixmap
+finishPixmap( const ImageKey& key, QImage&& img )
+{
+    if ( img.isNull() )
+    {
+        return QPixmap();
+    }
+
+    QPixmap pixmap = QPixmap::fromImage( std::move( img ) );
+    if ( key.mode == CalamaresUtils::RoundedCorners )
+    {
+        pixmap = CalamaresUtils::createRoundedImage( pixmap, key.size * key.devicePixelRatio );
+    }
+    pixmap.setDevicePixelRatio( key.devicePixelRatio );
+
+    if ( !pixmap.isNull() )
+    {
+        QMutexLocker lock( &s_cacheMutex );
+        s_cache.insert( key, new QPixmap( pixmap ), costOf( pixmap ) );
+    }
+    return pixmap;
+}
+
+static bool
+findInCache( const ImageKey& key, QPixmap& pixmap )
+{
+    QMutexLocker lock( &s_cacheMutex );
+    const QPixmap* p = s_cache.object( key );
+    if ( p )
+    {
+        pixmap = *p;
+        return true;
+    }
+    return false;
+}
 
 
 ImageRegistry*
@@ -33,109 +182,72 @@ ImageRegistry::icon( const QString& image, CalamaresUtils::ImageMode mode )
 }
 
 
-qint64
-ImageRegistry::cacheKey( const QSize& size )
+QPixmap
+ImageRegistry::pixmap( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode )
 {
-    return size.width() * 100 + size.height() * 10;
+    return pixmap( image, size, mode, 1.0 );
 }
 
 
 QPixmap
-ImageRegistry::pixmap( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode )
+ImageRegistry::pixmap( const QString& image,
+                       const QSize& size,
+                       CalamaresUtils::ImageMode mode,
+                       qreal devicePixelRatio )
 {
     Q_ASSERT( !( size.width() < 0 || size.height() < 0 ) );
-    if ( size.width() < 0 || size.height() < 0 )
+    if ( size.width() < 0 || size.height() < 0 || devicePixelRatio <= 0 )
     {
         return QPixmap();
     }
 
-    QHash< qint64, QPixmap > subsubcache;
-    QHash< int, QHash< qint64, QPixmap > > subcache;
-
-    if ( s_cache.contains( image ) )
+    const ImageKey key { image, mode, size, devicePixelRatio };
+    QPixmap pixmap;
+    if ( findInCache( key, pixmap ) )
     {
-        subcache = s_cache.value( image );
-
-        if ( subcache.contains( mode ) )
-        {
-            subsubcache = subcache.value( mode );
-
-            const qint64 ck = cacheKey( size );
-            if ( subsubcache.contains( ck ) )
-            {
-                return subsubcache.value( ck );
-            }
-        }
+        return pixmap;
     }
 
     // Image not found in cache. Let's load it.
-    QPixmap pixmap;
-    if ( image.toLower().endsWith( ".svg" ) )
-    {
-        QSvgRenderer svgRenderer( image );
-        QPixmap p( size.isNull() || size.height() == 0 || size.width() == 0 ? svgRenderer.defaultSize() : size );
-        p.fill( Qt::transparent );
+    return finishPixmap( key, renderImage( image, size, devicePixelRatio ) );
+}
 
-        QPainter pixPainter( &p );
-        svgRenderer.render( &pixPainter );
-        pixPainter.end();
 
-        pixmap = p;
-    }
-    else
+void
+ImageRegistry::pixmapAsync( const QString& image,
+                            const QSize& size,
+                            CalamaresUtils::ImageMode mode,
+                            QObject* context,
+                            std::function< void( const QPixmap& ) > callback )
+{
+    if ( size.width() < 0 || size.height() < 0 )
     {
-        pixmap = QPixmap( image );
+        callback( QPixmap() );
+        return;
     }
 
-    if ( !pixmap.isNull() )
+    const ImageKey key { image, mode, size, 1.0 };
+    QPixmap pixmap;
+    if ( findInCache( key, pixmap ) )
     {
-        if ( mode == CalamaresUtils::RoundedCorners )
-        {
-            pixmap = CalamaresUtils::createRoundedImage( pixmap, size );
-        }
-
-        if ( !size.isNull() && pixmap.size() != size )
-        {
-            if ( size.width() == 0 )
-            {
-                pixmap = pixmap.scaledToHeight( size.height(), Qt::SmoothTransformation );
-            }
-            else if ( size.height() == 0 )
-            {
-                pixmap = pixmap.scaledToWidth( size.width(), Qt::SmoothTransformation );
-            }
-            else
-            {
-                pixmap = pixmap.scaled( size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
-            }
-        }
-
-        putInCache( image, size, mode, pixmap );
+        callback( pixmap );
+        return;
     }
 
-    return pixmap;
+    // Without a context, the watcher itself is the receiver of the signal
+    using Watcher = QFutureWatcher< QImage >;
+    auto* watcher = new Watcher( context );
+    QObject::connect( watcher, &Watcher::finished, context ? context : watcher, [watcher, key, callback]() {
+        callback( finishPixmap( key, watcher->result() ) );
+        watcher->deleteLater();
+    } );
+    watcher->setFuture( QtConcurrent::run( renderImage, image, size, 1.0 ) );
 }
 
 
 void
-ImageRegistry::putInCache( const QString& image,
-                           const QSize& size,
-                           CalamaresUtils::ImageMode mode,
-                           const QPixmap& pixmap )
+ImageRegistry::clear()
 {
-    QHash< qint64, QPixmap > subsubcache;
-    QHash< int, QHash< qint64, QPixmap > > subcache;
-
-    if ( s_cache.contains( image ) )
-    {
-        subcache = s_cache.value( image );
-        if ( subcache.contains( mode ) )
-        {
-            subsubcache = subcache.value( mode );
-        }
-    }
-
-    subsubcache.insert( cacheKey( size ), pixmap );
-    subcache.insert( mode, subsubcache );
-    s_cache.insert( image, subcache );
+    QMutexLocker lock( &s_cacheMutex );
+    s_cache.clear();
 }
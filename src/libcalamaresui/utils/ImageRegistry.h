@@ -14,6 +14,19 @@
 #include "DllMacro.h"
 #include "utils/CalamaresUtilsGui.h"
 
+#include <functional>
+
+class QObject;
+
+/** @brief Cache of (scaled) images loaded from files
+ *
+ * Images are cached per path, mode, size and device-pixel-ratio.
+ * The cache has a memory budget of 32MiB and drops
+ * least-recently-used images when it is exceeded. The cache
+ * may be used from multiple threads, but pixmaps are GUI-thread
+ * only: pixmap() and icon() must be called from the GUI thread.
+ * Use pixmapAsync() to rasterize (SVG) images in the background.
+ */
 class UIDLLEXPORT ImageRegistry
 {
 public:
@@ -24,10 +37,33 @@ public:
     QIcon icon( const QString& image, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
     QPixmap
     pixmap( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode = CalamaresUtils::Original );
+    /** @brief Load an image for display at the given device-pixel-ratio
+     *
+     * The returned pixmap has @p devicePixelRatio set, and is @p size
+     * in device-independent pixels.
+     */
+    QPixmap pixmap( const QString& image,
+                    const QSize& size,
+                    CalamaresUtils::ImageMode mode,
+                    qreal devicePixelRatio );
+
+    /** @brief Load an image in the background
+     *
+     * Loading and rasterizing the image happens in a worker thread.
+     * Once that is done, @p callback is called in the GUI thread with
+     * the resulting pixmap (which is also added to the cache).
+     * If @p context is destroyed before the image is ready, the callback
+     * is not called. @p context may be @c nullptr. If the image is already cached, @p callback
+     * is called immediately.
+     */
+    void pixmapAsync( const QString& image,
+                      const QSize& size,
+                      CalamaresUtils::ImageMode mode,
+                      QObject* context,
+                      std::function< void( const QPixmap& ) > callback );
 
-private:
-    qint64 cacheKey( const QSize& size );
-    void putInCache( const QString& image, const QSize& size, CalamaresUtils::ImageMode mode, const QPixmap& pixmap );
+    /// @brief Drops all cached images
+    void clear();
 };
 
 #endif  // IMAGE_REGISTRY_H
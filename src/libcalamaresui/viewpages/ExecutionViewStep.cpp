@@ -187,6 +187,13 @@ ExecutionViewStep::appendJobModuleInstanceKey( const ModuleSystem::InstanceKey&
 }
 
 
+void
+ExecutionViewStep::warmUp()
+{
+    m_slideshow->warmUp();
+}
+
+
 void
 ExecutionViewStep::updateFromJobQueue( qreal percent, const QString& message )
 {
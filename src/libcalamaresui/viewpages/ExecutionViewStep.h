@@ -51,6 +51,9 @@ public:
 
     void appendJobModuleInstanceKey( const ModuleSystem::InstanceKey& instanceKey );
 
+    /// @brief Prepare the slideshow, called when the previous step is shown
+    void warmUp();
+
 private:
     QWidget* m_widget;
     QProgressBar* m_progressBar;
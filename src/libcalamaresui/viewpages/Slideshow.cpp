@@ -28,6 +28,7 @@
 #include <QQuickWidget>
 #endif
 #include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 #include <chrono>
 
@@ -36,6 +37,11 @@ namespace Calamares
 
 Slideshow::~Slideshow() {}
 
+void
+Slideshow::warmUp()
+{
+}
+
 #ifdef WITH_QML
 SlideshowQML::SlideshowQML( QWidget* parent )
     : Slideshow( parent )
@@ -54,7 +60,7 @@ SlideshowQML::SlideshowQML( QWidget* parent )
     CALAMARES_RETRANSLATE( if ( m_qmlShow ) { m_qmlShow->engine()->retranslate(); } )
 #endif
 
-    if ( Branding::instance()->slideshowAPI() == 2 )
+    if ( Branding::instance()->slideshowAPI() == 2 && !Branding::instance()->slideshowWarmup() )
     {
         cDebug() << "QML load on startup, API 2.";
         loadQmlV2();
@@ -87,6 +93,46 @@ SlideshowQML::loadQmlV2()
     }
 }
 
+void
+SlideshowQML::warmUp()
+{
+    if ( !Branding::instance()->slideshowWarmup() )
+    {
+        return;
+    }
+
+    if ( Branding::instance()->slideshowAPI() == 2 )
+    {
+        cDebug() << "QML load on warmup, API 2.";
+        loadQmlV2();
+    }
+    else
+    {
+        // API 1 creates the show from the source URL when activated;
+        // compiling it now means the engine has the compiled type
+        // cached by then, but does not start the show yet. This
+        // component is only for the warm-up, and is not used for the show.
+        QMutexLocker l( &m_mutex );
+        if ( !m_qmlComponent && !Calamares::Branding::instance()->slideshowPath().isEmpty() )
+        {
+            cDebug() << "QML compile on warmup, API 1.";
+            m_qmlComponent = new QQmlComponent( m_qmlShow->engine(),
+                                                QUrl::fromLocalFile( Calamares::Branding::instance()->slideshowPath() ),
+                                                QQmlComponent::CompilationMode::Asynchronous );
+            auto* component = m_qmlComponent;
+            auto logErrors = [component]() {
+                if ( component->isError() )
+                {
+                    cWarning() << "QML component not ready:" << component->errors();
+                }
+            };
+            // Errors like a missing file are known right away
+            logErrors();
+            connect( m_qmlComponent, &QQmlComponent::statusChanged, this, logErrors );
+        }
+    }
+}
+
 void
 SlideshowQML::loadQmlV2Complete()
 {
@@ -156,12 +202,20 @@ SlideshowQML::startSlideShow()
 void
 SlideshowQML::changeSlideShowState( Action state )
 {
-    QMutexLocker l( &m_mutex );
     bool activate = state == Slideshow::Start;
+    if ( activate && Branding::instance()->slideshowAPI() == 2 )
+    {
+        // With warm-up, the QML is normally loaded by warmUp(); that does
+        // not happen if the execution step is reached some other way.
+        // This does nothing if the QML is already (being) loaded, and
+        // loadQmlV2Complete() starts the show once it is ready.
+        loadQmlV2();
+    }
 
+    QMutexLocker l( &m_mutex );
     if ( Branding::instance()->slideshowAPI() == 2 )
     {
-        // The QML was already loaded in the constructor, need to start it
+        // The QML was already loaded, need to start it
         CalamaresUtils::callQmlFunction( m_qmlObject, activate ? "onActivate" : "onLeave" );
     }
     else if ( !Calamares::Branding::instance()->slideshowPath().isEmpty() )
@@ -196,6 +250,26 @@ SlideshowQML::changeSlideShowState( Action state )
 }
 #endif
 
+/// @brief Number of slides that are loaded ahead of time
+static constexpr int prefetchCount = 2;
+
+/** @brief Loads an image file, scaled down to fit in @p size
+ *
+ * This is called in a worker thread. Images smaller than @p size
+ * are not scaled; an empty @p size means "do not scale".
+ */
+static QImage
+loadSlide( const QString& path, const QSize& size )
+{
+    QImage image( path );
+    if ( !image.isNull() && !size.isEmpty()
+         && ( image.width() > size.width() || image.height() > size.height() ) )
+    {
+        image = image.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+    }
+    return image;
+}
+
 SlideshowPictures::SlideshowPictures( QWidget* parent )
     : Slideshow( parent )
     , m_label( new QLabel( parent ) )
@@ -207,6 +281,13 @@ SlideshowPictures::SlideshowPictures( QWidget* parent )
     m_label->setAlignment( Qt::AlignCenter );
     m_timer->setInterval( std::chrono::milliseconds( 2000 ) );
     connect( m_timer, &QTimer::timeout, this, &SlideshowPictures::next );
+    connect( &m_watcher, &QFutureWatcher< QImage >::finished, this, [this]() {
+        const QImage image = m_watcher.result();
+        if ( !image.isNull() && isActive() )
+        {
+            m_label->setPixmap( QPixmap::fromImage( image ) );
+        }
+    } );
 }
 
 SlideshowPictures::~SlideshowPictures()
@@ -243,6 +324,8 @@ SlideshowPictures::changeSlideShowState( Calamares::Slideshow::Action a )
     else
     {
         m_timer->stop();
+        // Drop the prefetched images, they are no longer needed
+        m_prefetched.clear();
     }
 }
 
@@ -273,7 +356,43 @@ SlideshowPictures::next()
         return;
     }
 
-    m_label->setPixmap( QPixmap( m_images.at( m_imageIndex ) ) );
+    if ( m_label->size() != m_prefetchSize )
+    {
+        // The prefetched images are scaled wrong
+        m_prefetched.clear();
+        m_prefetchSize = m_label->size();
+    }
+
+    QFuture< QImage > current = m_prefetched.take( m_imageIndex );
+    if ( current.isCanceled() )
+    {
+        // Not prefetched (a default-constructed QFuture is canceled)
+        current = QtConcurrent::run( loadSlide, m_images.at( m_imageIndex ), m_prefetchSize );
+    }
+    // If the image is already loaded, this still shows it via the event loop
+    m_watcher.setFuture( current );
+    prefetch();
+}
+
+void
+SlideshowPictures::prefetch()
+{
+    const int count = m_images.count();
+    QMap< int, QFuture< QImage > > upcoming;
+    for ( int i = 1; i <= qMin( prefetchCount, count - 1 ); ++i )
+    {
+        const int index = ( m_imageIndex + i ) % count;
+        if ( m_prefetched.contains( index ) )
+        {
+            upcoming.insert( index, m_prefetched.value( index ) );
+        }
+        else
+        {
+            upcoming.insert( index, QtConcurrent::run( loadSlide, m_images.at( index ), m_prefetchSize ) );
+        }
+    }
+    // Anything not upcoming is dropped, which limits memory use to prefetchCount images
+    m_prefetched = upcoming;
 }
 
 
@@ -14,6 +14,9 @@
 
 #include "CalamaresConfig.h"
 
+#include <QFutureWatcher>
+#include <QImage>
+#include <QMap>
 #include <QMutex>
 #include <QStringList>
 #include <QWidget>
@@ -71,6 +74,14 @@ public:
      */
     virtual void changeSlideShowState( Action a ) = 0;
 
+    /** @brief Prepare the slideshow, before it is shown
+     *
+     * This is called while the step before the execution step is
+     * shown. Slideshows can load (or compile) whatever is slow
+     * to load, so that they can be shown without delay later.
+     */
+    virtual void warmUp();
+
 protected:
     QMutex m_mutex;
     Action m_state = Stop;
@@ -95,6 +106,7 @@ public:
 
     QWidget* widget() override;
     void changeSlideShowState( Action a ) override;
+    void warmUp() override;
 
 public slots:
     void loadQmlV2Complete();
@@ -117,6 +129,10 @@ private:
  * do not use QML at all. It is configured through the Branding
  * setting *slideshow*. When using this widget, the setting must
  * be a list of filenames; the API is set to -1.
+ *
+ * Images are loaded (and scaled down to fit the widget) in a
+ * background thread, a few slides ahead of the one being shown,
+ * so that changing slides does not load files in the GUI thread.
  */
 class SlideshowPictures : public Slideshow
 {
@@ -132,10 +148,20 @@ public slots:
     void next();
 
 private:
+    /// @brief Start loading the slides following the current one
+    void prefetch();
+
     QLabel* m_label;
     QTimer* m_timer;
     int m_imageIndex;
     QStringList m_images;
+
+    /// Images being loaded (or loaded), by index in m_images
+    QMap< int, QFuture< QImage > > m_prefetched;
+    /// Size the images in m_prefetched are scaled to
+    QSize m_prefetchSize;
+    /// Watches the image for the current slide
+    QFutureWatcher< QImage > m_watcher;
 };
 
 }  // namespace Calamares
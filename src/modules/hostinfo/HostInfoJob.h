@@ -32,8 +32,8 @@ QString hostOSName();
 
 /** @brief the run-time CPU architecture
  *
- * Returns "Intel" or "AMD" or blank, if Calamares can determine what
- * CPU is currently in use (based on /proc/cpuinfo or hw.model).
+ * Returns "Intel", "AMD" or "ARM", or blank, if Calamares can determine
+ * what CPU is currently in use (based on /proc/cpuinfo or hw.model).
  */
 QString hostCPU();
 
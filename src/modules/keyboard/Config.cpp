@@ -11,6 +11,7 @@
 #include "Config.h"
 
 #include "SetKeyboardLayoutJob.h"
+#include "Xkb.h"
 #include "keyboardwidget/keyboardpreview.h"
 
 #include "GlobalStorage.h"
@@ -24,6 +25,8 @@
 #include <QProcess>
 #include <QTimer>
 
+#include <algorithm>
+
 /* Returns stringlist with suitable setxkbmap command-line arguments
  * to set the given @p model.
  */
@@ -76,12 +79,72 @@ xkbmap_layout_args( const QStringList& layouts,
     return r;
 }
 
+/* Sets the keyboard @p model in X11; this talks to the X server
+ * directly if possible, and runs setxkbmap otherwise.
+ */
+static void
+xkbmap_set_model( const QString& model )
+{
+    if ( Xkb::updateNames( [&model]( Xkb::Names& names ) { names.model = model; } ) )
+    {
+        return;
+    }
+    QProcess::execute( "setxkbmap", xkbmap_model_args( model ) );
+}
+
+/* Sets the keyboard @p layouts and @p variants in X11, like
+ * xkbmap_set_model(). If @p switchOption is not empty, it replaces
+ * the group-switching option.
+ */
+static void
+xkbmap_set_layouts( const QStringList& layouts, const QStringList& variants, const QString& switchOption = QString() )
+{
+    auto change = [&layouts, &variants, &switchOption]( Xkb::Names& names ) {
+        names.layouts = layouts;
+        names.variants = variants;
+        if ( !switchOption.isEmpty() )
+        {
+            names.options.erase( std::remove_if( names.options.begin(),
+                                                 names.options.end(),
+                                                 []( const QString& o ) { return o.startsWith( "grp:" ); } ),
+                                 names.options.end() );
+            names.options.append( switchOption );
+        }
+    };
+    if ( Xkb::updateNames( change ) )
+    {
+        return;
+    }
+
+    if ( switchOption.isEmpty() && layouts.count() == 1 && variants.count() == 1 )
+    {
+        QProcess::execute( "setxkbmap", xkbmap_layout_args( layouts.first(), variants.first() ) );
+    }
+    else
+    {
+        QProcess::execute( "setxkbmap", xkbmap_layout_args( layouts, variants, switchOption ) );
+    }
+}
+
 /* Returns group-switch setxkbd option if set
  * or an empty string otherwise
  */
 static inline QString
 xkbmap_query_grp_option()
 {
+    Xkb::Names names;
+    if ( Xkb::currentNames( names ) )
+    {
+        for ( const auto& option : qAsConst( names.options ) )
+        {
+            if ( option.startsWith( "grp:" ) )
+            {
+                return option;
+            }
+        }
+        return QString();
+    }
+
     QProcess setxkbmapQuery;
     setxkbmapQuery.start( "setxkbmap", { "-query" } );
     setxkbmapQuery.waitForFinished();
@@ -158,7 +221,7 @@ Config::Config( QObject* parent )
     connect( m_keyboardModelsModel, &KeyboardModelsModel::currentIndexChanged, [&]( int index ) {
         // Set Xorg keyboard model
         m_selectedModel = m_keyboardModelsModel->key( index );
-        QProcess::execute( "setxkbmap", xkbmap_model_args( m_selectedModel ) );
+        xkbmap_set_model( m_selectedModel );
         emit prettyStatusChanged();
     } );
 
@@ -190,10 +253,9 @@ Config::Config( QObject* parent )
                     m_additionalLayoutInfo.groupSwitcher = "grp:alt_shift_toggle";
                 }
 
-                QProcess::execute( "setxkbmap",
-                                   xkbmap_layout_args( { m_additionalLayoutInfo.additionalLayout, m_selectedLayout },
-                                                       { m_additionalLayoutInfo.additionalVariant, m_selectedVariant },
-                                                       m_additionalLayoutInfo.groupSwitcher ) );
+                xkbmap_set_layouts( { m_additionalLayoutInfo.additionalLayout, m_selectedLayout },
+                                    { m_additionalLayoutInfo.additionalVariant, m_selectedVariant },
+                                    m_additionalLayoutInfo.groupSwitcher );
 
 
                 cDebug() << "xkbmap selection changed to: " << m_selectedLayout << '-' << m_selectedVariant << "(added "
@@ -202,7 +264,7 @@ Config::Config( QObject* parent )
             }
             else
             {
-                QProcess::execute( "setxkbmap", xkbmap_layout_args( m_selectedLayout, m_selectedVariant ) );
+                xkbmap_set_layouts( { m_selectedLayout }, { m_selectedVariant } );
                 cDebug() << "xkbmap selection changed to: " << m_selectedLayout << '-' << m_selectedVariant;
             }
             m_setxkbmapTimer.disconnect( this );
@@ -247,12 +309,12 @@ findLayout( const KeyboardLayoutModel* klm, const QString& currentLayout )
     return currentLayoutItem;
 }
 
-void
-Config::detectCurrentKeyboardLayout()
+/* Reads the current layout and variant from the output of setxkbmap,
+ * for when the XKB extension can't be queried directly.
+ */
+static void
+xkbmap_print_layout( QString& currentLayout, QString& currentVariant )
 {
-    //### Detect current keyboard layout and variant
-    QString currentLayout;
-    QString currentVariant;
     QProcess process;
     process.start( "setxkbmap", QStringList() << "-print" );
 
@@ -295,6 +357,25 @@ Config::detectCurrentKeyboardLayout()
             }
         }
     }
+}
+
+void
+Config::detectCurrentKeyboardLayout()
+{
+    //### Detect current keyboard layout and variant
+    QString currentLayout;
+    QString currentVariant;
+    Xkb::Names names;
+    if ( Xkb::currentNames( names ) )
+    {
+        // The layout we want is the first (primary) one
+        currentLayout = names.layouts.value( 0 );
+        currentVariant = names.variants.value( 0 );
+    }
+    else
+    {
+        xkbmap_print_layout( currentLayout, currentVariant );
+    }
 
     //### Layouts and Variants
     QPersistentModelIndex currentLayoutItem = findLayout( m_keyboardLayoutsModel, currentLayout );
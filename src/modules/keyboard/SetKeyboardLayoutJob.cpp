@@ -26,8 +26,10 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QSettings>
 #include <QTextStream>
+#include <QVector>
 
 
 SetKeyboardLayoutJob::SetKeyboardLayoutJob( const QString& model,
@@ -81,19 +83,42 @@ SetKeyboardLayoutJob::findConvertedKeymap( const QString& convertedKeymapPath )
 }
 
 
-STATICTEST QString
-findLegacyKeymap( const QString& layout, const QString& model, const QString& variant )
+namespace
 {
-    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in QRC";
+/** @brief One line from the kbd-model-map
+ *
+ * The X11 layout is not stored here, since the entries are
+ * indexed by layout in LegacyKeymaps.
+ */
+struct LegacyKeymap
+{
+    QString keymap;  ///< Name of the vconsole keymap
+    QString model;  ///< X11 model
+    QString variant;  ///< X11 variant, empty if none
+};
 
-    int bestMatching = 0;
-    QString name;
+/** @brief The kbd-model-map, indexed by X11 layout
+ *
+ * The map is read (once) from the QRC. Entries are kept in the
+ * order of the file, since earlier entries win ties.
+ */
+struct LegacyKeymaps
+{
+    /// Entries whose X11 layout(s) are exactly the key
+    QHash< QString, QVector< LegacyKeymap > > exact;
+    /// Entries with multiple X11 layouts, whose first layout is the key
+    QHash< QString, QVector< LegacyKeymap > > prefix;
+
+    LegacyKeymaps();
+};
 
+LegacyKeymaps::LegacyKeymaps()
+{
     QFile file( ":/kbd-model-map" );
     if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
     {
         cDebug() << Logger::SubEntry << "Could not read QRC";
-        return QString();
+        return;
     }
 
     QTextStream stream( &file );
@@ -111,61 +136,89 @@ findLegacyKeymap( const QString& layout, const QString& model, const QString& va
             continue;
         }
 
-        int matching = 0;
-
-        // Determine how well matching this entry is
-        // We assume here that we have one X11 layout. If the UI changes to
-        // allow more than one layout, this should change too.
-        if ( layout == mapping[ 1 ] )
-        // If we got an exact match, this is best
+        QString mappingVariant = mapping[ 3 ];
+        if ( mappingVariant == "-" )
         {
-            matching = 10;
+            mappingVariant = QString();
         }
-        // Look for an entry whose first layout matches ours
-        else if ( mapping[ 1 ].startsWith( layout + ',' ) )
+        else if ( mappingVariant.startsWith( ',' ) )
         {
-            matching = 5;
+            mappingVariant.remove( 1, 0 );
         }
 
-        if ( matching > 0 )
+        // We ignore mapping[4], the xkb options, for now. If we ever
+        // allow setting options in the UI, we should index them here.
+        const LegacyKeymap entry { mapping[ 0 ], mapping[ 2 ], mappingVariant };
+        const QString& layouts = mapping[ 1 ];
+        exact[ layouts ].append( entry );
+        const int comma = layouts.indexOf( ',' );
+        if ( comma > 0 )
         {
-            if ( model.isEmpty() || model == mapping[ 2 ] )
-            {
-                matching++;
-            }
-
-            QString mappingVariant = mapping[ 3 ];
-            if ( mappingVariant == "-" )
-            {
-                mappingVariant = QString();
-            }
-            else if ( mappingVariant.startsWith( ',' ) )
-            {
-                mappingVariant.remove( 1, 0 );
-            }
-
-            if ( variant == mappingVariant )
-            {
-                matching++;
-            }
-
-            // We ignore mapping[4], the xkb options, for now. If we ever
-            // allow setting options in the UI, we should match them here.
+            prefix[ layouts.left( comma ) ].append( entry );
         }
+    }
+}
 
-        // The best matching entry so far, then let's save that
-        if ( matching >= qMax( bestMatching, 1 ) )
+/** @brief Finds the best-matching entry for @p model and @p variant
+ *
+ * Each entry gets @p baseScore, plus one for a matching model and
+ * one for a matching variant. Returns the score of the best entry
+ * (the first one, if there are several) and sets @p name to its keymap.
+ */
+int
+bestMatch( const QVector< LegacyKeymap >& entries,
+           int baseScore,
+           const QString& model,
+           const QString& variant,
+           QString& name )
+{
+    int bestMatching = 0;
+    for ( const auto& entry : entries )
+    {
+        int matching = baseScore;
+        if ( model.isEmpty() || model == entry.model )
         {
-            cDebug() << Logger::SubEntry << "Found legacy keymap" << mapping[ 0 ] << "with score" << matching;
+            matching++;
+        }
+        if ( variant == entry.variant )
+        {
+            matching++;
+        }
 
-            if ( matching > bestMatching )
-            {
-                bestMatching = matching;
-                name = mapping[ 0 ];
-            }
+        if ( matching > bestMatching )
+        {
+            bestMatching = matching;
+            name = entry.keymap;
         }
     }
+    return bestMatching;
+}
+}  // namespace
+
+STATICTEST QString
+findLegacyKeymap( const QString& layout, const QString& model, const QString& variant )
+{
+    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in QRC";
+
+    static const LegacyKeymaps keymaps;
 
+    // We assume here that we have one X11 layout. If the UI changes to
+    // allow more than one layout, this should change too.
+    //
+    // An exact match of the layout always scores better than
+    // an entry whose first layout matches ours, so the
+    // prefix entries only matter if there are no exact ones.
+    QString name;
+    int score = bestMatch( keymaps.exact.value( layout ), 10, model, variant, name );
+    if ( score < 1 )
+    {
+        score = bestMatch( keymaps.prefix.value( layout ), 5, model, variant, name );
+    }
+
+    if ( score > 0 )
+    {
+        cDebug() << Logger::SubEntry << "Found legacy keymap" << name << "with score" << score;
+    }
     return name;
 }
 
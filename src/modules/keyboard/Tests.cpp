@@ -45,6 +45,10 @@ KeyboardLayoutTests::testSimpleLayoutLookup_data()
     QTest::newRow( "turkish default" ) << QString( "tr" ) << QString() << QString() << QString( "trq" );
     QTest::newRow( "turkish alt-q" ) << QString( "tr" ) << QString() << QString( "alt" ) << QString( "trq" );
     QTest::newRow( "turkish f" ) << QString( "tr" ) << QString() << QString( "f" ) << QString( "trf" );
+    // These are only in the map as first-of-multiple layouts
+    QTest::newRow( "russian" ) << QString( "ru" ) << QString() << QString() << QString( "ru" );
+    QTest::newRow( "bulgarian" ) << QString( "bg" ) << QString() << QString() << QString( "bg_bds-utf8" );
+    QTest::newRow( "unknown" ) << QString( "xx" ) << QString() << QString() << QString();
 }
 
 
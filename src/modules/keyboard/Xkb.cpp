@@ -0,0 +1,205 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Xkb.h"
+
+#include "utils/Logger.h"
+#include "utils/String.h"
+
+#include <QByteArray>
+
+// X11 headers come last, since they define macros that clash with Qt
+#ifdef HAVE_XKBFILE
+#include <X11/XKBlib.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XKBrules.h>
+
+#include <cstdlib>
+#endif
+
+namespace Xkb
+{
+
+#ifdef HAVE_XKBFILE
+/// Rules files named in the XKB settings are relative to this directory
+static const char xkbRulesDirectory[] = "/usr/share/X11/xkb/rules/";
+/// Rules used if the X server has none set (this is what setxkbmap does)
+static const char xkbDefaultRules[] = "evdev";
+
+namespace
+{
+/// @brief RAII connection to the X server, with the XKB extension checked
+class XkbDisplay
+{
+public:
+    XkbDisplay()
+    {
+        int eventCode = 0;
+        int errorCode = 0;
+        int reason = 0;
+        int major = XkbMajorVersion;
+        int minor = XkbMinorVersion;
+        m_display = XkbOpenDisplay( nullptr, &eventCode, &errorCode, &major, &minor, &reason );
+    }
+    ~XkbDisplay()
+    {
+        if ( m_display )
+        {
+            XCloseDisplay( m_display );
+        }
+    }
+
+    Display* display() const { return m_display; }
+    explicit operator bool() const { return m_display != nullptr; }
+
+private:
+    Display* m_display = nullptr;
+};
+
+/// @brief Takes ownership of @p s (allocated by libxkbfile) and returns it as a QString
+QString
+takeString( char* s )
+{
+    QString r = QString::fromLatin1( s );
+    free( s );
+    return r;
+}
+
+/// @brief Returns a (non-const) pointer to @p data, or nullptr if it is empty
+char*
+dataOrNull( QByteArray& data )
+{
+    return data.isEmpty() ? nullptr : data.data();
+}
+
+void
+freeComponents( XkbComponentNamesRec& components )
+{
+    free( components.keymap );
+    free( components.keycodes );
+    free( components.types );
+    free( components.compat );
+    free( components.symbols );
+    free( components.geometry );
+}
+
+bool
+readNames( Display* display, Names& names )
+{
+    char* rulesFile = nullptr;
+    XkbRF_VarDefsRec vd {};
+    if ( !XkbRF_GetNamesProp( display, &rulesFile, &vd ) )
+    {
+        return false;
+    }
+
+    names.rules = takeString( rulesFile );
+    names.model = takeString( vd.model );
+    // Layouts and variants are parallel lists, so keep empty parts
+    names.layouts = takeString( vd.layout ).split( ',' );
+    names.variants = takeString( vd.variant ).split( ',' );
+    while ( names.variants.count() < names.layouts.count() )
+    {
+        names.variants.append( QString() );
+    }
+    names.options = takeString( vd.options ).split( ',', SplitSkipEmptyParts );
+    return true;
+}
+
+bool
+writeNames( Display* display, const Names& names )
+{
+    QByteArray rules = names.rules.isEmpty() ? QByteArray( xkbDefaultRules ) : names.rules.toLatin1();
+    QByteArray model = names.model.toLatin1();
+    QByteArray layout = names.layouts.join( ',' ).toLatin1();
+    QByteArray variant = names.variants.join( ',' ).toLatin1();
+    QByteArray options = names.options.join( ',' ).toLatin1();
+
+    XkbRF_VarDefsRec vd {};
+    vd.model = dataOrNull( model );
+    vd.layout = dataOrNull( layout );
+    // A list of only-empty variants is the same as no variant
+    vd.variant = variant.count( ',' ) == variant.length() ? nullptr : variant.data();
+    vd.options = dataOrNull( options );
+
+    QByteArray rulesPath = rules.startsWith( '/' ) ? rules : ( QByteArray( xkbRulesDirectory ) + rules );
+    char locale[] = "C";
+    XkbRF_RulesPtr rulesData = XkbRF_Load( rulesPath.data(), locale, True, True );
+    if ( !rulesData )
+    {
+        cWarning() << "Could not load XKB rules" << rulesPath;
+        return false;
+    }
+
+    XkbComponentNamesRec components {};
+    bool ok = XkbRF_GetComponents( rulesData, &vd, &components );
+    XkbRF_Free( rulesData, True );
+    if ( ok )
+    {
+        XkbDescPtr xkb = XkbGetKeyboardByName( display,
+                                               XkbUseCoreKbd,
+                                               &components,
+                                               XkbGBN_AllComponentsMask,
+                                               XkbGBN_AllComponentsMask & ~XkbGBN_GeometryMask,
+                                               True );
+        ok = xkb != nullptr;
+        if ( xkb )
+        {
+            XkbFreeKeyboard( xkb, XkbAllComponentsMask, True );
+            // Store the names, like setxkbmap does, for later queries
+            XkbRF_SetNamesProp( display, rules.data(), &vd );
+        }
+    }
+    freeComponents( components );
+
+    if ( !ok )
+    {
+        cWarning() << "Could not load XKB keymap for" << layout << variant;
+    }
+    return ok;
+}
+}  // namespace
+
+bool
+currentNames( Names& names )
+{
+    XkbDisplay d;
+    return d && readNames( d.display(), names );
+}
+
+bool
+updateNames( const std::function< void( Names& ) >& change )
+{
+    XkbDisplay d;
+    Names names;
+    if ( !d || !readNames( d.display(), names ) )
+    {
+        return false;
+    }
+    change( names );
+    return writeNames( d.display(), names );
+}
+
+#else
+
+bool
+currentNames( Names& )
+{
+    return false;
+}
+
+bool
+updateNames( const std::function< void( Names& ) >& )
+{
+    return false;
+}
+
+#endif
+
+}  // namespace Xkb
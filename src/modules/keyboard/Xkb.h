@@ -0,0 +1,63 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef KEYBOARD_XKB_H
+#define KEYBOARD_XKB_H
+
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+/** @brief Talk to the X server's XKB extension directly
+ *
+ * This does what `setxkbmap` does, but without spawning a process
+ * each time the keyboard settings change. These functions are only
+ * available if Calamares is built with libxkbfile, and when there is
+ * an X server to talk to; if they return false, the caller should
+ * fall back to running `setxkbmap`.
+ */
+namespace Xkb
+{
+/** @brief XKB settings as stored on the X server
+ *
+ * These are the RMLVO (rules, model, layout, variant, options)
+ * names that `setxkbmap -query` would print; the layouts and
+ * variants lists are parallel.
+ */
+struct Names
+{
+    QString rules;
+    QString model;
+    QStringList layouts;
+    QStringList variants;
+    QStringList options;
+};
+
+/** @brief Reads the current XKB settings from the X server
+ *
+ * Returns @c false if there is no X server (or the XKB extension
+ * is missing), in which case @p names is unchanged.
+ */
+bool currentNames( Names& names );
+
+/** @brief Changes the XKB settings on the X server
+ *
+ * Reads the current settings, lets @p change modify them, then
+ * compiles a keymap for the result, loads it into the X server
+ * and stores the names on the root window (so that a subsequent
+ * currentNames() returns them). This uses a single connection to
+ * the X server. Returns @c false on failure; @p change is not
+ * called if the current settings could not be read.
+ */
+bool updateNames( const std::function< void( Names& ) >& change );
+
+}  // namespace Xkb
+
+#endif
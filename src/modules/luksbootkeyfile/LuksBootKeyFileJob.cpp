@@ -15,6 +15,15 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
+#include <QFile>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+
+#ifdef HAVE_LIBCRYPTSETUP
+#include <libcryptsetup.h>
+#endif
+
 LuksBootKeyFileJob::LuksBootKeyFileJob( QObject* parent )
     : Calamares::CppJob( parent )
 {
@@ -53,6 +62,7 @@ struct LuksDevice
     bool isRoot;
     QString device;
     QString passphrase;
+    int luksVersion = 0;  ///< 1 or 2, or 0 if unknown; filled in by exec()
 };
 
 /** @brief Extract the luks passphrases setup.
@@ -97,29 +107,223 @@ struct LuksDeviceList
 };
 
 static const char keyfile[] = "/crypto_keyfile.bin";
+/// Size of the key file, in bytes (this is what dd bs=512 count=4 used to write)
+static constexpr int keyfileSize = 2048;
 
-static bool
+/** @brief Creates the key file in the target system
+ *
+ * The file is filled from /dev/urandom; its contents are returned
+ * (and are empty on failure).
+ */
+static QByteArray
 generateTargetKeyfile()
 {
+    QFile urandom( QStringLiteral( "/dev/urandom" ) );
+    QByteArray key;
+    if ( urandom.open( QIODevice::ReadOnly ) )
+    {
+        key = urandom.read( keyfileSize );
+    }
+    if ( key.size() != keyfileSize )
+    {
+        cWarning() << "Could not read random data for LUKS keyfile.";
+        return QByteArray();
+    }
+
     CalamaresUtils::UMask m( CalamaresUtils::UMask::Safe );
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "dd", "bs=512", "count=4", "if=/dev/urandom", QString( "of=%1" ).arg( keyfile ) } );
-    if ( r.getExitCode() != 0 )
+    auto r = CalamaresUtils::System::instance()->createTargetFile(
+        keyfile, key, CalamaresUtils::System::WriteMode::Overwrite );
+    if ( !r )
+    {
+        cWarning() << "Could not create LUKS keyfile" << keyfile << "in target system.";
+        return QByteArray();
+    }
+    cDebug() << "Created LUKS keyfile" << r.path();
+    return key;
+}
+
+#ifdef HAVE_LIBCRYPTSETUP
+/// @brief A libcryptsetup device context, freed when it goes out of scope
+class CryptDevice
+{
+public:
+    explicit CryptDevice( const QString& path )
+    {
+        if ( crypt_init( &m_cd, path.toLocal8Bit().constData() ) < 0 )
+        {
+            m_cd = nullptr;
+        }
+    }
+    ~CryptDevice()
+    {
+        if ( m_cd )
+        {
+            crypt_free( m_cd );
+        }
+    }
+
+    struct crypt_device* cd() const { return m_cd; }
+    explicit operator bool() const { return m_cd != nullptr; }
+
+private:
+    struct crypt_device* m_cd = nullptr;
+};
+
+/// @brief The LUKS version (1 or 2) of @p device, or 0 if it is unknown
+static int
+getLuksVersion( const QString& device )
+{
+    CryptDevice cd( device );
+    if ( !cd || crypt_load( cd.cd(), CRYPT_LUKS, nullptr ) < 0 )
+    {
+        return 0;
+    }
+    const char* luksType = crypt_get_type( cd.cd() );
+    return qstrcmp( luksType, CRYPT_LUKS1 ) == 0 ? 1 : ( qstrcmp( luksType, CRYPT_LUKS2 ) == 0 ? 2 : 0 );
+}
+
+/** @brief Applies @p settings to the keyslots added to @p cd from now on
+ *
+ * Starts from the cryptsetup defaults for the device's LUKS version.
+ * LUKS1 only supports pbkdf2, so the algorithm is not changed there.
+ */
+static bool
+setPbkdf( struct crypt_device* cd, const PbkdfSettings& settings )
+{
+    if ( settings.pbkdf.isEmpty() && !settings.iterTime && !settings.pbkdfMemory && !settings.pbkdfForceIterations )
+    {
+        return true;
+    }
+
+    const char* luksType = crypt_get_type( cd );
+    const struct crypt_pbkdf_type* defaults = crypt_get_pbkdf_default( luksType );
+    if ( !defaults )
     {
-        cWarning() << "Could not create LUKS keyfile:" << r.getOutput() << "(exit code" << r.getExitCode() << ')';
         return false;
     }
-    // Give ample time to check that the file was created correctly
-    r = CalamaresUtils::System::instance()->targetEnvCommand( { "ls", "-la", "/" } );
-    cDebug() << "In target system after creating LUKS file" << r.getOutput();
+
+    struct crypt_pbkdf_type pbkdf = *defaults;
+    const QByteArray type = settings.pbkdf.toLatin1();
+    const bool isLuks1 = qstrcmp( luksType, CRYPT_LUKS1 ) == 0;
+    if ( !isLuks1 && !type.isEmpty() )
+    {
+        pbkdf.type = type.constData();
+    }
+    if ( settings.iterTime > 0 )
+    {
+        pbkdf.time_ms = static_cast< uint32_t >( settings.iterTime );
+    }
+    if ( settings.pbkdfMemory > 0 && qstrcmp( pbkdf.type, CRYPT_KDF_PBKDF2 ) != 0 )
+    {
+        pbkdf.max_memory_kb = static_cast< uint32_t >( settings.pbkdfMemory );
+    }
+    if ( settings.pbkdfForceIterations > 0 )
+    {
+        pbkdf.iterations = static_cast< uint32_t >( settings.pbkdfForceIterations );
+        pbkdf.flags |= CRYPT_PBKDF_NO_BENCHMARK;
+    }
+    return crypt_set_pbkdf_type( cd, &pbkdf ) == 0;
+}
+
+/** @brief Adds @p key as a passphrase to the LUKS device @p d
+ *
+ * The volume key is unlocked once, with the device's passphrase, and the
+ * new keyslot is added with that volume key. Only the key derivation for
+ * the new keyslot remains, and @p settings may make that cheaper.
+ */
+static bool
+setupLuks( const LuksDevice& d, const QByteArray& key, const PbkdfSettings& settings )
+{
+    CryptDevice device( d.device );
+    if ( !device || crypt_load( device.cd(), CRYPT_LUKS, nullptr ) < 0 )
+    {
+        cWarning() << "Could not open LUKS device" << d.device;
+        return false;
+    }
+
+    const QByteArray passphrase = d.passphrase.toUtf8();
+    QByteArray volumeKey( crypt_get_volume_key_size( device.cd() ), '\0' );
+    size_t volumeKeySize = static_cast< size_t >( volumeKey.size() );
+    int r = crypt_volume_key_get( device.cd(),
+                                  CRYPT_ANY_SLOT,
+                                  volumeKey.data(),
+                                  &volumeKeySize,
+                                  passphrase.constData(),
+                                  static_cast< size_t >( passphrase.size() ) );
+    if ( r < 0 )
+    {
+        cWarning() << "Could not unlock LUKS device" << d.device << "(error" << r << ')';
+        return false;
+    }
+
+    if ( !setPbkdf( device.cd(), settings ) )
+    {
+        cWarning() << "Could not set PBKDF parameters for" << d.device << "using defaults.";
+    }
+    r = crypt_keyslot_add_by_volume_key( device.cd(),
+                                         CRYPT_ANY_SLOT,
+                                         volumeKey.constData(),
+                                         volumeKeySize,
+                                         key.constData(),
+                                         static_cast< size_t >( key.size() ) );
+    volumeKey.fill( '\0' );
+    if ( r < 0 )
+    {
+        cWarning() << "Could not configure LUKS keyfile on" << d.device << "(error" << r << ')';
+        return false;
+    }
     return true;
 }
+#else
+/// @brief The LUKS version (1 or 2) of @p device, or 0 if it is unknown
+static int
+getLuksVersion( const QString& device )
+{
+    auto r = CalamaresUtils::System::instance()->targetEnvCommand( { "cryptsetup", "luksDump", device } );
+    if ( r.getExitCode() != 0 )
+    {
+        return 0;
+    }
+    for ( const auto& line : r.getOutput().split( '\n' ) )
+    {
+        if ( line.startsWith( QStringLiteral( "Version:" ) ) )
+        {
+            return line.mid( 8 ).trimmed().toInt();
+        }
+    }
+    return 0;
+}
 
+/** @brief Adds the key file as a passphrase to the LUKS device @p d
+ *
+ * LUKS1 only supports pbkdf2, and cryptsetup refuses the argon2 options
+ * there, so those are only passed for LUKS2 devices.
+ */
 static bool
-setupLuks( const LuksDevice& d )
+setupLuks( const LuksDevice& d, const QByteArray&, const PbkdfSettings& settings )
 {
+    const bool isLuks2 = d.luksVersion == 2;
+    QStringList command { "cryptsetup", "luksAddKey" };
+    if ( isLuks2 && !settings.pbkdf.isEmpty() )
+    {
+        command << "--pbkdf" << settings.pbkdf;
+    }
+    if ( settings.iterTime > 0 )
+    {
+        command << "--iter-time" << QString::number( settings.iterTime );
+    }
+    if ( isLuks2 && settings.pbkdfMemory > 0 && settings.pbkdf != QStringLiteral( "pbkdf2" ) )
+    {
+        command << "--pbkdf-memory" << QString::number( settings.pbkdfMemory );
+    }
+    if ( settings.pbkdfForceIterations > 0 )
+    {
+        command << "--pbkdf-force-iterations" << QString::number( settings.pbkdfForceIterations );
+    }
+    command << d.device << keyfile;
+
     auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "cryptsetup", "luksAddKey", d.device, keyfile }, QString(), d.passphrase, std::chrono::seconds( 15 ) );
+        command, QString(), d.passphrase, std::chrono::seconds( 15 ) );
     if ( r.getExitCode() != 0 )
     {
         cWarning() << "Could not configure LUKS keyfile on" << d.device << ':' << r.getOutput() << "(exit code"
@@ -128,6 +332,7 @@ setupLuks( const LuksDevice& d )
     }
     return true;
 }
+#endif
 
 Calamares::JobResult
 LuksBootKeyFileJob::exec()
@@ -161,10 +366,11 @@ LuksBootKeyFileJob::exec()
     }
 
     auto it = std::partition( s.devices.begin(), s.devices.end(), []( const LuksDevice& d ) { return d.isRoot; } );
-    for ( const auto& d : s.devices )
+    for ( auto& d : s.devices )
     {
-        cDebug() << Logger::SubEntry << ( d.isRoot ? "root" : "dev." ) << d.device << "passphrase?"
-                 << !d.passphrase.isEmpty();
+        d.luksVersion = getLuksVersion( d.device );
+        cDebug() << Logger::SubEntry << ( d.isRoot ? "root" : "dev." ) << d.device << "LUKS" << d.luksVersion
+                 << "passphrase?" << !d.passphrase.isEmpty();
     }
 
     if ( it == s.devices.begin() )
@@ -182,22 +388,52 @@ LuksBootKeyFileJob::exec()
             tr( "Root partition %1 is LUKS but no passphrase has been set." ).arg( s.devices.first().device ) );
     }
 
-    if ( !generateTargetKeyfile() )
+    const QByteArray key = generateTargetKeyfile();
+    if ( key.isEmpty() )
     {
         return Calamares::JobResult::error(
             tr( "Encrypted rootfs setup error" ),
             tr( "Could not create LUKS key file for root partition %1." ).arg( s.devices.first().device ) );
     }
 
+    // Each device spends most of its time in key derivation, so do them all at once.
+    // The argon2 default for LUKS2 may use up to 1GiB per device, though, so without
+    // a memory limit do one device at a time (unknown versions may be LUKS2 too).
+    QThreadPool pool;
+    const bool unlimitedMemory = m_pbkdf.pbkdfMemory <= 0 && m_pbkdf.pbkdf != QStringLiteral( "pbkdf2" );
+    const bool anyLuks2 = std::any_of(
+        s.devices.cbegin(), s.devices.cend(), []( const LuksDevice& d ) { return d.luksVersion != 1; } );
+    if ( unlimitedMemory && anyLuks2 )
+    {
+        cDebug() << Logger::SubEntry << "No pbkdfMemory set for LUKS2, configuring one device at a time.";
+        pool.setMaxThreadCount( 1 );
+    }
+    QList< QFuture< bool > > results;
     for ( const auto& d : s.devices )
     {
-        if ( !setupLuks( d ) )
+        results.append( QtConcurrent::run( &pool, setupLuks, d, key, m_pbkdf ) );
+    }
+    for ( int i = 0; i < results.count(); ++i )
+    {
+        if ( !results.at( i ).result() )
+        {
             return Calamares::JobResult::error(
                 tr( "Encrypted rootfs setup error" ),
-                tr( "Could not configure LUKS key file on partition %1." ).arg( d.device ) );
+                tr( "Could not configure LUKS key file on partition %1." ).arg( s.devices.at( i ).device ) );
+        }
     }
 
     return Calamares::JobResult::ok();
 }
 
+void
+LuksBootKeyFileJob::setConfigurationMap( const QVariantMap& configurationMap )
+{
+    m_pbkdf.pbkdf = CalamaresUtils::getString( configurationMap, "pbkdf" );
+    m_pbkdf.iterTime = static_cast< int >( CalamaresUtils::getInteger( configurationMap, "iterTime", 0 ) );
+    m_pbkdf.pbkdfMemory = static_cast< int >( CalamaresUtils::getInteger( configurationMap, "pbkdfMemory", 0 ) );
+    m_pbkdf.pbkdfForceIterations
+        = static_cast< int >( CalamaresUtils::getInteger( configurationMap, "pbkdfForceIterations", 0 ) );
+}
+
 CALAMARES_PLUGIN_FACTORY_DEFINITION( LuksBootKeyFileJobFactory, registerPlugin< LuksBootKeyFileJob >(); )
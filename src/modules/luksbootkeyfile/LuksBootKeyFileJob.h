@@ -15,10 +15,24 @@
 #include <QObject>
 #include <QVariantMap>
 
+/** @brief Key-derivation settings for the keyslot that holds the key file
+ *
+ * These correspond to the cryptsetup command-line options of the same
+ * name; zero (or empty) values leave the cryptsetup default in place.
+ */
+struct PbkdfSettings
+{
+    QString pbkdf;  ///< PBKDF algorithm (LUKS2 only)
+    int iterTime = 0;  ///< milliseconds to spend deriving the key
+    int pbkdfMemory = 0;  ///< KiB of memory to use (argon2 only)
+    int pbkdfForceIterations = 0;  ///< fixed iteration count, skips the benchmark
+};
+
 /** @brief Creates the LUKS boot key file and adds it to the cryptsetup.
  *
- * This job has no configuration, because it takes everything
- * from the global storage settings set by others.
+ * This job takes the devices from the global storage settings set by
+ * others; the configuration only tunes the key derivation for the
+ * newly-added keyslots.
  */
 class PLUGINDLLEXPORT LuksBootKeyFileJob : public Calamares::CppJob
 {
@@ -30,6 +44,11 @@ public:
     QString prettyName() const override;
 
     Calamares::JobResult exec() override;
+
+    void setConfigurationMap( const QVariantMap& configurationMap ) override;
+
+private:
+    PbkdfSettings m_pbkdf;
 };
 
 CALAMARES_PLUGIN_FACTORY_DECLARATION( LuksBootKeyFileJobFactory )
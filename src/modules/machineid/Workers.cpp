@@ -13,6 +13,7 @@
 #include "Workers.h"
 
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/CopyFile.h"
 #include "utils/Entropy.h"
 #include "utils/Logger.h"
 
@@ -71,7 +72,9 @@ copyFile( const QString& rootMountPoint, const QString& fileName )
     {
         return Calamares::JobResult::error( QObject::tr( "File not found" ), fileName );
     }
-    if ( !f.copy( rootMountPoint + fileName ) )
+    // Like QFile::copy(), an existing file is left alone
+    const QString target = rootMountPoint + fileName;
+    if ( QFile::exists( target ) || !CalamaresUtils::copyFile( fileName, target ) )
     {
         return Calamares::JobResult::error( QObject::tr( "File not found" ), rootMountPoint + fileName );
     }
@@ -18,11 +18,13 @@
 #include "utils/Yaml.h"
 
 #include <QNetworkReply>
+#include <QtConcurrent/QtConcurrent>
 
 Config::Config( QObject* parent )
     : QObject( parent )
     , m_model( new PackageModel( this ) )
 {
+    connect( &m_parser, &QFutureWatcher< ParsedGroups >::finished, this, &Config::parsedGroupData );
 }
 
 Config::~Config() {}
@@ -74,7 +76,8 @@ Config::loadGroupList( const QUrl& url )
     cDebug() << "NetInstall loading groups from" << url;
     QNetworkReply* reply = Manager::instance().asynchronousGet(
         url,
-        RequestOptions( RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect, std::chrono::seconds( 30 ) ) );
+        RequestOptions( RequestOptions::FakeUserAgent | RequestOptions::FollowRedirect | RequestOptions::UseDiskCache,
+                        std::chrono::seconds( 30 ) ) );
 
     if ( !reply )
     {
@@ -88,6 +91,42 @@ Config::loadGroupList( const QUrl& url )
     }
 }
 
+/** @brief Parses YAML @p yamlData into a list of groups
+ *
+ * The groups data may be a list of groups, or a map with
+ * a *groups* key. This does not touch the model, so it is
+ * safe to call from another thread.
+ */
+static Config::ParsedGroups
+parseGroupData( const QByteArray& yamlData )
+{
+    Config::ParsedGroups parsed;
+    try
+    {
+        YAML::Node groups = YAML::Load( yamlData.constData() );
+
+        if ( groups.IsSequence() )
+        {
+            parsed.groups = CalamaresUtils::yamlSequenceToVariant( groups );
+        }
+        else if ( groups.IsMap() )
+        {
+            auto map = CalamaresUtils::yamlMapToVariant( groups );
+            parsed.groups = map.value( "groups" ).toList();
+        }
+        else
+        {
+            cWarning() << "NetInstall groups data does not form a sequence.";
+        }
+        parsed.ok = true;
+    }
+    catch ( YAML::Exception& e )
+    {
+        CalamaresUtils::explainYamlException( e, yamlData, "netinstall groups data" );
+    }
+    return parsed;
+}
+
 void
 Config::receivedGroupData()
 {
@@ -114,32 +153,28 @@ Config::receivedGroupData()
         return;
     }
 
-    QByteArray yamlData = m_reply->readAll();
-    try
+    if ( m_reply->attribute( QNetworkRequest::SourceIsFromCacheAttribute ).toBool() )
     {
-        YAML::Node groups = YAML::Load( yamlData.constData() );
-
-        if ( groups.IsSequence() )
-        {
-            loadGroupList( CalamaresUtils::yamlSequenceToVariant( groups ) );
-        }
-        else if ( groups.IsMap() )
-        {
-            auto map = CalamaresUtils::yamlMapToVariant( groups );
-            loadGroupList( map.value( "groups" ).toList() );
-        }
-        else
-        {
-            cWarning() << "NetInstall groups data does not form a sequence.";
-        }
-        if ( m_model->rowCount() < 1 )
-        {
-            cWarning() << "NetInstall groups data was empty.";
-        }
+        cDebug() << Logger::SubEntry << "Group data is unchanged, using cached copy.";
     }
-    catch ( YAML::Exception& e )
+
+    // Parsing large groups data takes a while, so don't do it in the GUI thread
+    m_parser.setFuture( QtConcurrent::run( parseGroupData, m_reply->readAll() ) );
+}
+
+void
+Config::parsedGroupData()
+{
+    const ParsedGroups parsed = m_parser.result();
+    if ( !parsed.ok )
     {
-        CalamaresUtils::explainYamlException( e, yamlData, "netinstall groups data" );
         setStatus( Status::FailedBadData );
+        return;
+    }
+
+    loadGroupList( parsed.groups );
+    if ( m_model->rowCount() < 1 )
+    {
+        cWarning() << "NetInstall groups data was empty.";
     }
 }
@@ -14,8 +14,10 @@
 
 #include "PackageModel.h"
 
+#include <QFutureWatcher>
 #include <QObject>
 #include <QUrl>
+#include <QVariantList>
 
 class QNetworkReply;
 
@@ -47,8 +49,10 @@ public:
 
     /** @brief Retrieves the groups, with name, description and packages
      *
-     * Loads data from the given URL. Once done, the data is parsed
-     * and passed on to the other loadGroupList() method.
+     * Loads data from the given URL. The data is kept in a disk cache,
+     * so that unchanged data is not downloaded again. Once done, the data
+     * is parsed (in a separate thread) and passed on to the other
+     * loadGroupList() method.
      */
     void loadGroupList( const QUrl& url );
 
@@ -61,16 +65,25 @@ public:
 
     PackageModel* model() const { return m_model; }
 
+    /// @brief Result of parsing the groups data (in a thread)
+    struct ParsedGroups
+    {
+        QVariantList groups;
+        bool ok = false;  ///< Parsed without errors
+    };
+
 signals:
     void statusChanged( QString status );  ///< Something changed
     void statusReady();  ///< Loading groups is complete
 
 private slots:
     void receivedGroupData();  ///< From async-loading group data
+    void parsedGroupData();  ///< From parsing group data in a thread
 
 private:
     PackageModel* m_model = nullptr;
     QNetworkReply* m_reply = nullptr;  // For fetching data
+    QFutureWatcher< ParsedGroups > m_parser;  // For parsing data
     Status m_status = Status::Ok;
     bool m_required = false;
 };
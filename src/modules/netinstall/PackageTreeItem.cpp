@@ -94,7 +94,9 @@ PackageTreeItem::~PackageTreeItem()
 void
 PackageTreeItem::appendChild( PackageTreeItem* child )
 {
+    child->m_row = m_childItems.count();
     m_childItems.append( child );
+    countChild( child->isSelected(), 1 );
 }
 
 PackageTreeItem*
@@ -114,7 +116,7 @@ PackageTreeItem::row() const
 {
     if ( m_parentItem )
     {
-        return m_parentItem->m_childItems.indexOf( const_cast< PackageTreeItem* >( this ) );
+        return m_row;
     }
     return 0;
 }
@@ -177,62 +179,104 @@ PackageTreeItem::hiddenSelected() const
 
 
 void
-PackageTreeItem::setSelected( Qt::CheckState isSelected )
+PackageTreeItem::countChild( Qt::CheckState s, int delta )
 {
-    if ( parentItem() == nullptr )
+    if ( s == Qt::Checked )
     {
-        // This is the root, it is always checked so don't change state
-        return;
+        m_childrenChecked += delta;
     }
+    else if ( s == Qt::PartiallyChecked )
+    {
+        m_childrenPartial += delta;
+    }
+}
 
+void
+PackageTreeItem::setCheckState( Qt::CheckState isSelected )
+{
+    if ( isSelected == m_selected )
+    {
+        return;
+    }
+    // Only items that have been added to the parent are counted there
+    if ( m_parentItem && m_row >= 0 )
+    {
+        m_parentItem->countChild( m_selected, -1 );
+        m_parentItem->countChild( isSelected, 1 );
+    }
     m_selected = isSelected;
-    setChildrenSelected( isSelected );
+}
 
-    // Look for suitable parent item which may change checked-state
-    // when one of its children changes.
-    PackageTreeItem* currentItem = parentItem();
-    while ( ( currentItem != nullptr ) && ( currentItem->childCount() == 0 ) )
+Qt::CheckState
+PackageTreeItem::childrenCheckState() const
+{
+    if ( !m_childrenChecked && !m_childrenPartial )
     {
-        currentItem = currentItem->parentItem();
+        return Qt::Unchecked;
     }
-    if ( currentItem == nullptr )
+    else if ( m_childrenChecked == childCount() )
     {
-        // Reached the root .. don't bother
-        return;
+        return Qt::Checked;
+    }
+    else
+    {
+        return Qt::PartiallyChecked;
     }
+}
 
-    currentItem->updateSelected();
+bool
+PackageTreeItem::allChildren( Qt::CheckState s ) const
+{
+    switch ( s )
+    {
+    case Qt::Checked:
+        return m_childrenChecked == childCount();
+    case Qt::Unchecked:
+        return !m_childrenChecked && !m_childrenPartial;
+    default:
+        return false;
+    }
 }
 
 void
-PackageTreeItem::updateSelected()
+PackageTreeItem::setSelected( Qt::CheckState isSelected )
 {
-    // Figure out checked-state based on the children
-    int childrenSelected = 0;
-    int childrenPartiallySelected = 0;
-    for ( int i = 0; i < childCount(); i++ )
+    if ( parentItem() == nullptr )
+    {
+        // This is the root, it is always checked so don't change state
+        return;
+    }
+
+    setCheckState( isSelected );
+    setChildrenSelected( isSelected );
+
+    // The parent items may change checked-state when one of their children
+    // changes; this only needs to go up as far as something changes.
+    // Items without children (yet) have nothing to base a state on.
+    // The root is always checked, so don't bother with it.
+    PackageTreeItem* currentItem = parentItem();
+    while ( currentItem && currentItem->parentItem() )
     {
-        if ( child( i )->isSelected() == Qt::Checked )
+        if ( currentItem->childCount() == 0 )
         {
-            childrenSelected++;
+            currentItem = currentItem->parentItem();
+            continue;
         }
-        if ( child( i )->isSelected() == Qt::PartiallyChecked )
+        const Qt::CheckState s = currentItem->childrenCheckState();
+        if ( s == currentItem->isSelected() )
         {
-            childrenPartiallySelected++;
+            break;
         }
+        currentItem->setCheckState( s );
+        currentItem = currentItem->parentItem();
     }
-    if ( !childrenSelected && !childrenPartiallySelected )
-    {
-        setSelected( Qt::Unchecked );
-    }
-    else if ( childrenSelected == childCount() )
-    {
-        setSelected( Qt::Checked );
-    }
-    else
-    {
-        setSelected( Qt::PartiallyChecked );
-    }
+}
+
+void
+PackageTreeItem::updateSelected()
+{
+    // Figure out checked-state based on the children
+    setSelected( childrenCheckState() );
 }
 
 
@@ -243,7 +287,13 @@ PackageTreeItem::setChildrenSelected( Qt::CheckState isSelected )
         // Children are never root; don't need to use setSelected on them.
         for ( auto child : m_childItems )
         {
-            child->m_selected = isSelected;
+            // If the child and all of its children are already in
+            // the right state, then the whole subtree is.
+            if ( child->m_selected == isSelected && child->allChildren( isSelected ) )
+            {
+                continue;
+            }
+            child->setCheckState( isSelected );
             child->setChildrenSelected( isSelected );
         }
 }
@@ -45,6 +45,11 @@ public:
     PackageTreeItem* child( int row );
     int childCount() const;
     QVariant data( int column ) const override;
+    /** @brief The index of this item in its parent
+     *
+     * Returns -1 if the item has a parent, but was not added to
+     * it with appendChild() (e.g. hidden items). Returns 0 for root.
+     */
     int row() const;
 
     PackageTreeItem* parentItem();
@@ -128,6 +133,9 @@ public:
      *
      * This only makes sense for groups, which might have packages
      * or subgroups; it checks only direct children.
+     *
+     * Each item counts how many of its children are (partially)
+     * selected, so this does not need to look at the children.
      */
     void updateSelected();
 
@@ -145,8 +153,20 @@ public:
     bool operator!=( const PackageTreeItem& rhs ) const { return !( *this == rhs ); }
 
 private:
+    /// @brief Changes the selected state, and the parent's count of selected children
+    void setCheckState( Qt::CheckState isSelected );
+    /// @brief Adjust counts of selected children for a child in state @p s
+    void countChild( Qt::CheckState s, int delta );
+    /// @brief The selected-state implied by the state of the children
+    Qt::CheckState childrenCheckState() const;
+    /// @brief Are the children all in state @p s ?
+    bool allChildren( Qt::CheckState s ) const;
+
     PackageTreeItem* m_parentItem;
     List m_childItems;
+    int m_row = -1;  ///< Index in the parent's m_childItems
+    int m_childrenChecked = 0;  ///< Number of children that are Checked
+    int m_childrenPartial = 0;  ///< Number of children that are PartiallyChecked
 
     // An entry can be a package, or a group.
     QString m_name;
@@ -40,6 +40,9 @@ private Q_SLOTS:
     void testCompare();
     void testModel();
     void testExampleFiles();
+
+    void testSelection();
+    void benchmarkSelection();
 };
 
 ItemTests::ItemTests() {}
@@ -326,6 +329,122 @@ ItemTests::testExampleFiles()
     }
 }
 
+/** @brief Makes an unselected group (in netinstall.conf format) with @p packageCount packages
+ *
+ * If @p depth is larger than 1, the group gets @p subgroupCount subgroups,
+ * each of which is made the same way with depth one less.
+ */
+static QVariantMap
+makeGroup( const QString& name, int depth, int subgroupCount, int packageCount )
+{
+    QVariantList packages;
+    for ( int i = 0; i < packageCount; ++i )
+    {
+        packages.append( QStringLiteral( "%1-pkg%2" ).arg( name ).arg( i ) );
+    }
+
+    QVariantMap group;
+    group.insert( "name", name );
+    group.insert( "description", name );
+    group.insert( "selected", false );
+    group.insert( "packages", packages );
+    if ( depth > 1 )
+    {
+        QVariantList subgroups;
+        for ( int i = 0; i < subgroupCount; ++i )
+        {
+            subgroups.append(
+                makeGroup( QStringLiteral( "%1.%2" ).arg( name ).arg( i ), depth - 1, subgroupCount, packageCount ) );
+        }
+        group.insert( "subgroups", subgroups );
+    }
+    return group;
+}
+
+void
+ItemTests::testSelection()
+{
+    PackageModel m( nullptr );
+    m.setupModelData( QVariantList { makeGroup( "g", 3, 2, 3 ) } );
+
+    PackageTreeItem* g = m.m_rootItem->child( 0 );
+    QVERIFY( g );
+    QCOMPARE( g->row(), 0 );
+    // 3 packages, then 2 subgroups
+    QCOMPARE( g->childCount(), 5 );
+    for ( int i = 0; i < g->childCount(); ++i )
+    {
+        QCOMPARE( g->child( i )->row(), i );
+        QCOMPARE( g->child( i )->parentItem(), g );
+    }
+
+    PackageTreeItem* sub = g->child( 3 );
+    PackageTreeItem* subsub = sub->child( 4 );
+    QVERIFY( sub->isGroup() );
+    QVERIFY( subsub->isGroup() );
+    QCOMPARE( subsub->childCount(), 3 );
+    QCOMPARE( g->isSelected(), Qt::Unchecked );
+
+    // Selecting a package makes all groups up the tree partial
+    subsub->child( 0 )->setSelected( Qt::Checked );
+    QCOMPARE( subsub->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( sub->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( g->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( m.m_rootItem->isSelected(), Qt::Checked );
+
+    // Selecting the rest of the packages fully selects the innermost group
+    subsub->child( 1 )->setSelected( Qt::Checked );
+    subsub->child( 2 )->setSelected( Qt::Checked );
+    QCOMPARE( subsub->isSelected(), Qt::Checked );
+    QCOMPARE( sub->isSelected(), Qt::PartiallyChecked );
+
+    // Selecting a group selects everything beneath it
+    g->setSelected( Qt::Checked );
+    checkAllSelected( g );
+    QCOMPARE( m.getPackages().count(), 3 + 2 * ( 3 + 2 * 3 ) );
+
+    // Deselecting one package goes back to partial
+    subsub->child( 1 )->setSelected( Qt::Unchecked );
+    QCOMPARE( subsub->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( sub->isSelected(), Qt::PartiallyChecked );
+    QCOMPARE( g->isSelected(), Qt::PartiallyChecked );
+
+    // .. and deselecting the group deselects everything
+    g->setSelected( Qt::Unchecked );
+    QCOMPARE( subsub->isSelected(), Qt::Unchecked );
+    QCOMPARE( subsub->child( 0 )->isSelected(), Qt::Unchecked );
+    QCOMPARE( m.getPackages().count(), 0 );
+}
+
+void
+ItemTests::benchmarkSelection()
+{
+    // 1 + 10 + 100 + 1000 groups with 45 packages each is just under 50000 packages
+    const QVariantList groups { makeGroup( "g", 4, 10, 45 ) };
+
+    QBENCHMARK
+    {
+        PackageModel m( nullptr );
+        m.setupModelData( groups );
+        PackageTreeItem* g = m.m_rootItem->child( 0 );
+        QVERIFY( g );
+
+        // Toggle the whole tree, and then individual packages deep down
+        g->setSelected( Qt::Checked );
+        g->setSelected( Qt::Unchecked );
+        for ( int i = 0; i < g->childCount(); ++i )
+        {
+            PackageTreeItem* item = g->child( i );
+            while ( item->childCount() > 0 )
+            {
+                item = item->child( item->childCount() - 1 );
+            }
+            item->setSelected( Qt::Checked );
+        }
+        QCOMPARE( g->isSelected(), Qt::PartiallyChecked );
+    }
+}
+
 
 QTEST_GUILESS_MAIN( ItemTests )
 
@@ -15,11 +15,16 @@
 #
 
 import abc
+from concurrent.futures import ThreadPoolExecutor
+import os
+import re
+import shutil
 from string import Template
 import subprocess
+import urllib.request
 
 import libcalamares
-from libcalamares.utils import check_target_env_call, target_env_call
+from libcalamares.utils import check_target_env_call, check_target_env_output, target_env_call
 from libcalamares.utils import gettext_path, gettext_languages
 
 import gettext
@@ -34,10 +39,12 @@ _n = _translation.ngettext
 total_packages = 0  # For the entire job
 completed_packages = 0  # Done so far for this job
 group_packages = 0  # One group of packages from an -install or -remove entry
+group_completed_packages = 0  # Done so far in this group, from package-manager output
 
 INSTALL = object()
 REMOVE = object()
-mode_packages = None  # Changes to INSTALL or REMOVE
+DOWNLOAD = object()
+mode_packages = None  # Changes to INSTALL, REMOVE or DOWNLOAD
 
 
 def _change_mode(mode):
@@ -46,6 +53,49 @@ def _change_mode(mode):
     libcalamares.job.setprogress(completed_packages * 1.0 / total_packages)
 
 
+def _package_done():
+    """
+    Called when the package manager reports that it is done with
+    one package. Package managers also report dependencies, so
+    progress does not go past the end of the group.
+    """
+    global group_completed_packages
+    if group_completed_packages < group_packages:
+        group_completed_packages += 1
+        libcalamares.job.setprogress((completed_packages + group_completed_packages) * 1.0 / total_packages)
+
+
+def target_env_process_output(command, line_cb):
+    """
+    Runs @p command in the target system, like check_target_env_call(),
+    and calls @p line_cb with each line of output. Raises
+    subprocess.CalledProcessError if the command fails.
+
+    @param command: list[str]
+    @param line_cb: callable(str)
+    """
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    args = ["chroot", root_mount_point] + command if root_mount_point else command
+    libcalamares.utils.debug("Running {!s}".format(args))
+
+    # Package managers may print file names that are not UTF-8
+    process = subprocess.Popen(args,
+                               stdin=subprocess.DEVNULL,
+                               stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT,
+                               universal_newlines=True,
+                               errors="replace")
+    output = []
+    for line in process.stdout:
+        output.append(line)
+        line_cb(line)
+    process.wait()
+    if process.returncode != 0:
+        libcalamares.utils.warning("Command {!s} exited with {!s}".format(command, process.returncode))
+        libcalamares.utils.warning("Output:\n{!s}".format("".join(output)))
+        raise subprocess.CalledProcessError(process.returncode, command, output="".join(output))
+
+
 def pretty_name():
     return _("Install packages.")
 
@@ -64,6 +114,9 @@ def pretty_status_message():
     elif mode_packages is REMOVE:
         s = _n("Removing one package.",
                "Removing %(num)d packages.", group_packages)
+    elif mode_packages is DOWNLOAD:
+        s = _n("Downloading one package.",
+               "Downloading %(num)d packages.", group_packages)
     else:
         # No mode, generic description
         s = _("Install packages.")
@@ -84,12 +137,20 @@ class PackageManager(metaclass=abc.ABCMeta):
     """
     backend = None
 
+    # Directory (in the target system) where the package manager keeps
+    # downloaded packages. If None, the cache cannot be seeded.
+    cache_dir = None
+
+    # Regular expression that matches a line of package-manager output
+    # which reports that one package has been installed or removed.
+    # If None, the output is not used for progress reporting.
+    progress_re = None
+
     @abc.abstractmethod
     def install(self, pkgs, from_local=False):
         """
         Install a list of packages (named) into the system.
-        Although this handles lists, in practice it is called
-        with one package at a time.
+        This should be a single package-manager transaction.
 
         @param pkgs: list[str]
             list of package names
@@ -113,10 +174,46 @@ class PackageManager(metaclass=abc.ABCMeta):
     def update_db(self):
         pass
 
+    def download_urls(self, pkgs):
+        """
+        Lists the files that the package manager would download into
+        the cache_dir to install @p pkgs (and their dependencies), as
+        a list of (url, filename) pairs. Backends that cannot do this
+        return None.
+
+        @param pkgs: list[str]
+            list of package names
+        """
+        return None
+
+    def package_name(self, filename):
+        """
+        Returns the name of the package in the package file @p filename
+        (e.g. in the cache_dir), or None if it is not a package file.
+        """
+        return None
+
     def run(self, script):
         if script != "":
             check_target_env_call(script.split(" "))
 
+    def call(self, command):
+        """
+        Runs the package manager @p command in the target system,
+        reporting progress from its output if the backend has a
+        progress_re.
+        """
+        if self.progress_re is None:
+            check_target_env_call(command)
+        else:
+            progress_re = re.compile(self.progress_re)
+
+            def line_cb(line):
+                if progress_re.search(line):
+                    _package_done()
+
+            target_env_process_output(command, line_cb)
+
     def install_package(self, packagedata, from_local=False):
         """
         Install a package from a single entry in the install list.
@@ -151,6 +248,58 @@ class PackageManager(metaclass=abc.ABCMeta):
             self.remove([packagedata["package"]])
             self.run(packagedata["post-script"])
 
+    def install_packagelist(self, packagelist, from_local=False):
+        """
+        Install all the entries from an install list. Consecutive
+        entries without scripts are installed in a single transaction.
+
+        @param packagelist: list[str|dict]
+        @param from_local: bool
+            see install.from_local
+        """
+        for batch, packagedata in _batches(packagelist):
+            if batch:
+                self.install(batch, from_local=from_local)
+            else:
+                self.install_package(packagedata, from_local=from_local)
+
+    def remove_packagelist(self, packagelist):
+        """
+        Remove all the entries from a remove list. Consecutive
+        entries without scripts are removed in a single transaction.
+
+        @param packagelist: list[str|dict]
+        """
+        for batch, packagedata in _batches(packagelist):
+            if batch:
+                self.remove(batch)
+            else:
+                self.remove_package(packagedata)
+
+
+def _batches(packagelist):
+    """
+    Splits @p packagelist (a list of entries as in install_package())
+    into parts that can be handled by the package manager at once.
+
+    Yields tuples (batch, packagedata): either batch is a non-empty
+    list of package names, or it is None and packagedata is a single
+    entry that has scripts to run.
+    """
+    batch = []
+    for packagedata in packagelist:
+        if isinstance(packagedata, str):
+            batch.append(packagedata)
+        elif not packagedata.get("pre-script") and not packagedata.get("post-script"):
+            batch.append(packagedata["package"])
+        else:
+            if batch:
+                yield batch, None
+                batch = []
+            yield None, packagedata
+    if batch:
+        yield batch, None
+
 
 ### PACKAGE MANAGER IMPLEMENTATIONS
 #
@@ -160,14 +309,13 @@ class PackageManager(metaclass=abc.ABCMeta):
 
 class PMApk(PackageManager):
     backend = "apk"
+    progress_re = r"^\(\s*\d+/\d+\) (Installing|Upgrading|Purging) "
 
     def install(self, pkgs, from_local=False):
-        for pkg in pkgs:
-            check_target_env_call(["apk", "add", pkg])
+        self.call(["apk", "add"] + pkgs)
 
     def remove(self, pkgs):
-        for pkg in pkgs:
-            check_target_env_call(["apk", "del", pkg])
+        self.call(["apk", "del"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["apk", "update"])
@@ -178,16 +326,32 @@ class PMApk(PackageManager):
 
 class PMApt(PackageManager):
     backend = "apt"
+    cache_dir = "/var/cache/apt/archives"
+    progress_re = r"^(Setting up|Removing) "
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["apt-get", "-q", "-y", "install"] + pkgs)
+        self.call(["apt-get", "-q", "-y", "install"] + pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["apt-get", "--purge", "-q", "-y",
-                               "remove"] + pkgs)
+        self.call(["apt-get", "--purge", "-q", "-y",
+                   "remove"] + pkgs)
         check_target_env_call(["apt-get", "--purge", "-q", "-y",
                                "autoremove"])
 
+    def download_urls(self, pkgs):
+        # Lines look like 'URL' filename size checksum
+        output = check_target_env_output(["apt-get", "-qq", "--print-uris", "install"] + pkgs)
+        urls = []
+        for line in output.splitlines():
+            parts = line.split()
+            if len(parts) >= 2 and parts[0].startswith("'"):
+                urls.append((parts[0].strip("'"), parts[1]))
+        return urls
+
+    def package_name(self, filename):
+        # name_version_arch.deb
+        return filename.split("_", 1)[0] if filename.endswith(".deb") else None
+
     def update_db(self):
         check_target_env_call(["apt-get", "update"])
 
@@ -198,9 +362,10 @@ class PMApt(PackageManager):
 
 class PMDnf(PackageManager):
     backend = "dnf"
+    progress_re = r"^\s*(Installing|Upgrading)\s*:"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["dnf", "-y", "install"] + pkgs)
+        self.call(["dnf", "-y", "install"] + pkgs)
 
     def remove(self, pkgs):
         # ignore the error code for now because dnf thinks removing a
@@ -260,12 +425,10 @@ class PMPackageKit(PackageManager):
     backend = "packagekit"
 
     def install(self, pkgs, from_local=False):
-        for pkg in pkgs:
-            check_target_env_call(["pkcon", "-py", "install", pkg])
+        check_target_env_call(["pkcon", "-py", "install"] + pkgs)
 
     def remove(self, pkgs):
-        for pkg in pkgs:
-            check_target_env_call(["pkcon", "-py", "remove", pkg])
+        check_target_env_call(["pkcon", "-py", "remove"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["pkcon", "refresh"])
@@ -276,6 +439,8 @@ class PMPackageKit(PackageManager):
 
 class PMPacman(PackageManager):
     backend = "pacman"
+    cache_dir = "/var/cache/pacman/pkg"
+    progress_re = r"^(\(\s*\d+/\d+\) )?(installing|upgrading|reinstalling|removing) "
 
     def install(self, pkgs, from_local=False):
         if from_local:
@@ -283,11 +448,20 @@ class PMPacman(PackageManager):
         else:
             pacman_flags = "-S"
 
-        check_target_env_call(["pacman", pacman_flags,
-                               "--noconfirm"] + pkgs)
+        self.call(["pacman", pacman_flags,
+                   "--noconfirm"] + pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["pacman", "-Rs", "--noconfirm"] + pkgs)
+        self.call(["pacman", "-Rs", "--noconfirm"] + pkgs)
+
+    def download_urls(self, pkgs):
+        output = check_target_env_output(["pacman", "-Sp", "--noconfirm"] + pkgs)
+        return [(url, url.rsplit("/", 1)[-1]) for url in output.split() if "://" in url]
+
+    def package_name(self, filename):
+        # name-version-release-arch.pkg.tar.zst, and its signature
+        m = re.match(r"^(.+)-[^-]+-[^-]+-[^-]+\.pkg\.tar(\.\w+)?(\.sig)?$", filename)
+        return m.group(1) if m else None
 
     def update_db(self):
         check_target_env_call(["pacman", "-Sy"])
@@ -378,12 +552,19 @@ class PMUrpmi(PackageManager):
 
 class PMXbps(PackageManager):
     backend = "xbps"
+    cache_dir = "/var/cache/xbps"
+    progress_re = r": (installed|removed) successfully"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["xbps-install", "-Sy"] + pkgs)
+        self.call(["xbps-install", "-Sy"] + pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["xbps-remove", "-Ry", "--noconfirm"] + pkgs)
+        self.call(["xbps-remove", "-Ry", "--noconfirm"] + pkgs)
+
+    def package_name(self, filename):
+        # name-version_revision.arch.xbps, and its signature
+        m = re.match(r"^(.+)-[^-]+_\d+\.[^.]+\.xbps(\.sig2?)?$", filename)
+        return m.group(1) if m else None
 
     def update_db(self):
         check_target_env_call(["xbps-install", "-S"])
@@ -394,9 +575,10 @@ class PMXbps(PackageManager):
 
 class PMYum(PackageManager):
     backend = "yum"
+    progress_re = r"^\s*(Installing|Updating)\s*:"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["yum", "-y", "install"] + pkgs)
+        self.call(["yum", "-y", "install"] + pkgs)
 
     def remove(self, pkgs):
         check_target_env_call(["yum", "--disablerepo=*", "-C", "-y",
@@ -412,16 +594,17 @@ class PMYum(PackageManager):
 
 class PMZypp(PackageManager):
     backend = "zypp"
+    progress_re = r"^\(\s*\d+/\d+\) (Installing|Removing):"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["zypper", "--non-interactive",
-                               "--quiet-install", "install",
-                               "--auto-agree-with-licenses",
-                               "install"] + pkgs)
+        self.call(["zypper", "--non-interactive",
+                   "--quiet-install", "install",
+                   "--auto-agree-with-licenses",
+                   "install"] + pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["zypper", "--non-interactive",
-                               "remove"] + pkgs)
+        self.call(["zypper", "--non-interactive",
+                   "remove"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["zypper", "--non-interactive", "update"])
@@ -484,6 +667,59 @@ def subst_locale(plist):
     return ret
 
 
+def try_packagelist(all_cb, one_cb, package_list, warn_text):
+    """
+    Tries to handle all of @p package_list at once, with @p all_cb.
+    If that fails, tries each package separately with @p one_cb,
+    so that a single failing package won't stop all of them.
+    Lists with scripts are always done one-by-one, so that the
+    scripts do not run twice.
+    """
+    global group_completed_packages
+
+    if all(batch for batch, _ in _batches(package_list)):
+        try:
+            all_cb(package_list)
+            return
+        except subprocess.CalledProcessError:
+            libcalamares.utils.debug("Could not handle packages together, trying one-by-one.")
+        group_completed_packages = 0
+
+    for package in package_list:
+        try:
+            one_cb(package)
+        except subprocess.CalledProcessError:
+            libcalamares.utils.warning(warn_text + str(package))
+
+
+# Operations which can be merged with a following operation with the same key.
+mergeable_operations = ("install", "try_install", "remove", "try_remove", "localInstall")
+
+
+def merge_operations(operations):
+    """
+    Merges consecutive package operations of the same kind, so that
+    they can be done in one package-manager transaction. Only entries
+    that have a single operation (ignoring *source*) are merged.
+
+    @param operations: list[dict]
+    @return: list[dict]
+    """
+    def single_key(entry):
+        keys = [k for k in entry.keys() if k != "source"]
+        return keys[0] if len(keys) == 1 and keys[0] in mergeable_operations else None
+
+    merged = []
+    for entry in operations:
+        key = single_key(entry)
+        if key and merged and single_key(merged[-1]) == key:
+            libcalamares.utils.debug("Merging {!s} operation from {!s}".format(key, entry.get("source", "config")))
+            merged[-1] = {key: merged[-1][key] + entry[key]}
+        else:
+            merged.append(entry)
+    return merged
+
+
 def run_operations(pkgman, entry):
     """
     Call package manager with suitable parameters for the given
@@ -499,52 +735,29 @@ def run_operations(pkgman, entry):
         names (strings) or package information dictionaries with pre-
         and post-scripts.
     """
-    global group_packages, completed_packages, mode_packages
+    global group_packages, completed_packages, mode_packages, group_completed_packages
 
     for key in entry.keys():
         package_list = subst_locale(entry[key])
         group_packages = len(package_list)
+        group_completed_packages = 0
         if key == "install":
             _change_mode(INSTALL)
-            if all([isinstance(x, str) for x in package_list]):
-                pkgman.install(package_list)
-            else:
-                for package in package_list:
-                    pkgman.install_package(package)
+            pkgman.install_packagelist(package_list)
         elif key == "try_install":
             _change_mode(INSTALL)
-            # we make a separate package manager call for each package so a
-            # single failing package won't stop all of them
-            for package in package_list:
-                try:
-                    pkgman.install_package(package)
-                except subprocess.CalledProcessError:
-                    warn_text = "Could not install package "
-                    warn_text += str(package)
-                    libcalamares.utils.warning(warn_text)
+            try_packagelist(pkgman.install_packagelist, pkgman.install_package, package_list,
+                            "Could not install package ")
         elif key == "remove":
             _change_mode(REMOVE)
-            if all([isinstance(x, str) for x in package_list]):
-                pkgman.remove(package_list)
-            else:
-                for package in package_list:
-                    pkgman.remove_package(package)
+            pkgman.remove_packagelist(package_list)
         elif key == "try_remove":
             _change_mode(REMOVE)
-            for package in package_list:
-                try:
-                    pkgman.remove_package(package)
-                except subprocess.CalledProcessError:
-                    warn_text = "Could not remove package "
-                    warn_text += str(package)
-                    libcalamares.utils.warning(warn_text)
+            try_packagelist(pkgman.remove_packagelist, pkgman.remove_package, package_list,
+                            "Could not remove package ")
         elif key == "localInstall":
             _change_mode(INSTALL)
-            if all([isinstance(x, str) for x in package_list]):
-                pkgman.install(package_list, from_local=True)
-            else:
-                for package in package_list:
-                    pkgman.install_package(package, from_local=True)
+            pkgman.install_packagelist(package_list, from_local=True)
         elif key == "source":
             libcalamares.utils.debug("Package-list from {!s}".format(entry[key]))
         else:
@@ -557,6 +770,128 @@ def run_operations(pkgman, entry):
     _change_mode(None)
 
 
+def install_package_names(operations):
+    """
+    Returns the names of the packages that @p operations install
+    from the repositories (so not the localInstall ones).
+    """
+    pkgs = []
+    for entry in operations:
+        for key in ("install", "try_install"):
+            if key in entry:
+                for packagedata in subst_locale(entry[key]):
+                    pkgs.append(packagedata if isinstance(packagedata, str) else packagedata["package"])
+    return pkgs
+
+
+def seed_package_cache(pkgman, source_dir, pkgs):
+    """
+    Copies the package files for @p pkgs from @p source_dir (e.g. a
+    directory on the ISO) into the package cache of the target system,
+    so that the package manager does not need to download them. Other
+    files in @p source_dir, and files that are already in the cache,
+    are left alone. Files are hard-linked if possible, and copied (in
+    parallel) otherwise.
+
+    @return: the number of packages put in the cache
+    """
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    if not pkgman.cache_dir:
+        libcalamares.utils.warning("Package cache can not be seeded for backend {!s}".format(pkgman.backend))
+        return 0
+    if not root_mount_point or not os.path.isdir(source_dir):
+        libcalamares.utils.warning("Package cache source {!s} is not a directory".format(source_dir))
+        return 0
+
+    target_dir = os.path.join(root_mount_point, pkgman.cache_dir.lstrip("/"))
+    os.makedirs(target_dir, exist_ok=True)
+    wanted = set(pkgs)
+
+    def seed(name):
+        source = os.path.join(source_dir, name)
+        target = os.path.join(target_dir, name)
+        if pkgman.package_name(name) not in wanted:
+            return 0
+        if not os.path.isfile(source) or os.path.exists(target):
+            return 0
+        try:
+            os.link(source, target)
+        except OSError:
+            try:
+                shutil.copy2(source, target)
+            except OSError as e:
+                # e.g. the target is full; the package manager downloads it instead
+                libcalamares.utils.warning("Could not copy {!s} to the package cache: {!s}".format(name, e))
+                if os.path.exists(target):
+                    os.unlink(target)
+                return 0
+        return 1
+
+    with ThreadPoolExecutor() as executor:
+        count = sum(executor.map(seed, os.listdir(source_dir)))
+    libcalamares.utils.debug("Seeded package cache {!s} with {!s} packages from {!s}".format(
+        target_dir, count, source_dir))
+    return count
+
+
+def download_packages(pkgman, pkgs, parallel):
+    """
+    Downloads the package files for @p pkgs (and their dependencies)
+    into the package cache of the target system, at most @p parallel
+    at a time, so that the installation afterwards runs from the cache.
+    Files that are already in the cache (e.g. seeded ones) are skipped.
+    Failure is not fatal: the install operations download whatever is
+    missing, and report errors as usual.
+
+    @return: the number of packages put in the cache
+    """
+    global group_packages
+
+    root_mount_point = libcalamares.globalstorage.value("rootMountPoint")
+    if not pkgman.cache_dir or not root_mount_point:
+        libcalamares.utils.debug("Backend {!s} can not pre-download packages".format(pkgman.backend))
+        return 0
+    try:
+        urls = pkgman.download_urls(pkgs)
+    except subprocess.CalledProcessError:
+        libcalamares.utils.warning("Could not list the packages to pre-download")
+        return 0
+    if urls is None:
+        libcalamares.utils.debug("Backend {!s} can not pre-download packages".format(pkgman.backend))
+        return 0
+
+    target_dir = os.path.join(root_mount_point, pkgman.cache_dir.lstrip("/"))
+    os.makedirs(target_dir, exist_ok=True)
+    urls = [(url, name) for url, name in urls if not os.path.exists(os.path.join(target_dir, name))]
+    if not urls:
+        return 0
+
+    def fetch(item):
+        url, name = item
+        target = os.path.join(target_dir, name)
+        # Download next to the target, so the package manager never sees partial files
+        partial = target + ".part"
+        try:
+            with urllib.request.urlopen(url, timeout=60) as response, open(partial, "wb") as f:
+                shutil.copyfileobj(response, f)
+            os.rename(partial, target)
+        except OSError as e:
+            libcalamares.utils.warning("Could not download {!s}: {!s}".format(url, e))
+            if os.path.exists(partial):
+                os.unlink(partial)
+            return 0
+        return 1
+
+    group_packages = len(urls)
+    _change_mode(DOWNLOAD)
+    with ThreadPoolExecutor(max_workers=parallel) as executor:
+        count = sum(executor.map(fetch, urls))
+    group_packages = 0
+    _change_mode(None)
+    libcalamares.utils.debug("Downloaded {!s} of {!s} packages into {!s}".format(count, len(urls), target_dir))
+    return count
+
+
 def run():
     """
     Calls routine with detected package manager to install locale packages
@@ -591,6 +926,7 @@ def run():
     operations = libcalamares.job.configuration.get("operations", [])
     if libcalamares.globalstorage.contains("packageOperations"):
         operations += libcalamares.globalstorage.value("packageOperations")
+    operations = merge_operations(operations)
 
     mode_packages = None
     total_packages = 0
@@ -603,6 +939,16 @@ def run():
         # Avoids potential divide-by-zero in progress reporting
         return None
 
+    package_cache = libcalamares.job.configuration.get("package_cache", None)
+    if package_cache:
+        seed_package_cache(pkgman, package_cache, install_package_names(operations))
+
+    predownload = libcalamares.job.configuration.get("predownload", False)
+    if predownload and libcalamares.globalstorage.value("hasInternet"):
+        pkgs = install_package_names(operations)
+        if pkgs:
+            download_packages(pkgman, pkgs, libcalamares.job.configuration.get("parallel_downloads", 4))
+
     for entry in operations:
         group_packages = 0
         libcalamares.utils.debug(pretty_name())
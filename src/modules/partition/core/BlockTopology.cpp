@@ -0,0 +1,189 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "BlockTopology.h"
+
+#include "partition/Mount.h"
+#include "utils/Logger.h"
+#include "utils/String.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+/// @brief Contents of a (small) file in sysfs or proc, or empty
+static QByteArray
+readFile( const QString& path )
+{
+    QFile f( path );
+    if ( f.open( QIODevice::ReadOnly ) )
+    {
+        return f.readAll();
+    }
+    return QByteArray();
+}
+
+static QStringList
+entries( const QString& path )
+{
+    return QDir( path ).entryList( QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot );
+}
+
+/// @brief The kernel name of the block device at @p path (e.g. /dev/mapper/x is dm-0)
+static QString
+kernelName( const QString& path )
+{
+    const QString canonical = QFileInfo( path ).canonicalFilePath();
+    return canonical.startsWith( QStringLiteral( "/dev/" ) ) ? QFileInfo( canonical ).fileName() : QString();
+}
+
+QString
+BlockTopology::Node::volumeGroup() const
+{
+    if ( !isLvm() )
+    {
+        return QString();
+    }
+    // The device-mapper name is <vg>-<lv>, with dashes in the names doubled
+    QString vg;
+    for ( int i = 0; i < dmName.length(); ++i )
+    {
+        if ( dmName.at( i ) == '-' )
+        {
+            if ( i + 1 < dmName.length() && dmName.at( i + 1 ) == '-' )
+            {
+                ++i;
+            }
+            else
+            {
+                return vg;
+            }
+        }
+        vg.append( dmName.at( i ) );
+    }
+    return vg;
+}
+
+BlockTopology
+BlockTopology::snapshot()
+{
+    return read( QStringLiteral( "/sys/class/block" ), QStringLiteral( "/proc" ) );
+}
+
+BlockTopology
+BlockTopology::read( const QString& sysBlockPath, const QString& procPath )
+{
+    using CalamaresUtils::Partition::unescapeMountPoint;
+
+    BlockTopology t;
+    QHash< QString, QString > byDeviceNumber;
+
+    for ( const auto& name : entries( sysBlockPath ) )
+    {
+        const QString base = sysBlockPath + '/' + name;
+        Node n;
+        n.name = name;
+        n.holders = entries( base + QStringLiteral( "/holders" ) );
+        if ( QFile::exists( base + QStringLiteral( "/partition" ) ) )
+        {
+            // The partition's directory is inside the disk's directory
+            n.parent = QFileInfo( QFileInfo( base ).canonicalFilePath() ).dir().dirName();
+        }
+        n.dmName = QString::fromUtf8( readFile( base + QStringLiteral( "/dm/name" ) ) ).trimmed();
+        n.dmUuid = QString::fromUtf8( readFile( base + QStringLiteral( "/dm/uuid" ) ) ).trimmed();
+        n.devicePath = n.dmName.isEmpty() ? ( QStringLiteral( "/dev/" ) + name )
+                                          : ( QStringLiteral( "/dev/mapper/" ) + n.dmName );
+
+        byDeviceNumber.insert( QString::fromLatin1( readFile( base + QStringLiteral( "/dev" ) ) ).trimmed(), name );
+        t.m_nodes.insert( name, n );
+    }
+
+    // Fields are: id parent major:minor root mountpoint options... - fstype source superoptions
+    for ( const auto& line : readFile( procPath + QStringLiteral( "/self/mountinfo" ) ).split( '\n' ) )
+    {
+        const QList< QByteArray > fields = line.split( ' ' );
+        const int separator = fields.indexOf( "-" );
+        if ( fields.count() < 5 || separator < 0 || separator + 2 >= fields.count() )
+        {
+            continue;
+        }
+        // Some filesystems (e.g. btrfs) report a device number of their own, so try the source too
+        QString name = byDeviceNumber.value( QString::fromLatin1( fields.at( 2 ) ) );
+        if ( !t.m_nodes.contains( name ) )
+        {
+            name = kernelName( unescapeMountPoint( fields.at( separator + 2 ) ) );
+        }
+        if ( t.m_nodes.contains( name ) )
+        {
+            t.m_nodes[ name ].mountPoints.append( unescapeMountPoint( fields.at( 4 ) ) );
+        }
+    }
+
+    const QList< QByteArray > swaps = readFile( procPath + QStringLiteral( "/swaps" ) ).split( '\n' );
+    for ( int i = 1; i < swaps.count(); ++i )  // Skip the header
+    {
+        const QString name = kernelName( unescapeMountPoint( swaps.at( i ).split( ' ' ).first() ) );
+        if ( t.m_nodes.contains( name ) )
+        {
+            t.m_nodes[ name ].isSwap = true;
+        }
+    }
+
+    cDebug() << "Block topology has" << t.m_nodes.count() << "devices.";
+    return t;
+}
+
+const BlockTopology::Node*
+BlockTopology::node( const QString& name ) const
+{
+    auto it = m_nodes.constFind( name );
+    return it == m_nodes.constEnd() ? nullptr : &( *it );
+}
+
+QStringList
+BlockTopology::partitions( const QString& disk ) const
+{
+    QStringList names;
+    for ( const auto& n : m_nodes )
+    {
+        if ( n.parent == disk )
+        {
+            names.append( n.name );
+        }
+    }
+    names.sort();
+    return names;
+}
+
+void
+BlockTopology::visit( const QString& name, QStringList& order ) const
+{
+    const Node* n = node( name );
+    if ( !n || order.contains( name ) )
+    {
+        return;
+    }
+    for ( const auto& holder : n->holders )
+    {
+        visit( holder, order );
+    }
+    for ( const auto& partition : partitions( name ) )
+    {
+        visit( partition, order );
+    }
+    order.append( name );
+}
+
+QStringList
+BlockTopology::stackedOn( const QString& disk ) const
+{
+    QStringList order;
+    visit( disk, order );
+    return order;
+}
@@ -0,0 +1,75 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_BLOCKTOPOLOGY_H
+#define PARTITION_BLOCKTOPOLOGY_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/** @brief A snapshot of the block devices and how they are used
+ *
+ * This is read in one go from sysfs (which devices are partitions,
+ * and which devices are built on top of others, e.g. LVM volumes
+ * and LUKS containers), /proc/self/mountinfo and /proc/swaps.
+ * No programs are run.
+ *
+ * Devices are identified by their kernel name, e.g. "sda1" or "dm-0".
+ */
+class BlockTopology
+{
+public:
+    struct Node
+    {
+        QString name;  ///< Kernel name, e.g. "sda1"
+        QString devicePath;  ///< e.g. "/dev/sda1", or "/dev/mapper/<name>" for device-mapper
+        QString parent;  ///< For partitions, the disk they are on
+        QStringList holders;  ///< Devices built on top of this one
+        QString dmName;  ///< For device-mapper devices, the name in /dev/mapper
+        QString dmUuid;  ///< For device-mapper devices, e.g. "CRYPT-LUKS2-..." or "LVM-..."
+        QStringList mountPoints;  ///< Where the device is mounted, in mount order
+        bool isSwap = false;  ///< Is the device in use as swap?
+
+        bool isCrypt() const { return dmUuid.startsWith( QStringLiteral( "CRYPT-" ) ); }
+        bool isLvm() const { return dmUuid.startsWith( QStringLiteral( "LVM-" ) ); }
+        /// @brief For LVM logical volumes, the name of the volume group
+        QString volumeGroup() const;
+    };
+
+    /// @brief Reads the current state of the system
+    static BlockTopology snapshot();
+    /** @brief Reads the devices in @p sysBlockPath, like /sys/class/block
+     *
+     * The mounts and swaps are read from @p procPath, like /proc.
+     * This is the implementation of snapshot(), for tests.
+     */
+    static BlockTopology read( const QString& sysBlockPath, const QString& procPath );
+
+    /// @brief The node called @p name, or nullptr if there is none
+    const Node* node( const QString& name ) const;
+
+    /// @brief The partitions on @p disk
+    QStringList partitions( const QString& disk ) const;
+
+    /** @brief Everything that depends on @p disk
+     *
+     * These are the partitions of @p disk, everything built on top of
+     * those (recursively) and @p disk itself. Devices come before the
+     * devices they are built on, so this is the order to take them down.
+     */
+    QStringList stackedOn( const QString& disk ) const;
+
+private:
+    void visit( const QString& name, QStringList& order ) const;
+
+    QHash< QString, Node > m_nodes;
+};
+
+#endif
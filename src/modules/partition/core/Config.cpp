@@ -253,6 +253,8 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
         m_requiredPartitionTableType.append( configurationMap.value( "requiredPartitionTableType" ).toString() );
     }
     gs->insert( "requiredPartitionTableType", m_requiredPartitionTableType );
+
+    m_parallelDevices = CalamaresUtils::getBool( configurationMap, "parallelDevices", false );
 }
 
 void
@@ -97,6 +97,9 @@ public:
     ///@brief Is manual partitioning allowed (not explicitly disnabled in the config file)?
     bool allowManualPartitioning() const;
 
+    /// @brief Should the jobs for different disks run at the same time?
+    bool parallelDevices() const { return m_parallelDevices; }
+
 public Q_SLOTS:
     void setInstallChoice( int );  ///< Translates a button ID or so to InstallChoice
     void setInstallChoice( InstallChoice );
@@ -115,6 +118,7 @@ private:
     InstallChoice m_installChoice = NoChoice;
     qreal m_requiredStorageGiB = 0.0;  // May duplicate setting in the welcome module
     QStringList m_requiredPartitionTableType;
+    bool m_parallelDevices = false;
 };
 
 /** @brief Given a set of swap choices, return a sensible value from it.
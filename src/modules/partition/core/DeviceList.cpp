@@ -16,6 +16,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "partition/Disks.h"
 #include "partition/PartitionIterator.h"
 #include "utils/Logger.h"
 
@@ -83,18 +84,35 @@ isIso9660( const Device* device )
     return false;
 }
 
+using CalamaresUtils::Partition::DiskType;
+
+/// @brief What the kernel says @p device is, or Disk if it doesn't know
+static DiskType
+diskType( const Device* device, const CalamaresUtils::Partition::DiskList& disks )
+{
+    const QString path = device->deviceNode();
+    for ( const auto& d : disks )
+    {
+        if ( d.devicePath == path )
+        {
+            return d.type;
+        }
+    }
+    return DiskType::Disk;
+}
+
 static inline bool
-isZRam( const Device* device )
+isZRam( const Device* device, DiskType type )
 {
     const QString path = device->deviceNode();
-    return path.startsWith( "/dev/zram" );
+    return type == DiskType::Memory || path.startsWith( "/dev/zram" );
 }
 
 static inline bool
-isFloppyDrive( const Device* device )
+isFloppyDrive( const Device* device, DiskType type )
 {
     const QString path = device->deviceNode();
-    return path.startsWith( "/dev/fd" ) || path.startsWith( "/dev/floppy" );
+    return type == DiskType::Floppy || path.startsWith( "/dev/fd" ) || path.startsWith( "/dev/floppy" );
 }
 
 static inline QDebug&
@@ -135,6 +153,9 @@ getDevices( DeviceType which )
 #else
     cDebug() << "Removing unsuitable devices:" << devices.count() << "candidates.";
 
+    // KPMcore has just scanned the devices, so the kernel's list is re-read as well
+    const auto disks = CalamaresUtils::Partition::rescanDisks();
+
     // Remove the device which contains / from the list
     for ( DeviceList::iterator it = devices.begin(); it != devices.end(); )
         if ( !( *it ) )
@@ -142,16 +163,21 @@ getDevices( DeviceType which )
             cDebug() << Logger::SubEntry << "Skipping nullptr device";
             it = erase( devices, it );
         }
-        else if ( isZRam( *it ) )
+        else if ( isZRam( *it, diskType( *it, disks ) ) )
         {
             cDebug() << Logger::SubEntry << "Removing zram" << it;
             it = erase( devices, it );
         }
-        else if ( isFloppyDrive( ( *it ) ) )
+        else if ( isFloppyDrive( *it, diskType( *it, disks ) ) )
         {
             cDebug() << Logger::SubEntry << "Removing floppy disk" << it;
             it = erase( devices, it );
         }
+        else if ( writableOnly && diskType( *it, disks ) == DiskType::Optical )
+        {
+            cDebug() << Logger::SubEntry << "Removing optical drive" << it;
+            it = erase( devices, it );
+        }
         else if ( writableOnly && hasRootPartition( *it ) )
         {
             cDebug() << Logger::SubEntry << "Removing device with root filesystem (/) on it" << it;
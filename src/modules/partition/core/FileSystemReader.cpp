@@ -0,0 +1,756 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "FileSystemReader.h"
+
+#include "utils/Logger.h"
+#include "utils/String.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+
+#include <functional>
+
+namespace FileSystemReader
+{
+
+/// Files larger than this are not read
+static constexpr qint64 maxFileSize = 1024 * 1024;
+/// Directories larger than this are not searched
+static constexpr qint64 maxDirectorySize = 16 * 1024 * 1024;
+
+namespace
+{
+
+/** @brief Reads a little-endian number of type T from @p data at @p offset
+ *
+ * Returns 0 if @p data is too short, so that corrupt structures
+ * do not cause out-of-bounds reads.
+ */
+template < typename T >
+T
+le( const QByteArray& data, qint64 offset )
+{
+    if ( offset < 0 || offset + qint64( sizeof( T ) ) > data.size() )
+    {
+        return 0;
+    }
+    return qFromLittleEndian< T >( reinterpret_cast< const uchar* >( data.constData() + offset ) );
+}
+
+template <>
+quint8
+le< quint8 >( const QByteArray& data, qint64 offset )
+{
+    return offset < 0 || offset >= data.size() ? 0 : quint8( data.at( int( offset ) ) );
+}
+
+/// @brief Read-only access to a block device (or image file)
+class Disk
+{
+public:
+    explicit Disk( const QString& path )
+        : m_file( path )
+    {
+        m_file.open( QIODevice::ReadOnly | QIODevice::Unbuffered );
+    }
+
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /// @brief Reads @p length bytes at @p offset into @p data; returns false on a short read
+    bool read( qint64 offset, qint64 length, QByteArray& data )
+    {
+        if ( offset < 0 || length < 0 || !m_file.seek( offset ) )
+        {
+            return false;
+        }
+        data = m_file.read( length );
+        return data.size() == length;
+    }
+
+private:
+    QFile m_file;
+};
+
+/// @brief The components of an absolute path, e.g. "etc", "fstab"
+QList< QByteArray >
+pathComponents( const QString& filePath )
+{
+    QList< QByteArray > components;
+    for ( const auto& s : filePath.split( '/', SplitSkipEmptyParts ) )
+    {
+        components.append( s.toUtf8() );
+    }
+    return components;
+}
+
+/** @brief ext2, ext3 and ext4
+ *
+ * Supports both extent-mapped and block-mapped (indirect) files,
+ * and files with inline data if they fit in the inode.
+ */
+class ExtFileSystem
+{
+public:
+    explicit ExtFileSystem( Disk& disk )
+        : m_disk( disk )
+    {
+    }
+
+    /// @brief Is there an ext filesystem that this can read?
+    bool open()
+    {
+        QByteArray sb;
+        if ( !m_disk.read( 1024, 1024, sb ) || le< quint16 >( sb, 56 ) != 0xEF53 )
+        {
+            return false;
+        }
+
+        const quint32 logBlockSize = le< quint32 >( sb, 24 );
+        if ( logBlockSize > 6 )
+        {
+            return false;
+        }
+        m_blockSize = 1024u << logBlockSize;
+        m_firstDataBlock = le< quint32 >( sb, 20 );
+        m_inodesPerGroup = le< quint32 >( sb, 40 );
+        m_inodeSize = le< quint32 >( sb, 76 ) >= 1 ? le< quint16 >( sb, 88 ) : 128;
+
+        const quint32 incompat = le< quint32 >( sb, 96 );
+        m_is64Bit = incompat & 0x80;
+        m_descSize = m_is64Bit ? le< quint16 >( sb, 254 ) : 32;
+        if ( incompat & 0x10 )
+        {
+            // Group descriptors after the first meta-group are spread over the disk
+            m_firstMetaGroup = le< quint32 >( sb, 260 );
+        }
+        return m_inodesPerGroup > 0 && m_inodeSize >= 128 && m_descSize >= 32;
+    }
+
+    bool readFile( const QString& filePath, QByteArray& contents )
+    {
+        quint32 inode = 2;  // The root directory
+        QByteArray inodeData;
+        for ( const auto& name : pathComponents( filePath ) )
+        {
+            if ( !readInode( inode, inodeData ) || fileType( inodeData ) != 0x4000 )
+            {
+                return false;
+            }
+            QByteArray directory;
+            if ( !readData( inodeData, maxDirectorySize, directory ) )
+            {
+                return false;
+            }
+            inode = lookup( directory, name );
+            if ( !inode )
+            {
+                return false;
+            }
+        }
+        return readInode( inode, inodeData ) && fileType( inodeData ) == 0x8000
+            && readData( inodeData, maxFileSize, contents );
+    }
+
+private:
+    static quint16 fileType( const QByteArray& inode ) { return le< quint16 >( inode, 0 ) & 0xF000; }
+
+    bool readInode( quint32 inode, QByteArray& data )
+    {
+        if ( inode < 1 )
+        {
+            return false;
+        }
+        const quint32 group = ( inode - 1 ) / m_inodesPerGroup;
+        const quint32 index = ( inode - 1 ) % m_inodesPerGroup;
+        if ( group / ( m_blockSize / m_descSize ) >= m_firstMetaGroup )
+        {
+            return false;
+        }
+
+        QByteArray desc;
+        const qint64 descOffset = qint64( m_firstDataBlock + 1 ) * m_blockSize + qint64( group ) * m_descSize;
+        if ( !m_disk.read( descOffset, m_descSize, desc ) )
+        {
+            return false;
+        }
+        quint64 inodeTable = le< quint32 >( desc, 8 );
+        if ( m_is64Bit && m_descSize >= 64 )
+        {
+            inodeTable |= quint64( le< quint32 >( desc, 0x28 ) ) << 32;
+        }
+        return m_disk.read( qint64( inodeTable ) * m_blockSize + qint64( index ) * m_inodeSize, m_inodeSize, data );
+    }
+
+    /// @brief A run of blocks of a file
+    struct Extent
+    {
+        quint64 logical;  ///< First block in the file
+        quint64 physical;  ///< First block on disk
+        quint32 length;  ///< Number of blocks
+    };
+
+    /// @brief Collects the extents from an extent-tree node @p node
+    bool extentTree( const QByteArray& node, int depth, QVector< Extent >& extents )
+    {
+        if ( le< quint16 >( node, 0 ) != 0xF30A || depth > 5 )
+        {
+            return false;
+        }
+        const int entries = le< quint16 >( node, 2 );
+        const bool isLeaf = le< quint16 >( node, 6 ) == 0;
+        for ( int i = 0; i < entries; ++i )
+        {
+            const int e = 12 + 12 * i;
+            if ( isLeaf )
+            {
+                quint32 length = le< quint16 >( node, e + 4 );
+                if ( length > 32768 )
+                {
+                    // Uninitialized extent, reads as zeroes
+                    continue;
+                }
+                const quint64 start = ( quint64( le< quint16 >( node, e + 6 ) ) << 32 ) | le< quint32 >( node, e + 8 );
+                extents.append( { le< quint32 >( node, e ), start, length } );
+            }
+            else
+            {
+                const quint64 leaf = ( quint64( le< quint16 >( node, e + 8 ) ) << 32 ) | le< quint32 >( node, e + 4 );
+                QByteArray child;
+                if ( !m_disk.read( qint64( leaf ) * m_blockSize, m_blockSize, child )
+                     || !extentTree( child, depth + 1, extents ) )
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /** @brief Collects the blocks referred to by an indirect block
+     *
+     * @p block is the indirect block number, @p level is 1 for
+     * single-indirect, 2 for double, 3 for triple. Block-mapped
+     * files are fragmented anyway, so every block is its own extent.
+     */
+    bool indirect( quint32 block, int level, quint64& logical, quint64 blockCount, QVector< Extent >& extents )
+    {
+        quint64 span = 1;  // Blocks mapped by each pointer in this block
+        for ( int i = 1; i < level; ++i )
+        {
+            span *= m_blockSize / 4;
+        }
+        if ( !block )
+        {
+            // Sparse: skip everything this block would have mapped
+            logical += m_blockSize / 4 * span;
+            return true;
+        }
+        QByteArray pointers;
+        if ( !m_disk.read( qint64( block ) * m_blockSize, m_blockSize, pointers ) )
+        {
+            return false;
+        }
+        for ( quint32 i = 0; i < m_blockSize / 4 && logical < blockCount; ++i )
+        {
+            const quint32 p = le< quint32 >( pointers, 4 * i );
+            if ( level == 1 )
+            {
+                if ( p )
+                {
+                    extents.append( { logical, p, 1 } );
+                }
+                ++logical;
+            }
+            else if ( !indirect( p, level - 1, logical, blockCount, extents ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Reads the contents of the file with inode data @p inode
+    bool readData( const QByteArray& inode, qint64 maxSize, QByteArray& data )
+    {
+        const quint64 size = le< quint32 >( inode, 4 ) | ( quint64( le< quint32 >( inode, 108 ) ) << 32 );
+        if ( size > quint64( maxSize ) )
+        {
+            return false;
+        }
+
+        const quint32 flags = le< quint32 >( inode, 32 );
+        const QByteArray blockMap = inode.mid( 40, 60 );
+        if ( flags & 0x10000000 )
+        {
+            // Inline data; the part that does not fit in the inode is in an xattr
+            if ( size > 60 )
+            {
+                return false;
+            }
+            data = blockMap.left( int( size ) );
+            return true;
+        }
+
+        const quint64 blockCount = ( size + m_blockSize - 1 ) / m_blockSize;
+        QVector< Extent > extents;
+        if ( flags & 0x80000 )
+        {
+            if ( !extentTree( blockMap, 0, extents ) )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            quint64 logical = 0;
+            for ( quint32 i = 0; i < 12 && logical < blockCount; ++i, ++logical )
+            {
+                const quint32 p = le< quint32 >( blockMap, 4 * i );
+                if ( p )
+                {
+                    extents.append( { logical, p, 1 } );
+                }
+            }
+            for ( int level = 1; level <= 3 && logical < blockCount; ++level )
+            {
+                if ( !indirect( le< quint32 >( blockMap, 4 * ( 11 + level ) ), level, logical, blockCount, extents ) )
+                {
+                    return false;
+                }
+            }
+        }
+
+        data = QByteArray( int( size ), '\0' );
+        for ( const auto& e : extents )
+        {
+            const qint64 offset = qint64( e.logical ) * m_blockSize;
+            if ( offset >= qint64( size ) )
+            {
+                continue;
+            }
+            const qint64 length = qMin( qint64( e.length ) * m_blockSize, qint64( size ) - offset );
+            QByteArray run;
+            if ( !m_disk.read( qint64( e.physical ) * m_blockSize, length, run ) )
+            {
+                return false;
+            }
+            data.replace( int( offset ), int( length ), run );
+        }
+        return true;
+    }
+
+    /** @brief Finds @p name in the @p directory contents, returns its inode (or 0)
+     *
+     * Hashed (htree) directories are laid out so that they can be
+     * searched linearly as well.
+     */
+    static quint32 lookup( const QByteArray& directory, const QByteArray& name )
+    {
+        for ( int offset = 0; offset + 8 <= directory.size(); )
+        {
+            const quint32 inode = le< quint32 >( directory, offset );
+            const quint16 recordLength = le< quint16 >( directory, offset + 4 );
+            const quint8 nameLength = le< quint8 >( directory, offset + 6 );
+            if ( recordLength < 8 )
+            {
+                return 0;
+            }
+            if ( inode && nameLength == name.length() && directory.mid( offset + 8, nameLength ) == name )
+            {
+                return inode;
+            }
+            offset += recordLength;
+        }
+        return 0;
+    }
+
+    Disk& m_disk;
+    quint32 m_blockSize = 1024;
+    quint32 m_firstDataBlock = 0;
+    quint32 m_inodesPerGroup = 0;
+    quint32 m_inodeSize = 128;
+    quint32 m_descSize = 32;
+    quint32 m_firstMetaGroup = ~quint32( 0 );
+    bool m_is64Bit = false;
+};
+
+/** @brief btrfs on a single device
+ *
+ * Reads from the default subvolume (which is what mount does
+ * without a subvol option). Compressed files are not supported,
+ * and neither are filesystems with a log tree that needs replaying.
+ */
+class BtrfsFileSystem
+{
+public:
+    explicit BtrfsFileSystem( Disk& disk )
+        : m_disk( disk )
+    {
+    }
+
+    bool open()
+    {
+        QByteArray sb;
+        if ( !m_disk.read( superblockOffset, 4096, sb ) || sb.mid( 0x40, 8 ) != QByteArray( "_BHRfS_M" ) )
+        {
+            return false;
+        }
+        m_rootTree = le< quint64 >( sb, 0x50 );
+        m_nodeSize = le< quint32 >( sb, 0x94 );
+        m_rootDirObjectId = le< quint64 >( sb, 0x80 );
+        m_devid = le< quint64 >( sb, 0xc9 );
+        if ( m_nodeSize < 4096 || m_nodeSize > 65536 )
+        {
+            return false;
+        }
+        // A log tree means the last writes are only there; mount replays it, we can't
+        if ( le< quint64 >( sb, 0x60 ) != 0 )
+        {
+            cDebug() << "btrfs has a log tree to replay, not reading it directly.";
+            return false;
+        }
+
+        // The system chunks in the superblock are enough to read the chunk tree
+        const quint32 sysChunksSize = qMin( le< quint32 >( sb, 0xa0 ), quint32( 0x800 ) );
+        const QByteArray sysChunks = sb.mid( 0x32b, int( sysChunksSize ) );
+        for ( int offset = 0; offset + keySize + chunkItemSize <= sysChunks.size(); )
+        {
+            const Key key = Key::at( sysChunks, offset );
+            const QByteArray chunk = sysChunks.mid( offset + keySize );
+            const int stripes = le< quint16 >( chunk, 44 );
+            if ( stripes < 1 )
+            {
+                return false;
+            }
+            addChunk( key.offset, chunk );
+            offset += keySize + chunkItemSize + stripes * stripeSize;
+        }
+
+        const quint64 chunkTree = le< quint64 >( sb, 0x58 );
+        return forEachItem( chunkTree,
+                            { firstChunkTreeObjectId, chunkItemKey, 0 },
+                            { firstChunkTreeObjectId, chunkItemKey, ~quint64( 0 ) },
+                            [this]( const Key& key, const QByteArray& item ) {
+                                addChunk( key.offset, item );
+                                return true;
+                            } );
+    }
+
+    bool readFile( const QString& filePath, QByteArray& contents )
+    {
+        quint64 fsTree = 0;
+        quint64 inode = 0;
+        if ( !findDefaultSubvolume( fsTree, inode ) )
+        {
+            return false;
+        }
+
+        quint8 type = dirTypeDirectory;
+        for ( const auto& name : pathComponents( filePath ) )
+        {
+            if ( type != dirTypeDirectory || !lookup( fsTree, inode, name, inode, type ) )
+            {
+                return false;
+            }
+        }
+        return type == dirTypeRegularFile && readData( fsTree, inode, contents );
+    }
+
+private:
+    static constexpr qint64 superblockOffset = 0x10000;
+    static constexpr int headerSize = 0x65;
+    static constexpr int keySize = 17;
+    static constexpr int chunkItemSize = 48;
+    static constexpr int stripeSize = 32;
+
+    static constexpr quint64 firstChunkTreeObjectId = 256;
+    static constexpr quint64 fsTreeObjectId = 5;
+    static constexpr quint8 inodeItemKey = 1;
+    static constexpr quint8 dirItemKey = 84;
+    static constexpr quint8 dirIndexKey = 96;
+    static constexpr quint8 extentDataKey = 108;
+    static constexpr quint8 rootItemKey = 132;
+    static constexpr quint8 chunkItemKey = 228;
+    static constexpr quint8 dirTypeRegularFile = 1;
+    static constexpr quint8 dirTypeDirectory = 2;
+
+    struct Key
+    {
+        quint64 objectId;
+        quint8 type;
+        quint64 offset;
+
+        static Key at( const QByteArray& data, int offset )
+        {
+            return { le< quint64 >( data, offset ),
+                     le< quint8 >( data, offset + 8 ),
+                     le< quint64 >( data, offset + 9 ) };
+        }
+        bool operator<( const Key& other ) const
+        {
+            if ( objectId != other.objectId )
+            {
+                return objectId < other.objectId;
+            }
+            if ( type != other.type )
+            {
+                return type < other.type;
+            }
+            return offset < other.offset;
+        }
+    };
+
+    /// @brief Where a range of logical addresses is stored on this device
+    struct Chunk
+    {
+        quint64 logical;
+        quint64 length;
+        quint64 physical;
+    };
+
+    using ItemCallback = std::function< bool( const Key&, const QByteArray& ) >;
+
+    /// @brief Adds the chunk item @p chunk at logical address @p logical, if it is on this device
+    void addChunk( quint64 logical, const QByteArray& chunk )
+    {
+        // RAID0, RAID10, RAID5 and RAID6 spread the data over the stripes;
+        // the others (single, DUP, RAID1*) keep a complete copy in each.
+        if ( le< quint64 >( chunk, 24 ) & ( ( 1 << 3 ) | ( 1 << 6 ) | ( 1 << 7 ) | ( 1 << 8 ) ) )
+        {
+            return;
+        }
+        const int stripes = le< quint16 >( chunk, 44 );
+        for ( int i = 0; i < stripes; ++i )
+        {
+            const int s = chunkItemSize + i * stripeSize;
+            if ( le< quint64 >( chunk, s ) == m_devid )
+            {
+                m_chunks.append( { logical, le< quint64 >( chunk, 0 ), le< quint64 >( chunk, s + 8 ) } );
+                return;
+            }
+        }
+    }
+
+    /// @brief Reads @p length bytes at @p logical address; the range must be in a single chunk
+    bool readLogical( quint64 logical, qint64 length, QByteArray& data )
+    {
+        for ( const auto& c : m_chunks )
+        {
+            if ( c.logical <= logical && logical + quint64( length ) <= c.logical + c.length )
+            {
+                return m_disk.read( qint64( c.physical + ( logical - c.logical ) ), length, data );
+            }
+        }
+        return false;
+    }
+
+    /** @brief Calls @p callback for the items from @p min to @p max in the tree at @p node
+     *
+     * The callback returns false to stop. Returns false if the tree could not be
+     * read (or the callback stopped).
+     */
+    bool forEachItem( quint64 node, const Key& min, const Key& max, const ItemCallback& callback, int depth = 0 )
+    {
+        QByteArray data;
+        if ( depth > 8 || !readLogical( node, m_nodeSize, data ) )
+        {
+            return false;
+        }
+        const quint32 count = le< quint32 >( data, 0x60 );
+        const bool isLeaf = le< quint8 >( data, 0x64 ) == 0;
+        for ( quint32 i = 0; i < count; ++i )
+        {
+            if ( isLeaf )
+            {
+                const int item = headerSize + int( i ) * ( keySize + 8 );
+                const Key key = Key::at( data, item );
+                if ( key < min )
+                {
+                    continue;
+                }
+                if ( max < key )
+                {
+                    return true;
+                }
+                const int itemOffset = headerSize + int( le< quint32 >( data, item + 17 ) );
+                const QByteArray itemData = data.mid( itemOffset, int( le< quint32 >( data, item + 21 ) ) );
+                if ( !callback( key, itemData ) )
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                const int ptr = headerSize + int( i ) * ( keySize + 16 );
+                if ( max < Key::at( data, ptr ) )
+                {
+                    return true;
+                }
+                // The child covers keys up to the next pointer's key
+                if ( i + 1 < count && !( min < Key::at( data, ptr + keySize + 16 ) ) )
+                {
+                    continue;
+                }
+                if ( !forEachItem( le< quint64 >( data, ptr + keySize ), min, max, callback, depth + 1 ) )
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// @brief Finds the tree and root-directory inode of the default subvolume
+    bool findDefaultSubvolume( quint64& fsTree, quint64& rootDir )
+    {
+        quint64 subvolume = fsTreeObjectId;
+        forEachItem( m_rootTree,
+                     { m_rootDirObjectId, dirItemKey, 0 },
+                     { m_rootDirObjectId, dirItemKey, ~quint64( 0 ) },
+                     [&subvolume]( const Key&, const QByteArray& item ) {
+                         if ( item.mid( 30, le< quint16 >( item, 27 ) ) == QByteArray( "default" ) )
+                         {
+                             subvolume = Key::at( item, 0 ).objectId;
+                             return false;
+                         }
+                         return true;
+                     } );
+
+        // There may be more than one root item (e.g. for snapshots), the last one is current
+        fsTree = 0;
+        forEachItem( m_rootTree,
+                     { subvolume, rootItemKey, 0 },
+                     { subvolume, rootItemKey, ~quint64( 0 ) },
+                     [&fsTree, &rootDir]( const Key&, const QByteArray& item ) {
+                         rootDir = le< quint64 >( item, 168 );
+                         fsTree = le< quint64 >( item, 176 );
+                         return true;
+                     } );
+        return fsTree != 0;
+    }
+
+    /// @brief Finds @p name in directory @p dir, sets its @p inode and (directory-entry) @p type
+    bool lookup( quint64 fsTree, quint64 dir, const QByteArray& name, quint64& inode, quint8& type )
+    {
+        bool found = false;
+        forEachItem( fsTree,
+                     { dir, dirIndexKey, 0 },
+                     { dir, dirIndexKey, ~quint64( 0 ) },
+                     [&]( const Key&, const QByteArray& item ) {
+                         if ( item.mid( 30, le< quint16 >( item, 27 ) ) != name )
+                         {
+                             return true;
+                         }
+                         // Subvolumes in the path would need another tree; not supported
+                         const Key location = Key::at( item, 0 );
+                         found = location.type == inodeItemKey;
+                         inode = location.objectId;
+                         type = le< quint8 >( item, 29 );
+                         return false;
+                     } );
+        return found;
+    }
+
+    /// @brief Reads the contents of file @p inode
+    bool readData( quint64 fsTree, quint64 inode, QByteArray& contents )
+    {
+        qint64 size = -1;
+        forEachItem( fsTree,
+                     { inode, inodeItemKey, 0 },
+                     { inode, inodeItemKey, 0 },
+                     [&size]( const Key&, const QByteArray& item ) {
+                         size = qint64( le< quint64 >( item, 16 ) );
+                         return false;
+                     } );
+        if ( size < 0 || size > maxFileSize )
+        {
+            return false;
+        }
+
+        QByteArray data( int( size ), '\0' );
+        bool ok = true;
+        forEachItem( fsTree,
+                     { inode, extentDataKey, 0 },
+                     { inode, extentDataKey, ~quint64( 0 ) },
+                     [&]( const Key& key, const QByteArray& item ) {
+                         if ( le< quint8 >( item, 16 ) || le< quint8 >( item, 17 ) || le< quint16 >( item, 18 ) )
+                         {
+                             // Compressed or encrypted
+                             ok = false;
+                             return false;
+                         }
+                         if ( qint64( key.offset ) >= size )
+                         {
+                             return true;
+                         }
+                         QByteArray extent;
+                         const quint8 extentType = le< quint8 >( item, 20 );
+                         const quint64 diskAddress = le< quint64 >( item, 21 );
+                         if ( extentType == 0 )
+                         {
+                             extent = item.mid( 21 );
+                         }
+                         else if ( extentType == 1 && diskAddress )
+                         {
+                             const qint64 length
+                                 = qMin( qint64( le< quint64 >( item, 45 ) ), size - qint64( key.offset ) );
+                             if ( !readLogical( diskAddress + le< quint64 >( item, 37 ), length, extent ) )
+                             {
+                                 ok = false;
+                                 return false;
+                             }
+                         }
+                         // Holes and preallocated extents read as zeroes
+                         const int length = int( qMin( qint64( extent.size() ), size - qint64( key.offset ) ) );
+                         data.replace( int( key.offset ), length, extent.left( length ) );
+                         return true;
+                     } );
+        if ( ok )
+        {
+            contents = data;
+        }
+        return ok;
+    }
+
+    Disk& m_disk;
+    quint64 m_rootTree = 0;
+    quint64 m_rootDirObjectId = 6;
+    quint64 m_devid = 0;
+    quint32 m_nodeSize = 16384;
+    QVector< Chunk > m_chunks;
+};
+
+}  // namespace
+
+bool
+readFile( const QString& devicePath, const QString& filePath, QByteArray& contents )
+{
+    Disk disk( devicePath );
+    if ( !disk.isOpen() )
+    {
+        return false;
+    }
+
+    ExtFileSystem ext( disk );
+    if ( ext.open() )
+    {
+        return ext.readFile( filePath, contents );
+    }
+    BtrfsFileSystem btrfs( disk );
+    if ( btrfs.open() )
+    {
+        return btrfs.readFile( filePath, contents );
+    }
+    return false;
+}
+
+}  // namespace FileSystemReader
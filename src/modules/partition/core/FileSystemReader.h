@@ -0,0 +1,44 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITION_FILESYSTEMREADER_H
+#define PARTITION_FILESYSTEMREADER_H
+
+#include <QByteArray>
+#include <QString>
+
+/** @brief Read files from a filesystem without mounting it
+ *
+ * Mounting a partition just to look at one small file (e.g. /etc/fstab
+ * when matching os-prober results) costs a handful of processes and
+ * waits for udev. For the common filesystems, the file can be found
+ * by reading the filesystem structures straight from the block device.
+ *
+ * Only the simple cases are handled: ext2/3/4 and single-device btrfs
+ * (reading from the default subvolume, without compression, and not
+ * if there is a log tree that mounting would replay). When
+ * readFile() returns false, mount the filesystem and read the
+ * file from there instead.
+ */
+namespace FileSystemReader
+{
+/** @brief Reads the file at @p filePath in the filesystem on @p devicePath
+ *
+ * The @p filePath is absolute within the filesystem (e.g. "/etc/fstab").
+ * Symbolic links are not followed. @p devicePath may also be a filesystem
+ * image. Files larger than 1MiB are not read.
+ *
+ * Returns @c true, and sets @p contents, if the file was read. Returns
+ * @c false if the filesystem is not supported (or the file is not found).
+ */
+bool readFile( const QString& devicePath, const QString& filePath, QByteArray& contents );
+
+}  // namespace FileSystemReader
+
+#endif
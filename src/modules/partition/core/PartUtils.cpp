@@ -12,6 +12,7 @@
 #include "PartUtils.h"
 
 #include "core/DeviceModel.h"
+#include "core/FileSystemReader.h"
 #include "core/KPMHelpers.h"
 #include "core/PartitionInfo.h"
 
@@ -21,6 +22,7 @@
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/HostInfo.h"
 #include "utils/Logger.h"
 
 #include <kpmcore/backend/corebackend.h>
@@ -28,6 +30,10 @@
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
 
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QProcess>
 #include <QTemporaryDir>
 
@@ -116,33 +122,42 @@ canBeReplaced( Partition* candidate )
 }
 
 
-bool
-canBeResized( Partition* candidate )
+static QMutex s_resizeCacheMutex;
+/** @brief Cache of canBeResized() results
+ *
+ * Partitions are changed, deleted and re-created (possibly at the same
+ * address) only by PartitionCoreModule, which empties the cache
+ * whenever it does so, @see clearResizeCache().
+ */
+static QHash< Partition*, bool > s_resizeCache;
+
+/** @brief Does the actual checks for canBeResized()
+ *
+ * Logs the reason why @p candidate can or cannot be resized.
+ */
+static bool
+checkResize( Partition* candidate )
 {
-    if ( !candidate )
-    {
-        cDebug() << "Partition* is NULL";
+    const QString name = convenienceName( candidate );
+    auto no = []( const QString& reason ) {
+        cDebug() << Logger::SubEntry << "NO," << reason;
         return false;
-    }
+    };
 
-    cDebug() << "Checking if" << convenienceName( candidate ) << "can be resized.";
+    cDebug() << "Checking if" << name << "can be resized.";
     if ( !candidate->fileSystem().supportGrow() || !candidate->fileSystem().supportShrink() )
     {
-        cDebug() << Logger::SubEntry << "NO, filesystem" << candidate->fileSystem().name()
-                 << "does not support resize.";
-        return false;
+        return no( QStringLiteral( "filesystem %1 does not support resize." ).arg( candidate->fileSystem().name() ) );
     }
 
     if ( isPartitionFreeSpace( candidate ) )
     {
-        cDebug() << Logger::SubEntry << "NO, partition is free space";
-        return false;
+        return no( QStringLiteral( "partition is free space" ) );
     }
 
     if ( candidate->isMounted() )
     {
-        cDebug() << Logger::SubEntry << "NO, partition is mounted";
-        return false;
+        return no( QStringLiteral( "partition is mounted" ) );
     }
 
     if ( candidate->roles().has( PartitionRole::Primary ) )
@@ -150,15 +165,13 @@ canBeResized( Partition* candidate )
         PartitionTable* table = dynamic_cast< PartitionTable* >( candidate->parent() );
         if ( !table )
         {
-            cDebug() << Logger::SubEntry << "NO, no partition table found";
-            return false;
+            return no( QStringLiteral( "no partition table found" ) );
         }
 
         if ( table->numPrimaries() >= table->maxPrimaries() )
         {
-            cDebug() << Logger::SubEntry << "NO, partition table already has" << table->maxPrimaries()
-                     << "primary partitions.";
-            return false;
+            return no(
+                QStringLiteral( "partition table already has %1 primary partitions." ).arg( table->maxPrimaries() ) );
         }
     }
 
@@ -166,8 +179,7 @@ canBeResized( Partition* candidate )
     double requiredStorageGiB = getRequiredStorageGiB( ok );
     if ( !ok )
     {
-        cDebug() << Logger::SubEntry << "NO, requiredStorageGiB is not set correctly.";
-        return false;
+        return no( QStringLiteral( "requiredStorageGiB is not set correctly." ) );
     }
 
     // We require a little more for partitioning overhead and swap file
@@ -177,7 +189,7 @@ canBeResized( Partition* candidate )
 
     if ( availableStorageB > advisedStorageB )
     {
-        cDebug() << "Partition" << convenienceName( candidate ) << "authorized for resize + autopartition install.";
+        cDebug() << "Partition" << name << "authorized for resize + autopartition install.";
         return true;
     }
     else
@@ -187,13 +199,41 @@ canBeResized( Partition* candidate )
         deb << Logger::Continuation << "Required  storage B:" << advisedStorageB
             << QString( "(%1GiB)" ).arg( advisedStorageGiB );
         deb << Logger::Continuation << "Available storage B:" << availableStorageB
-            << QString( "(%1GiB)" ).arg( CalamaresUtils::BytesToGiB( availableStorageB ) ) << "for"
-            << convenienceName( candidate ) << "length:" << candidate->length()
-            << "sectorsUsed:" << candidate->sectorsUsed() << "fsType:" << candidate->fileSystem().name();
+            << QString( "(%1GiB)" ).arg( CalamaresUtils::BytesToGiB( availableStorageB ) ) << "for" << name
+            << "length:" << candidate->length() << "sectorsUsed:" << candidate->sectorsUsed()
+            << "fsType:" << candidate->fileSystem().name();
         return false;
     }
 }
 
+bool
+canBeResized( Partition* candidate )
+{
+    if ( !candidate )
+    {
+        cDebug() << "Partition* is NULL";
+        return false;
+    }
+
+    QMutexLocker lock( &s_resizeCacheMutex );
+    auto it = s_resizeCache.constFind( candidate );
+    if ( it != s_resizeCache.constEnd() )
+    {
+        return *it;
+    }
+    // The checks are done (and logged) only once per partition
+    const bool verdict = checkResize( candidate );
+    s_resizeCache.insert( candidate, verdict );
+    return verdict;
+}
+
+void
+clearResizeCache()
+{
+    QMutexLocker lock( &s_resizeCacheMutex );
+    s_resizeCache.clear();
+}
+
 
 bool
 canBeResized( DeviceModel* dm, const QString& partitionPath )
@@ -219,10 +259,36 @@ canBeResized( DeviceModel* dm, const QString& partitionPath )
 }
 
 
+static FstabEntryList
+parseFstab( const QByteArray& contents )
+{
+    FstabEntryList fstabEntries;
+    const QStringList fstabLines = QString::fromLocal8Bit( contents ).split( '\n' );
+    for ( const QString& rawLine : fstabLines )
+    {
+        fstabEntries.append( FstabEntry::fromEtcFstab( rawLine ) );
+    }
+    cDebug() << Logger::SubEntry << "got" << fstabEntries.count() << "lines.";
+    fstabEntries.erase(
+        std::remove_if( fstabEntries.begin(), fstabEntries.end(), []( const FstabEntry& x ) { return !x.isValid(); } ),
+        fstabEntries.end() );
+    cDebug() << Logger::SubEntry << "got" << fstabEntries.count() << "fstab entries.";
+    return fstabEntries;
+}
+
 static FstabEntryList
 lookForFstabEntries( const QString& partitionPath )
 {
+    // Most filesystems can be read directly, which is a lot cheaper than mounting
+    QByteArray contents;
+    if ( FileSystemReader::readFile( partitionPath, QStringLiteral( "/etc/fstab" ), contents ) )
+    {
+        cDebug() << "Read fstab directly from" << partitionPath;
+        return parseFstab( contents );
+    }
+
     QStringList mountOptions { "ro" };
+    QString fstype;
 
     auto r = CalamaresUtils::System::runCommand( CalamaresUtils::System::RunLocation::RunInHost,
                                                  { "blkid", "-s", "TYPE", "-o", "value", partitionPath } );
@@ -232,7 +298,7 @@ lookForFstabEntries( const QString& partitionPath )
     }
     else
     {
-        QString fstype = r.getOutput().trimmed();
+        fstype = r.getOutput().trimmed();
         if ( ( fstype == "ext3" ) || ( fstype == "ext4" ) )
         {
             mountOptions.append( "noload" );
@@ -243,7 +309,7 @@ lookForFstabEntries( const QString& partitionPath )
 
     FstabEntryList fstabEntries;
 
-    CalamaresUtils::Partition::TemporaryMount mount( partitionPath, QString(), mountOptions.join( ',' ) );
+    CalamaresUtils::Partition::TemporaryMount mount( partitionPath, fstype, mountOptions.join( ',' ) );
     if ( mount.isValid() )
     {
         QFile fstabFile( mount.path() + "/etc/fstab" );
@@ -252,17 +318,8 @@ lookForFstabEntries( const QString& partitionPath )
 
         if ( fstabFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
         {
-            const QStringList fstabLines = QString::fromLocal8Bit( fstabFile.readAll() ).split( '\n' );
-
-            for ( const QString& rawLine : fstabLines )
-            {
-                fstabEntries.append( FstabEntry::fromEtcFstab( rawLine ) );
-            }
+            fstabEntries = parseFstab( fstabFile.readAll() );
             fstabFile.close();
-            cDebug() << Logger::SubEntry << "got" << fstabEntries.count() << "lines.";
-            std::remove_if(
-                fstabEntries.begin(), fstabEntries.end(), []( const FstabEntry& x ) { return !x.isValid(); } );
-            cDebug() << Logger::SubEntry << "got" << fstabEntries.count() << "fstab entries.";
         }
         else
         {
@@ -290,7 +347,6 @@ findPartitionPathForMountPoint( const FstabEntryList& fstab, const QString& moun
     {
         if ( entry.mountPoint == mountPoint )
         {
-            QProcess readlink;
             QString partPath;
 
             if ( entry.partitionNode.startsWith( "/dev" ) )  // plain dev node
@@ -330,20 +386,8 @@ findPartitionPathForMountPoint( const FstabEntryList& fstab, const QString& moun
 
             if ( partPath.startsWith( "/dev/disk/by-" ) )  // we got a fancy node
             {
-                readlink.start( "readlink", { "-en", partPath } );
-                if ( !readlink.waitForStarted( 1000 ) )
-                {
-                    return QString();
-                }
-                if ( !readlink.waitForFinished( 1000 ) )
-                {
-                    return QString();
-                }
-                if ( readlink.exitCode() != 0 || readlink.exitStatus() != QProcess::NormalExit )
-                {
-                    return QString();
-                }
-                partPath = QString::fromLocal8Bit( readlink.readAllStandardOutput() ).trimmed();
+                // Like readlink -e, this is empty if the link (or its target) does not exist
+                partPath = QFileInfo( partPath ).canonicalFilePath();
             }
 
             return partPath;
@@ -433,7 +477,7 @@ runOsprober( DeviceModel* dm )
 bool
 isEfiSystem()
 {
-    return QDir( "/sys/firmware/efi/efivars" ).exists();
+    return CalamaresUtils::hostInfo().isEfi;
 }
 
 bool
@@ -50,9 +50,20 @@ bool canBeReplaced( Partition* candidate );
  * for resizing (shrinking) it to make room for a new OS.
  * @param candidate the candidate partition to resize.
  * @return true if the criteria are met, otherwise false.
+ *
+ * The result is remembered per partition, until clearResizeCache()
+ * is called; the reason why is logged the first time only.
  */
 bool canBeResized( Partition* candidate );
 
+/**
+ * @brief Forget earlier results of canBeResized()
+ *
+ * PartitionCoreModule calls this whenever partitions change (or may
+ * be deleted), and when the configuration (global storage) changes.
+ */
+void clearResizeCache();
+
 /**
  * @brief canBeReplaced checks whether the given Partition satisfies the criteria
  * for resizing (shrinking) it to make room for a new OS.
@@ -72,6 +83,8 @@ OsproberEntryList runOsprober( DeviceModel* dm );
 
 /**
  * @brief Is this system EFI-enabled? Decides based on /sys/firmware/efi
+ *
+ * That is checked only once, @see CalamaresUtils::hostInfo()
  */
 bool isEfiSystem();
 
@@ -15,6 +15,7 @@
 
 #include "core/BootLoaderModel.h"
 #include "core/ColorUtils.h"
+#include "core/Config.h"
 #include "core/DeviceList.h"
 #include "core/DeviceModel.h"
 #include "core/KPMHelpers.h"
@@ -30,6 +31,7 @@
 #include "jobs/DeletePartitionJob.h"
 #include "jobs/FillGlobalStorageJob.h"
 #include "jobs/FormatPartitionJob.h"
+#include "jobs/ParallelDevicesJob.h"
 #include "jobs/RemoveVolumeGroupJob.h"
 #include "jobs/ResizePartitionJob.h"
 #include "jobs/ResizeVolumeGroupJob.h"
@@ -38,6 +40,8 @@
 #ifdef DEBUG_PARTITION_LAME
 #include "JobExample.h"
 #endif
+#include "GlobalStorage.h"
+#include "JobQueue.h"
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
 #include "utils/Logger.h"
@@ -69,6 +73,8 @@ using CalamaresUtils::Partition::PartitionIterator;
 PartitionCoreModule::RefreshHelper::RefreshHelper( PartitionCoreModule* module )
     : m_module( module )
 {
+    // Partitions are about to change, or be deleted and re-created
+    PartUtils::clearResizeCache();
 }
 
 PartitionCoreModule::RefreshHelper::~RefreshHelper()
@@ -233,6 +239,13 @@ PartitionCoreModule::PartitionCoreModule( QObject* parent )
     {
         qFatal( "Failed to initialize KPMcore backend" );
     }
+    // canBeResized() depends on the configuration, e.g. requiredStorageGiB
+    Calamares::GlobalStorage* gs
+        = Calamares::JobQueue::instance() ? Calamares::JobQueue::instance()->globalStorage() : nullptr;
+    if ( gs )
+    {
+        connect( gs, &Calamares::GlobalStorage::changed, this, &PartUtils::clearResizeCache );
+    }
 }
 
 
@@ -578,19 +591,52 @@ PartitionCoreModule::jobs( const Config* config ) const
 
     lst << Calamares::job_ptr( new ClearTempMountsJob() );
 
+    // One job for all the devices, so that the system is only inspected once
+    QList< Device* > dirtyDevices;
     for ( auto info : m_deviceInfos )
     {
         if ( info->isDirty() )
         {
-            lst << Calamares::job_ptr( new ClearMountsJob( info->device.data() ) );
+            dirtyDevices << info->device.data();
         }
     }
+    if ( !dirtyDevices.isEmpty() )
+    {
+        lst << Calamares::job_ptr( new ClearMountsJob( dirtyDevices ) );
+    }
 
+    // Disks do not depend on each other, so they can be partitioned at the same
+    // time; other devices (e.g. LVM volume groups) depend on the disks before them.
+    QList< Calamares::JobList > diskJobs;
+    auto flushDiskJobs = [&lst, &diskJobs]() {
+        if ( diskJobs.count() > 1 )
+        {
+            lst << Calamares::job_ptr( new ParallelDevicesJob( diskJobs ) );
+        }
+        else if ( diskJobs.count() == 1 )
+        {
+            lst << diskJobs.first();
+        }
+        diskJobs.clear();
+    };
     for ( auto info : m_deviceInfos )
     {
-        lst << info->jobs();
+        const Calamares::JobList& deviceJobs = info->jobs();
+        if ( config && config->parallelDevices() && info->device->type() == Device::Type::Disk_Device )
+        {
+            if ( !deviceJobs.isEmpty() )
+            {
+                diskJobs.append( deviceJobs );
+            }
+        }
+        else
+        {
+            flushDiskJobs();
+            lst << deviceJobs;
+        }
         devices << info->device.data();
     }
+    flushDiskJobs();
     lst << Calamares::job_ptr( new FillGlobalStorageJob( config, devices, m_bootLoaderInstallPath ) );
 
     return lst;
@@ -659,9 +705,8 @@ PartitionCoreModule::osproberEntries() const
 void
 PartitionCoreModule::refreshPartition( Device* device, Partition* )
 {
-    // Keep it simple for now: reset the model. This can be improved to cause
-    // the model to emit dataChanged() for the affected row instead, avoiding
-    // the loss of the current selection.
+    // The model works out which rows have changed, so this
+    // keeps the current selection.
     auto model = partitionModelForDevice( device );
     Q_ASSERT( model );
     OperationHelper helper( model, this );
@@ -670,6 +715,7 @@ PartitionCoreModule::refreshPartition( Device* device, Partition* )
 void
 PartitionCoreModule::refreshAfterModelChange()
 {
+    PartUtils::clearResizeCache();
     updateHasRootMountPoint();
     updateIsDirty();
     m_bootLoaderModel->update();
@@ -929,6 +975,8 @@ PartitionCoreModule::revert()
     QMutexLocker locker( &m_revertMutex );
     qDeleteAll( m_deviceInfos );
     m_deviceInfos.clear();
+    // All the partitions are gone, so are the reasons to remember them
+    PartUtils::clearResizeCache();
     doInit();
     updateIsDirty();
     emit reverted();
@@ -986,6 +1034,8 @@ PartitionCoreModule::revertDevice( Device* dev, bool individualRevert )
     CoreBackend* backend = CoreBackendManager::self()->backend();
     Device* newDev = backend->scanDevice( devInfo->device->deviceNode() );
     devInfo->device.reset( newDev );
+    // The old partitions are gone, and their addresses may be re-used
+    PartUtils::clearResizeCache();
     devInfo->partitionModel->init( newDev, m_osproberLines );
 
     m_deviceModel->swapDevice( dev, newDev );
@@ -29,6 +29,7 @@
 
 // Qt
 #include <QColor>
+#include <QHash>
 
 using CalamaresUtils::Partition::isPartitionFreeSpace;
 using CalamaresUtils::Partition::isPartitionNew;
@@ -38,16 +39,15 @@ PartitionModel::ResetHelper::ResetHelper( PartitionModel* model )
     : m_model( model )
 {
     m_model->m_lock.lock();
-    m_model->beginResetModel();
 }
 
 PartitionModel::ResetHelper::~ResetHelper()
 {
-    // We need to unlock the mutex before emitting the reset signal,
-    // because the reset will cause clients to start looking at the
+    // We need to unlock the mutex before emitting the change signals,
+    // because those will cause clients to start looking at the
     // (new) data.
     m_model->m_lock.unlock();
-    m_model->endResetModel();
+    m_model->sync();
 }
 
 //- PartitionModel -----------------------------------------
@@ -57,6 +57,11 @@ PartitionModel::PartitionModel( QObject* parent )
 {
 }
 
+PartitionModel::~PartitionModel()
+{
+    deleteChildren( &m_root );
+}
+
 void
 PartitionModel::init( Device* device, const OsproberEntryList& osproberEntries )
 {
@@ -64,9 +69,238 @@ PartitionModel::init( Device* device, const OsproberEntryList& osproberEntries )
     beginResetModel();
     m_device = device;
     m_osproberEntries = osproberEntries;
+    deleteChildren( &m_root );
+    addChildren( &m_root, m_device ? m_device->partitionTable() : nullptr );
     endResetModel();
 }
 
+/** @brief Identifies a partition within its parent
+ *
+ * Siblings don't overlap, so the first sector tells them apart. The
+ * roles are included so that, e.g., free space that gets a new partition
+ * created in it is a different row.
+ */
+PartitionModel::Key
+PartitionModel::keyOf( const Partition* partition )
+{
+    return qMakePair( partition->firstSector(), static_cast< int >( partition->roles().roles() ) );
+}
+
+static QList< Partition* >
+childrenOf( PartitionNode* deviceNode )
+{
+    return deviceNode ? deviceNode->children() : QList< Partition* >();
+}
+
+PartitionModel::Node*
+PartitionModel::createNode( Partition* partition, Node* parent )
+{
+    Node* node = new Node;
+    node->key = keyOf( partition );
+    node->partition = partition;
+    node->parent = parent;
+    addChildren( node, partition );
+    return node;
+}
+
+void
+PartitionModel::addChildren( Node* node, PartitionNode* deviceNode )
+{
+    for ( auto* p : childrenOf( deviceNode ) )
+    {
+        node->children.append( createNode( p, node ) );
+    }
+    renumber( node );
+}
+
+void
+PartitionModel::renumber( Node* node, int first )
+{
+    for ( int i = first; i < node->children.count(); ++i )
+    {
+        node->children.at( i )->row = i;
+    }
+}
+
+void
+PartitionModel::deleteChildren( Node* node )
+{
+    for ( auto* child : node->children )
+    {
+        deleteChildren( child );
+        delete child;
+    }
+    node->children.clear();
+}
+
+void
+PartitionModel::forget( Node* node )
+{
+    node->partition = nullptr;
+    for ( auto* child : node->children )
+    {
+        forget( child );
+    }
+}
+
+bool
+PartitionModel::match( Node* node, PartitionNode* deviceNode )
+{
+    const QList< Partition* > newList = childrenOf( deviceNode );
+    QHash< Key, int > newRows;
+    for ( int i = 0; i < newList.count(); ++i )
+    {
+        const auto key = keyOf( newList.at( i ) );
+        if ( newRows.contains( key ) )
+        {
+            return false;
+        }
+        newRows.insert( key, i );
+    }
+
+    int previousRow = -1;
+    for ( auto* child : node->children )
+    {
+        // The old partition may have been deleted, so use the key
+        const int row = child->partition ? newRows.value( child->key, -1 ) : -1;
+        // Partitions are kept in sector order, so a surviving row never moves;
+        // two old rows that match the same new one can't be told apart.
+        if ( row >= 0 && row <= previousRow )
+        {
+            return false;
+        }
+        if ( row < 0 )
+        {
+            forget( child );
+            continue;
+        }
+        previousRow = row;
+        child->partition = newList.at( row );
+        if ( !match( child, child->partition ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+PartitionModel::sync()
+{
+    bool canDiff = false;
+    {
+        // Partitions that are no longer in the device may have been deleted,
+        // so from here on they are not valid in the model (even though their
+        // rows are still there until they are removed).
+        QMutexLocker lock( &m_lock );
+        canDiff = match( &m_root, m_device ? m_device->partitionTable() : nullptr );
+    }
+    if ( !canDiff )
+    {
+        beginResetModel();
+        {
+            QMutexLocker lock( &m_lock );
+            deleteChildren( &m_root );
+            addChildren( &m_root, m_device ? m_device->partitionTable() : nullptr );
+        }
+        endResetModel();
+        return;
+    }
+
+    syncChildren( &m_root, m_device ? m_device->partitionTable() : nullptr );
+    emit partitionsChanged();
+}
+
+QModelIndex
+PartitionModel::indexForNode( Node* node ) const
+{
+    if ( !node || !node->parent )
+    {
+        return QModelIndex();
+    }
+    return createIndex( node->row, 0, node );
+}
+
+PartitionModel::Node*
+PartitionModel::nodeForIndex( const QModelIndex& index ) const
+{
+    return index.isValid() ? static_cast< Node* >( index.internalPointer() ) : const_cast< Node* >( &m_root );
+}
+
+void
+PartitionModel::syncChildren( Node* node, PartitionNode* deviceNode )
+{
+    const QModelIndex parentIndex = indexForNode( node );
+    auto& children = node->children;
+
+    // Remove the rows that are gone, from the end so that row numbers stay valid
+    for ( int last = children.count() - 1; last >= 0; )
+    {
+        if ( children.at( last )->partition )
+        {
+            --last;
+            continue;
+        }
+        int first = last;
+        while ( first > 0 && !children.at( first - 1 )->partition )
+        {
+            --first;
+        }
+
+        beginRemoveRows( parentIndex, first, last );
+        for ( int i = first; i <= last; ++i )
+        {
+            deleteChildren( children.at( i ) );
+            delete children.at( i );
+        }
+        children.remove( first, last - first + 1 );
+        renumber( node, first );
+        endRemoveRows();
+        last = first - 1;
+    }
+    const QVector< Node* > survivors = children;
+
+    // Insert the new rows; the remaining ones are in the right order already
+    const QList< Partition* > newList = childrenOf( deviceNode );
+    int row = 0;
+    for ( int first = 0; first < newList.count(); )
+    {
+        if ( row < children.count() && children.at( row )->partition == newList.at( first ) )
+        {
+            ++row;
+            ++first;
+            continue;
+        }
+        int last = first;
+        while ( last + 1 < newList.count()
+                && !( row < children.count() && children.at( row )->partition == newList.at( last + 1 ) ) )
+        {
+            ++last;
+        }
+
+        beginInsertRows( parentIndex, row, row + last - first );
+        const int firstInserted = row;
+        for ( int i = first; i <= last; ++i )
+        {
+            // New partitions come with their children
+            children.insert( row++, createNode( newList.at( i ), node ) );
+        }
+        renumber( node, firstInserted );
+        endInsertRows();
+        first = last + 1;
+    }
+
+    // The partitions that were already there may have changed in any way
+    if ( !survivors.isEmpty() )
+    {
+        emit dataChanged( index( 0, 0, parentIndex ), index( children.count() - 1, ColumnCount - 1, parentIndex ) );
+    }
+    for ( auto* child : survivors )
+    {
+        syncChildren( child, child->partition );
+    }
+}
+
 int
 PartitionModel::columnCount( const QModelIndex& ) const
 {
@@ -76,26 +310,20 @@ PartitionModel::columnCount( const QModelIndex& ) const
 int
 PartitionModel::rowCount( const QModelIndex& parent ) const
 {
-    Partition* parentPartition = partitionForIndex( parent );
-    if ( parentPartition )
+    if ( parent.column() > 0 )
     {
-        return parentPartition->children().count();
+        return 0;
     }
-    PartitionTable* table = m_device->partitionTable();
-    return table ? table->children().count() : 0;
+    // This does not use partitionForIndex(), since rows may be
+    // counted while the partition is being removed.
+    return nodeForIndex( parent )->children.count();
 }
 
 QModelIndex
 PartitionModel::index( int row, int column, const QModelIndex& parent ) const
 {
-    PartitionNode* parentPartition = parent.isValid() ? static_cast< PartitionNode* >( partitionForIndex( parent ) )
-                                                      : static_cast< PartitionNode* >( m_device->partitionTable() );
-    if ( !parentPartition )
-    {
-        return QModelIndex();
-    }
-    auto lst = parentPartition->children();
-    if ( row < 0 || row >= lst.count() )
+    const Node* parentNode = nodeForIndex( parent );
+    if ( row < 0 || row >= parentNode->children.count() )
     {
         return QModelIndex();
     }
@@ -103,8 +331,7 @@ PartitionModel::index( int row, int column, const QModelIndex& parent ) const
     {
         return QModelIndex();
     }
-    Partition* partition = parentPartition->children().at( row );
-    return createIndex( row, column, partition );
+    return createIndex( row, column, parentNode->children.at( row ) );
 }
 
 QModelIndex
@@ -114,28 +341,7 @@ PartitionModel::parent( const QModelIndex& child ) const
     {
         return QModelIndex();
     }
-    Partition* partition = partitionForIndex( child );
-    if ( !partition )
-    {
-        return QModelIndex();
-    }
-    PartitionNode* parentNode = partition->parent();
-    if ( parentNode == m_device->partitionTable() )
-    {
-        return QModelIndex();
-    }
-
-    int row = 0;
-    for ( auto p : m_device->partitionTable()->children() )
-    {
-        if ( parentNode == p )
-        {
-            return createIndex( row, 0, parentNode );
-        }
-        ++row;
-    }
-    cWarning() << "No parent found!";
-    return QModelIndex();
+    return indexForNode( nodeForIndex( child )->parent );
 }
 
 QVariant
@@ -314,7 +520,7 @@ PartitionModel::partitionForIndex( const QModelIndex& index ) const
     {
         return nullptr;
     }
-    return reinterpret_cast< Partition* >( index.internalPointer() );
+    return nodeForIndex( index )->partition;
 }
 
 
@@ -15,6 +15,8 @@
 // Qt
 #include <QAbstractItemModel>
 #include <QMutex>
+#include <QPair>
+#include <QVector>
 
 class Device;
 class Partition;
@@ -33,6 +35,16 @@ class PartitionNode;
  * the PartitionModel::ResetHelper class to wrap changes.
  *
  * This is what PartitionCoreModule does when it create jobs.
+ *
+ * The model keeps its own copy of the tree of partitions (as the views
+ * have last seen it). After a change, the old and new trees are compared
+ * and the views are told which rows were removed or inserted; all other
+ * rows are reported as changed. Views keep their state (e.g. selection
+ * and expanded items) for partitions that survive the change.
+ *
+ * KPMcore deletes and re-creates partitions (e.g. all the unallocated
+ * ones) on every change, and their addresses get re-used, so rows are
+ * matched by first sector and roles rather than by pointer.
  */
 class PartitionModel : public QAbstractItemModel
 {
@@ -40,9 +52,9 @@ class PartitionModel : public QAbstractItemModel
 public:
     /**
      * This helper class must be instantiated on the stack *before* making
-     * changes to the device represented by this model. It will cause the model
-     * to emit modelAboutToBeReset() when instantiated and modelReset() when
-     * destructed.
+     * changes to the device represented by this model. When it is
+     * destructed, the model compares the partitions with the ones it
+     * had before, and emits signals for removed, inserted and changed rows.
      */
     class ResetHelper
     {
@@ -85,6 +97,7 @@ public:
     };
 
     PartitionModel( QObject* parent = nullptr );
+    ~PartitionModel() override;
     /**
      * device must remain alive for the life of PartitionModel
      */
@@ -104,12 +117,59 @@ public:
 
     void update();
 
+signals:
+    /** @brief The partitions have changed
+     *
+     * This is emitted after the changes made while a ResetHelper was
+     * alive have been signalled row-by-row. If the rows could not be
+     * matched up, the model is reset instead (and modelReset() is
+     * emitted instead of this signal).
+     */
+    void partitionsChanged();
+
 private:
     friend class ResetHelper;
 
+    /// @brief First sector and roles, which identify a partition among its siblings
+    using Key = QPair< qint64, int >;
+    static Key keyOf( const Partition* partition );
+
+    /// @brief A row of the model; indexes point to these
+    struct Node
+    {
+        Key key;
+        Partition* partition = nullptr;  ///< nullptr once it is gone from the device
+        Node* parent = nullptr;  ///< nullptr for the root (the partition table)
+        int row = -1;  ///< Index in the parent's children
+        QVector< Node* > children;
+    };
+
+    static Node* createNode( Partition* partition, Node* parent );
+    /// @brief Adds a node for each partition in @p deviceNode (recursively)
+    static void addChildren( Node* node, PartitionNode* deviceNode );
+    static void deleteChildren( Node* node );
+    /// @brief Updates the row of the children of @p node, from row @p first on
+    static void renumber( Node* node, int first = 0 );
+    /// @brief Marks @p node and everything below it as gone from the device
+    static void forget( Node* node );
+
+    /** @brief Points the nodes below @p node to the partitions in @p deviceNode
+     *
+     * Nodes without a partition any more are forgotten. Returns @c false
+     * if the rows can't be matched up (then the model must be reset).
+     */
+    bool match( Node* node, PartitionNode* deviceNode );
+    /// @brief Replaces the model's tree with the device's, emitting fine-grained signals
+    void sync();
+    void syncChildren( Node* node, PartitionNode* deviceNode );
+    QModelIndex indexForNode( Node* node ) const;
+    Node* nodeForIndex( const QModelIndex& index ) const;
+
     Device* m_device;
     OsproberEntryList m_osproberEntries;
     mutable QMutex m_lock;
+
+    Node m_root;  ///< The partitions as the views know them
 };
 
 #endif /* PARTITIONMODEL_H */
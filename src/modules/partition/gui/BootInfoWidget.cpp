@@ -38,8 +38,11 @@ BootInfoWidget::BootInfoWidget( QWidget* parent )
 
     m_bootIcon->setMargin( 0 );
     m_bootIcon->setFixedSize( iconSize );
-    m_bootIcon->setPixmap(
-        CalamaresUtils::defaultPixmap( CalamaresUtils::BootEnvironment, CalamaresUtils::Original, iconSize ) );
+    CalamaresUtils::defaultPixmapAsync( CalamaresUtils::BootEnvironment,
+                                        CalamaresUtils::Original,
+                                        iconSize,
+                                        m_bootIcon,
+                                        [this]( const QPixmap& pixmap ) { m_bootIcon->setPixmap( pixmap ); } );
 
     QFontMetrics fm = QFontMetrics( QFont() );
     m_bootLabel->setMinimumWidth( fm.boundingRect( "BIOS" ).width() + CalamaresUtils::defaultFontHeight() / 2 );
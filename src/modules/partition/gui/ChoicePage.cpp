@@ -196,6 +196,16 @@ createCombo( const QSet< SwapChoice >& s, SwapChoice dflt )
     return box;
 }
 
+/** @brief Sets the icon of @p button once it is rendered in the background */
+static void
+setIconAsync( PrettyRadioButton* button, CalamaresUtils::ImageType type, const QSize& iconSize )
+{
+    CalamaresUtils::defaultPixmapAsync(
+        type, CalamaresUtils::Original, iconSize, button, [button]( const QPixmap& pixmap ) {
+            button->setIcon( pixmap );
+        } );
+}
+
 /**
  * @brief ChoicePage::setupChoices creates PrettyRadioButton objects for the action
  *      choices.
@@ -228,21 +238,18 @@ ChoicePage::setupChoices()
 
     m_alongsideButton = new PrettyRadioButton;
     m_alongsideButton->setIconSize( iconSize );
-    m_alongsideButton->setIcon(
-        CalamaresUtils::defaultPixmap( CalamaresUtils::PartitionAlongside, CalamaresUtils::Original, iconSize ) );
+    setIconAsync( m_alongsideButton, CalamaresUtils::PartitionAlongside, iconSize );
     m_alongsideButton->addToGroup( m_grp, InstallChoice::Alongside );
 
     m_eraseButton = new PrettyRadioButton;
     m_eraseButton->setIconSize( iconSize );
-    m_eraseButton->setIcon(
-        CalamaresUtils::defaultPixmap( CalamaresUtils::PartitionEraseAuto, CalamaresUtils::Original, iconSize ) );
+    setIconAsync( m_eraseButton, CalamaresUtils::PartitionEraseAuto, iconSize );
     m_eraseButton->addToGroup( m_grp, InstallChoice::Erase );
 
     m_replaceButton = new PrettyRadioButton;
 
     m_replaceButton->setIconSize( iconSize );
-    m_replaceButton->setIcon(
-        CalamaresUtils::defaultPixmap( CalamaresUtils::PartitionReplaceOs, CalamaresUtils::Original, iconSize ) );
+    setIconAsync( m_replaceButton, CalamaresUtils::PartitionReplaceOs, iconSize );
     m_replaceButton->addToGroup( m_grp, InstallChoice::Replace );
 
     // Fill up swap options
@@ -258,8 +265,7 @@ ChoicePage::setupChoices()
 
     m_somethingElseButton = new PrettyRadioButton;
     m_somethingElseButton->setIconSize( iconSize );
-    m_somethingElseButton->setIcon(
-        CalamaresUtils::defaultPixmap( CalamaresUtils::PartitionManual, CalamaresUtils::Original, iconSize ) );
+    setIconAsync( m_somethingElseButton, CalamaresUtils::PartitionManual, iconSize );
     m_itemsLayout->addWidget( m_somethingElseButton );
     m_somethingElseButton->addToGroup( m_grp, InstallChoice::Manual );
 
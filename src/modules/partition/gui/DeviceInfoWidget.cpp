@@ -39,8 +39,10 @@ DeviceInfoWidget::DeviceInfoWidget( QWidget* parent )
 
     m_ptIcon->setMargin( 0 );
     m_ptIcon->setFixedSize( iconSize );
-    m_ptIcon->setPixmap(
-        CalamaresUtils::defaultPixmap( CalamaresUtils::PartitionTable, CalamaresUtils::Original, iconSize ) );
+    CalamaresUtils::defaultPixmapAsync(
+        CalamaresUtils::PartitionTable, CalamaresUtils::Original, iconSize, m_ptIcon, [this]( const QPixmap& pixmap ) {
+            m_ptIcon->setPixmap( pixmap );
+        } );
 
     QFontMetrics fm = QFontMetrics( QFont() );
     m_ptLabel->setMinimumWidth( fm.boundingRect( "Amiga" ).width() + CalamaresUtils::defaultFontHeight() / 2 );
@@ -68,7 +68,7 @@ void
 PartitionBarsView::setNestedPartitionsMode( PartitionBarsView::NestedPartitionsMode mode )
 {
     m_nestedPartitionsMode = mode;
-    viewport()->repaint();
+    invalidateLayout();
 }
 
 
@@ -90,26 +90,32 @@ void
 PartitionBarsView::paintEvent( QPaintEvent* event )
 {
     QPainter painter( viewport() );
-    painter.fillRect( rect(), palette().window() );
+    painter.fillRect( event->rect(), palette().window() );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    QRect partitionsRect = rect();
-    partitionsRect.setHeight( VIEW_HEIGHT );
-
+    const QModelIndex selected = selectedIndex();
     painter.save();
-    drawPartitions( &painter, partitionsRect, QModelIndex() );
+    for ( const auto& section : sections() )
+    {
+        if ( section.rect.intersects( event->rect() ) )
+        {
+            drawSection( &painter, section, selected );
+        }
+    }
     painter.restore();
 }
 
 
 void
-PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, int width, const QModelIndex& index )
+PartitionBarsView::drawSection( QPainter* painter, const Section& section, const QModelIndex& selected )
 {
-    QColor color
-        = index.isValid() ? index.data( Qt::DecorationRole ).value< QColor >() : ColorUtils::unknownDisklabelColor();
-    bool isFreeSpace = index.isValid() ? index.data( PartitionModel::IsFreeSpaceRole ).toBool() : true;
+    const QModelIndex index = section.index;
+    const QColor& color = section.color;
+    const bool isFreeSpace = section.isFreeSpace;
+    const int x = section.rect.x();
+    const int width = section.rect.width();
 
-    QRect rect = rect_;
+    QRect rect = section.barRect;
     const int y = rect.y();
     const int height = rect.height();
     const int radius = qMax( 1, CORNER_RADIUS - ( VIEW_HEIGHT - height ) / 2 );
@@ -159,8 +165,7 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
     painter->setBrush( gradient );
     painter->drawRoundedRect( rect, radius, radius );
 
-    if ( selectionMode() != QAbstractItemView::NoSelection && index.isValid() && selectionModel()
-         && !selectionModel()->selectedIndexes().isEmpty() && selectionModel()->selectedIndexes().first() == index )
+    if ( selectionMode() != QAbstractItemView::NoSelection && index.isValid() && selected == index )
     {
         painter->setPen( QPen( borderColor, 1 ) );
         QColor highlightColor = QPalette().highlight().color();
@@ -191,8 +196,24 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
 }
 
 
+const QVector< PartitionBarsView::Section >&
+PartitionBarsView::sections() const
+{
+    if ( !m_sectionsValid )
+    {
+        m_sections.clear();
+
+        QRect partitionsRect = rect();
+        partitionsRect.setHeight( VIEW_HEIGHT );
+        layoutSections( partitionsRect, QModelIndex() );
+        m_sectionsValid = true;
+    }
+    return m_sections;
+}
+
+
 void
-PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const QModelIndex& parent )
+PartitionBarsView::layoutSections( const QRect& rect, const QModelIndex& parent ) const
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
     if ( !modl )
@@ -219,7 +240,11 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
             width = rect.right() - x + 1;
         }
 
-        drawSection( painter, rect, x, width, item.index );
+        m_sections.append( { rect,
+                             QRect( x, rect.y(), width, rect.height() ),
+                             item.index,
+                             item.index.data( Qt::DecorationRole ).value< QColor >(),
+                             item.index.data( PartitionModel::IsFreeSpaceRole ).toBool() } );
 
         if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index ) )
         {
@@ -227,78 +252,66 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
                            rect.y() + EXTENDED_PARTITION_MARGIN,
                            width - 2 * EXTENDED_PARTITION_MARGIN,
                            rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-            drawPartitions( painter, subRect, item.index );
+            layoutSections( subRect, item.index );
         }
         x += width;
     }
 
     if ( !items.count() && !modl->device()->partitionTable() )  // No disklabel or unknown
     {
-        int width = rect.right() - rect.x() + 1;
-        drawSection( painter, rect, rect.x(), width, QModelIndex() );
+        m_sections.append( { rect, rect, QPersistentModelIndex(), ColorUtils::unknownDisklabelColor(), true } );
     }
 }
 
 
-QModelIndex
-PartitionBarsView::indexAt( const QPoint& point ) const
+void
+PartitionBarsView::invalidateLayout()
 {
-    return indexAt( point, rect(), QModelIndex() );
+    m_sectionsValid = false;
+    viewport()->update();
 }
 
 
 QModelIndex
-PartitionBarsView::indexAt( const QPoint& point, const QRect& rect, const QModelIndex& parent ) const
+PartitionBarsView::selectedIndex() const
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( !selectionModel() )
     {
         return QModelIndex();
     }
-    const int totalWidth = rect.width();
+    const auto selected = selectionModel()->selectedIndexes();
+    return selected.isEmpty() ? QModelIndex() : selected.first();
+}
 
-    auto pair = computeItemsVector( parent );
-    QVector< PartitionBarsView::Item >& items = pair.first;
-    qreal& total = pair.second;
-    int x = rect.x();
-    for ( int row = 0; row < items.count(); ++row )
+
+void
+PartitionBarsView::updateIndexes( const QModelIndex& a, const QModelIndex& b )
+{
+    QRegion region;
+    for ( const auto& section : sections() )
     {
-        const auto& item = items[ row ];
-        int width;
-        if ( row < items.count() - 1 )
+        if ( ( a.isValid() && section.index == a ) || ( b.isValid() && section.index == b ) )
         {
-            width = totalWidth * ( item.size / total );
-        }
-        else
-        // Make sure we fill the last pixel column
-        {
-            width = rect.right() - x + 1;
+            region += section.rect;
         }
+    }
+    viewport()->update( region );
+}
 
-        QRect thisItemRect( x, rect.y(), width, rect.height() );
-        if ( thisItemRect.contains( point ) )
+
+QModelIndex
+PartitionBarsView::indexAt( const QPoint& point ) const
+{
+    // Nested partitions come after their parent, and lie inside it,
+    // so the last section that contains the point is the innermost one.
+    const auto& s = sections();
+    for ( auto it = s.crbegin(); it != s.crend(); ++it )
+    {
+        if ( it->rect.contains( point ) )
         {
-            if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index ) )
-            {
-                QRect subRect( x + EXTENDED_PARTITION_MARGIN,
-                               rect.y() + EXTENDED_PARTITION_MARGIN,
-                               width - 2 * EXTENDED_PARTITION_MARGIN,
-                               rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-
-                if ( subRect.contains( point ) )
-                {
-                    return indexAt( point, subRect, item.index );
-                }
-                return item.index;
-            }
-            else  // contains but no children, we win
-            {
-                return item.index;
-            }
+            return it->index;
         }
-        x += width;
     }
-
     return QModelIndex();
 }
 
@@ -306,62 +319,17 @@ PartitionBarsView::indexAt( const QPoint& point, const QRect& rect, const QModel
 QRect
 PartitionBarsView::visualRect( const QModelIndex& index ) const
 {
-    return visualRect( index, rect(), QModelIndex() );
-}
-
-
-QRect
-PartitionBarsView::visualRect( const QModelIndex& index, const QRect& rect, const QModelIndex& parent ) const
-{
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( !index.isValid() )
     {
         return QRect();
     }
-    const int totalWidth = rect.width();
-
-    auto pair = computeItemsVector( parent );
-    QVector< PartitionBarsView::Item >& items = pair.first;
-    qreal& total = pair.second;
-    int x = rect.x();
-    for ( int row = 0; row < items.count(); ++row )
+    for ( const auto& section : sections() )
     {
-        const auto& item = items[ row ];
-        int width;
-        if ( row < items.count() - 1 )
+        if ( section.index == index )
         {
-            width = totalWidth * ( item.size / total );
-        }
-        else
-        // Make sure we fill the last pixel column
-        {
-            width = rect.right() - x + 1;
-        }
-
-        QRect thisItemRect( x, rect.y(), width, rect.height() );
-        if ( item.index == index )
-        {
-            return thisItemRect;
-        }
-
-        if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index )
-             && index.parent() == item.index )
-        {
-            QRect subRect( x + EXTENDED_PARTITION_MARGIN,
-                           rect.y() + EXTENDED_PARTITION_MARGIN,
-                           width - 2 * EXTENDED_PARTITION_MARGIN,
-                           rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-
-            QRect candidateVisualRect = visualRect( index, subRect, item.index );
-            if ( !candidateVisualRect.isNull() )
-            {
-                return candidateVisualRect;
-            }
+            return section.rect;
         }
-
-        x += width;
     }
-
     return QRect();
 }
 
@@ -395,11 +363,41 @@ PartitionBarsView::scrollTo( const QModelIndex& index, ScrollHint hint )
 }
 
 
+void
+PartitionBarsView::setModel( QAbstractItemModel* model )
+{
+    if ( model == this->model() )
+    {
+        return;
+    }
+    if ( this->model() )
+    {
+        disconnect( this->model(), nullptr, this, nullptr );
+    }
+    QAbstractItemView::setModel( model );
+    invalidateLayout();
+    if ( model )
+    {
+        // Any change to the model may change the layout of the bar
+        connect( model, &QAbstractItemModel::modelReset, this, &PartitionBarsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::layoutChanged, this, &PartitionBarsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::rowsInserted, this, &PartitionBarsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::rowsRemoved, this, &PartitionBarsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::dataChanged, this, &PartitionBarsView::invalidateLayout );
+    }
+}
+
+
 void
 PartitionBarsView::setSelectionModel( QItemSelectionModel* selectionModel )
 {
     QAbstractItemView::setSelectionModel( selectionModel );
-    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->repaint(); } );
+    connect( selectionModel,
+             &QItemSelectionModel::selectionChanged,
+             this,
+             [=]( const QItemSelection& selected, const QItemSelection& deselected ) {
+                 updateIndexes( selected.indexes().value( 0 ), deselected.indexes().value( 0 ) );
+             } );
 }
 
 
@@ -448,8 +446,6 @@ PartitionBarsView::setSelection( const QRect& rect, QItemSelectionModel::Selecti
     {
         selectionModel()->select( eventIndex, flags );
     }
-
-    viewport()->repaint();
 }
 
 
@@ -479,7 +475,7 @@ PartitionBarsView::mouseMoveEvent( QMouseEvent* event )
             QGuiApplication::restoreOverrideCursor();
         }
 
-        viewport()->repaint();
+        updateIndexes( oldHoveredIndex, m_hoveredIndex );
     }
 }
 
@@ -490,8 +486,9 @@ PartitionBarsView::leaveEvent( QEvent* )
     QGuiApplication::restoreOverrideCursor();
     if ( m_hoveredIndex.isValid() )
     {
+        QModelIndex oldHoveredIndex = m_hoveredIndex;
         m_hoveredIndex = QModelIndex();
-        viewport()->repaint();
+        updateIndexes( oldHoveredIndex, QModelIndex() );
     }
 }
 
@@ -511,6 +508,14 @@ PartitionBarsView::mousePressEvent( QMouseEvent* event )
 }
 
 
+void
+PartitionBarsView::resizeEvent( QResizeEvent* event )
+{
+    QAbstractItemView::resizeEvent( event );
+    invalidateLayout();
+}
+
+
 void
 PartitionBarsView::updateGeometries()
 {
@@ -49,6 +49,7 @@ public:
     QRect visualRect( const QModelIndex& index ) const override;
     void scrollTo( const QModelIndex& index, ScrollHint hint = EnsureVisible ) override;
 
+    void setModel( QAbstractItemModel* model ) override;
     void setSelectionModel( QItemSelectionModel* selectionModel ) override;
 
     void setSelectionFilter( SelectionFilter canBeSelected );
@@ -65,15 +66,37 @@ protected:
     void mouseMoveEvent( QMouseEvent* event ) override;
     void leaveEvent( QEvent* event ) override;
     void mousePressEvent( QMouseEvent* event ) override;
+    void resizeEvent( QResizeEvent* event ) override;
 
 protected slots:
     void updateGeometries() override;
 
 private:
-    void drawPartitions( QPainter* painter, const QRect& rect, const QModelIndex& parent );
-    void drawSection( QPainter* painter, const QRect& rect_, int x, int width, const QModelIndex& index );
-    QModelIndex indexAt( const QPoint& point, const QRect& rect, const QModelIndex& parent ) const;
-    QRect visualRect( const QModelIndex& index, const QRect& rect, const QModelIndex& parent ) const;
+    /** @brief One partition (or free space) as drawn in the bar
+     *
+     * The layout of the bar is computed once (per model change or
+     * resize) and stored as a list of sections. Nested partitions
+     * follow their parent in the list.
+     */
+    struct Section
+    {
+        QRect barRect;  ///< The (sub-)bar this section is part of
+        QRect rect;  ///< The part of the bar for this section
+        QPersistentModelIndex index;  ///< Invalid for an unknown disklabel
+        QColor color;
+        bool isFreeSpace;
+    };
+
+    /// @brief The (cached) layout of the bar
+    const QVector< Section >& sections() const;
+    void layoutSections( const QRect& rect, const QModelIndex& parent ) const;
+    /// @brief Drop the cached layout and repaint
+    void invalidateLayout();
+
+    void drawSection( QPainter* painter, const Section& section, const QModelIndex& selected );
+    QModelIndex selectedIndex() const;
+    /// @brief Repaint only the sections for the two indexes
+    void updateIndexes( const QModelIndex& a, const QModelIndex& b );
 
     NestedPartitionsMode m_nestedPartitionsMode;
 
@@ -86,6 +109,9 @@ private:
     };
     inline QPair< QVector< Item >, qreal > computeItemsVector( const QModelIndex& parent ) const;
     QPersistentModelIndex m_hoveredIndex;
+
+    mutable QVector< Section > m_sections;
+    mutable bool m_sectionsValid = false;
 };
 
 #endif /* PARTITIONPREVIEW_H */
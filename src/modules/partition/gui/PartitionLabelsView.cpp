@@ -83,15 +83,49 @@ PartitionLabelsView::sizeHint() const
 void
 PartitionLabelsView::paintEvent( QPaintEvent* event )
 {
-    Q_UNUSED( event )
-
     QPainter painter( viewport() );
-    painter.fillRect( rect(), palette().window() );
+    painter.fillRect( event->rect(), palette().window() );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    QRect lRect = labelsRect();
+    // The labels are positioned relative to rect(), but drawn in labelsRect()
+    const QPoint offset = labelsRect().topLeft() - rect().topLeft();
+    painter.translate( offset );
+    const QRect dirty = event->rect().translated( -offset );
+
+    QModelIndex selected;
+    if ( selectionMode() != QAbstractItemView::NoSelection && selectionModel()
+         && !selectionModel()->selectedIndexes().isEmpty() )
+    {
+        selected = selectionModel()->selectedIndexes().first();
+    }
+
+    for ( const auto& label : labels() )
+    {
+        if ( !dirty.intersects( QRect( label.pos, label.size ).adjusted( 0, -label.size.height(), 0, 0 ) ) )
+        {
+            continue;
+        }
 
-    drawLabels( &painter, lRect, QModelIndex() );
+        // Draw hover
+        if ( selectionMode() != QAbstractItemView::NoSelection &&  // no hover without selection
+             m_hoveredIndex.isValid() && label.index == m_hoveredIndex )
+        {
+            painter.save();
+            QRect labelRect( label.pos, label.size );
+            labelRect.adjust( 0, -LAYOUT_MARGIN, 0, -2 * LAYOUT_MARGIN );
+            painter.translate( 0.5, 0.5 );
+            QRect hoverRect = labelRect.adjusted( 0, 0, -1, -1 );
+            painter.setBrush( QPalette().window().color().lighter( 102 ) );
+            painter.setPen( Qt::NoPen );
+            painter.drawRoundedRect( hoverRect, CORNER_RADIUS, CORNER_RADIUS );
+
+            painter.translate( -0.5, -0.5 );
+            painter.restore();
+        }
+
+        // Is this element the selected one? (the unknown-disklabel can't be selected)
+        drawLabel( &painter, label, label.index.isValid() && label.index == selected );
+    }
 }
 
 
@@ -244,65 +278,83 @@ PartitionLabelsView::buildTexts( const QModelIndex& index ) const
 }
 
 
-void
-PartitionLabelsView::drawLabels( QPainter* painter, const QRect& rect, const QModelIndex& parent )
+const QVector< PartitionLabelsView::Label >&
+PartitionLabelsView::labels() const
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( !m_labelsValid )
     {
-        return;
-    }
-
-    const QModelIndexList indexesToDraw = getIndexesToDraw( parent );
-
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
-    {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        QColor labelColor = index.data( Qt::DecorationRole ).value< QColor >();
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        m_labels.clear();
+        m_labelsWidth = -1;
+        if ( modl )
         {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
+            const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
+            for ( const QModelIndex& index : indexesToDraw )
+            {
+                m_labels.append(
+                    makeLabel( index, buildTexts( index ), index.data( Qt::DecorationRole ).value< QColor >() ) );
+            }
+            if ( !modl->rowCount() && !modl->device()->partitionTable() )  // No disklabel or unknown
+            {
+                m_labels.append( makeLabel( QModelIndex(),
+                                            buildUnknownDisklabelTexts( modl->device() ),
+                                            ColorUtils::unknownDisklabelColor() ) );
+            }
         }
+        m_labelsValid = true;
+    }
 
-        // Draw hover
-        if ( selectionMode() != QAbstractItemView::NoSelection &&  // no hover without selection
-             m_hoveredIndex.isValid() && index == m_hoveredIndex )
+    const QRect rect = this->rect();
+    if ( m_labelsWidth != rect.width() )
+    {
+        int label_x = rect.x();
+        int label_y = rect.y();
+        for ( auto& label : m_labels )
         {
-            painter->save();
-            QRect labelRect( QPoint( label_x, label_y ), labelSize );
-            labelRect.adjust( 0, -LAYOUT_MARGIN, 0, -2 * LAYOUT_MARGIN );
-            painter->translate( 0.5, 0.5 );
-            QRect hoverRect = labelRect.adjusted( 0, 0, -1, -1 );
-            painter->setBrush( QPalette().window().color().lighter( 102 ) );
-            painter->setPen( Qt::NoPen );
-            painter->drawRoundedRect( hoverRect, CORNER_RADIUS, CORNER_RADIUS );
-
-            painter->translate( -0.5, -0.5 );
-            painter->restore();
+            if ( !label.index.isValid() )
+            {
+                // The unknown-disklabel label is the only one
+                label.pos = rect.topLeft();
+                continue;
+            }
+            if ( label_x + label.size.width() > rect.width() )  //wrap to new line if overflow
+            {
+                label_x = rect.x();
+                label_y += label.size.height() + label.size.height() / 4;
+            }
+            label.pos = QPoint( label_x, label_y );
+            label_x += label.size.width() + LABELS_MARGIN;
         }
+        m_labelsWidth = rect.width();
+    }
+    return m_labels;
+}
 
-        // Is this element the selected one?
-        bool sel = selectionMode() != QAbstractItemView::NoSelection && index.isValid() && selectionModel()
-            && !selectionModel()->selectedIndexes().isEmpty() && selectionModel()->selectedIndexes().first() == index;
 
-        drawLabel( painter, texts, labelColor, QPoint( label_x, label_y ), sel );
+void
+PartitionLabelsView::invalidateLayout()
+{
+    m_labelsValid = false;
+    viewport()->update();
+}
 
-        label_x += labelSize.width() + LABELS_MARGIN;
-    }
 
-    if ( !modl->rowCount() && !modl->device()->partitionTable() )  // No disklabel or unknown
+void
+PartitionLabelsView::updateIndexes( const QModelIndex& a, const QModelIndex& b )
+{
+    const QPoint offset = labelsRect().topLeft() - rect().topLeft();
+    QRegion region;
+    for ( const auto& label : labels() )
     {
-        QStringList texts = buildUnknownDisklabelTexts( modl->device() );
-        QColor labelColor = ColorUtils::unknownDisklabelColor();
-        drawLabel( painter, texts, labelColor, QPoint( rect.x(), rect.y() ), false /*can't be selected*/ );
+        if ( ( a.isValid() && label.index == a ) || ( b.isValid() && label.index == b ) )
+        {
+            // Text and color square stick out above the label's position,
+            // and the hover background is shifted by the margin.
+            region += QRect( label.pos + offset, label.size )
+                          .adjusted( -1, -label.size.height() / 2 - LAYOUT_MARGIN, 1, LAYOUT_MARGIN );
+        }
     }
+    viewport()->update( region );
 }
 
 
@@ -315,33 +367,28 @@ PartitionLabelsView::sizeForAllLabels( int maxLineWidth ) const
         return QSize();
     }
 
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
     int lineLength = 0;
     int numLines = 1;
     int singleLabelHeight = 0;
-    for ( const QModelIndex& index : indexesToDraw )
+    for ( const auto& label : labels() )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
+        if ( !label.index.isValid() )  // Unknown or no disklabel
+        {
+            singleLabelHeight = label.size.height();
+            continue;
+        }
 
-        if ( lineLength + labelSize.width() > maxLineWidth )
+        if ( lineLength + label.size.width() > maxLineWidth )
         {
             numLines++;
-            lineLength = labelSize.width();
+            lineLength = label.size.width();
         }
         else
         {
-            lineLength += LABELS_MARGIN + labelSize.width();
+            lineLength += LABELS_MARGIN + label.size.width();
         }
 
-        singleLabelHeight = qMax( singleLabelHeight, labelSize.height() );
-    }
-
-    if ( !modl->rowCount() && !modl->device()->partitionTable() )  // Unknown or no disklabel
-    {
-        singleLabelHeight = sizeForLabel( buildUnknownDisklabelTexts( modl->device() ) ).height();
+        singleLabelHeight = qMax( singleLabelHeight, label.size.height() );
     }
 
     int totalHeight = numLines * singleLabelHeight + ( numLines - 1 ) * singleLabelHeight / 4;  //spacings
@@ -350,50 +397,51 @@ PartitionLabelsView::sizeForAllLabels( int maxLineWidth ) const
 }
 
 
-QSize
-PartitionLabelsView::sizeForLabel( const QStringList& text ) const
+PartitionLabelsView::Label
+PartitionLabelsView::makeLabel( const QModelIndex& index, const QStringList& texts, const QColor& color ) const
 {
+    Label label { index, texts, {}, color, QSize(), QPoint() };
+
     int vertOffset = 0;
     int width = 0;
-    for ( const QString& textLine : text )
+    for ( const QString& textLine : texts )
     {
         QSize textSize = fontMetrics().size( Qt::TextSingleLine, textLine );
+        label.textSizes.append( textSize );
 
         vertOffset += textSize.height();
         width = qMax( width, textSize.width() );
     }
     width += LABEL_PARTITION_SQUARE_MARGIN;  //for the color square
-    return QSize( width, vertOffset );
+    label.size = QSize( width, vertOffset );
+    return label;
 }
 
 
 void
-PartitionLabelsView::drawLabel( QPainter* painter,
-                                const QStringList& text,
-                                const QColor& color,
-                                const QPoint& pos,
-                                bool selected )
+PartitionLabelsView::drawLabel( QPainter* painter, const Label& label, bool selected )
 {
+    const QPoint& pos = label.pos;
+
     painter->setPen( Qt::black );
     int vertOffset = 0;
-    int width = 0;
-    for ( const QString& textLine : text )
+    for ( int i = 0; i < label.texts.count(); ++i )
     {
-        QSize textSize = painter->fontMetrics().size( Qt::TextSingleLine, textLine );
-        painter->drawText(
-            pos.x() + LABEL_PARTITION_SQUARE_MARGIN, pos.y() + vertOffset + textSize.height() / 2, textLine );
+        const QSize& textSize = label.textSizes.at( i );
+        painter->drawText( pos.x() + LABEL_PARTITION_SQUARE_MARGIN,
+                           pos.y() + vertOffset + textSize.height() / 2,
+                           label.texts.at( i ) );
         vertOffset += textSize.height();
         painter->setPen( Qt::gray );
-        width = qMax( width, textSize.width() );
     }
 
     QRect partitionSquareRect(
         pos.x(), pos.y() - 3, LABEL_PARTITION_SQUARE_MARGIN - 5, LABEL_PARTITION_SQUARE_MARGIN - 5 );
-    drawPartitionSquare( painter, partitionSquareRect, color );
+    drawPartitionSquare( painter, partitionSquareRect, label.color );
 
     if ( selected )
     {
-        drawSelectionSquare( painter, partitionSquareRect.adjusted( 2, 2, -2, -2 ), color );
+        drawSelectionSquare( painter, partitionSquareRect.adjusted( 2, 2, -2, -2 ), label.color );
     }
 
     painter->setPen( Qt::black );
@@ -403,36 +451,12 @@ PartitionLabelsView::drawLabel( QPainter* painter,
 QModelIndex
 PartitionLabelsView::indexAt( const QPoint& point ) const
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    for ( const auto& label : labels() )
     {
-        return QModelIndex();
-    }
-
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
-    QRect rect = this->rect();
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
-    {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        if ( label.index.isValid() && QRect( label.pos, label.size ).contains( point ) )
         {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
+            return label.index;
         }
-
-        QRect labelRect( QPoint( label_x, label_y ), labelSize );
-        if ( labelRect.contains( point ) )
-        {
-            return index;
-        }
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
 
     return QModelIndex();
@@ -442,35 +466,16 @@ PartitionLabelsView::indexAt( const QPoint& point ) const
 QRect
 PartitionLabelsView::visualRect( const QModelIndex& idx ) const
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( !idx.isValid() )
     {
         return QRect();
     }
-
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
-    QRect rect = this->rect();
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
+    for ( const auto& label : labels() )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
-        {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
-        }
-
-        if ( idx.isValid() && idx == index )
+        if ( label.index == idx )
         {
-            return QRect( QPoint( label_x, label_y ), labelSize );
+            return QRect( label.pos, label.size );
         }
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
 
     return QRect();
@@ -512,7 +517,32 @@ void
 PartitionLabelsView::setCustomNewRootLabel( const QString& text )
 {
     m_customNewRootLabel = text;
-    viewport()->repaint();
+    invalidateLayout();
+}
+
+
+void
+PartitionLabelsView::setModel( QAbstractItemModel* model )
+{
+    if ( model == this->model() )
+    {
+        return;
+    }
+    if ( this->model() )
+    {
+        disconnect( this->model(), nullptr, this, nullptr );
+    }
+    QAbstractItemView::setModel( model );
+    invalidateLayout();
+    if ( model )
+    {
+        // Any change to the model may change the texts and layout of the labels
+        connect( model, &QAbstractItemModel::modelReset, this, &PartitionLabelsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::layoutChanged, this, &PartitionLabelsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::rowsInserted, this, &PartitionLabelsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::rowsRemoved, this, &PartitionLabelsView::invalidateLayout );
+        connect( model, &QAbstractItemModel::dataChanged, this, &PartitionLabelsView::invalidateLayout );
+    }
 }
 
 
@@ -520,7 +550,12 @@ void
 PartitionLabelsView::setSelectionModel( QItemSelectionModel* selectionModel )
 {
     QAbstractItemView::setSelectionModel( selectionModel );
-    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->repaint(); } );
+    connect( selectionModel,
+             &QItemSelectionModel::selectionChanged,
+             this,
+             [=]( const QItemSelection& selected, const QItemSelection& deselected ) {
+                 updateIndexes( selected.indexes().value( 0 ), deselected.indexes().value( 0 ) );
+             } );
 }
 
 
@@ -535,6 +570,7 @@ void
 PartitionLabelsView::setExtendedPartitionHidden( bool hidden )
 {
     m_extendedPartitionHidden = hidden;
+    invalidateLayout();
 }
 
 
@@ -594,7 +630,7 @@ PartitionLabelsView::mouseMoveEvent( QMouseEvent* event )
             QGuiApplication::restoreOverrideCursor();
         }
 
-        viewport()->repaint();
+        updateIndexes( oldHoveredIndex, m_hoveredIndex );
     }
 }
 
@@ -607,8 +643,9 @@ PartitionLabelsView::leaveEvent( QEvent* event )
     QGuiApplication::restoreOverrideCursor();
     if ( m_hoveredIndex.isValid() )
     {
+        QModelIndex oldHoveredIndex = m_hoveredIndex;
         m_hoveredIndex = QModelIndex();
-        viewport()->repaint();
+        updateIndexes( oldHoveredIndex, QModelIndex() );
     }
 }
 
@@ -628,6 +665,18 @@ PartitionLabelsView::mousePressEvent( QMouseEvent* event )
 }
 
 
+void
+PartitionLabelsView::changeEvent( QEvent* event )
+{
+    // The cached labels hold translated texts, measured in the current font
+    if ( event->type() == QEvent::LanguageChange || event->type() == QEvent::FontChange )
+    {
+        invalidateLayout();
+    }
+    QAbstractItemView::changeEvent( event );
+}
+
+
 void
 PartitionLabelsView::updateGeometries()
 {
@@ -43,6 +43,7 @@ public:
 
     void setCustomNewRootLabel( const QString& text );
 
+    void setModel( QAbstractItemModel* model ) override;
     void setSelectionModel( QItemSelectionModel* selectionModel ) override;
 
     void setSelectionFilter( SelectionFilter canBeSelected );
@@ -61,16 +62,38 @@ protected:
     void mouseMoveEvent( QMouseEvent* event ) override;
     void leaveEvent( QEvent* event ) override;
     void mousePressEvent( QMouseEvent* event ) override;
+    void changeEvent( QEvent* event ) override;
 
 protected slots:
     void updateGeometries() override;
 
 private:
+    /** @brief One label, for one partition
+     *
+     * The texts (and their sizes) are computed once per model change;
+     * the positions are re-computed when the width of the view changes.
+     */
+    struct Label
+    {
+        QPersistentModelIndex index;  ///< Invalid for an unknown disklabel
+        QStringList texts;
+        QVector< QSize > textSizes;  ///< Size of each line of text
+        QColor color;
+        QSize size;  ///< Size of the whole label
+        QPoint pos;  ///< Position relative to the view's rect()
+    };
+
     QRect labelsRect() const;
-    void drawLabels( QPainter* painter, const QRect& rect, const QModelIndex& parent );
+    /// @brief The (cached) labels, laid out for the current width
+    const QVector< Label >& labels() const;
+    /// @brief Drop the cached labels and repaint
+    void invalidateLayout();
+    /// @brief Repaint only the labels for the two indexes
+    void updateIndexes( const QModelIndex& a, const QModelIndex& b );
+
     QSize sizeForAllLabels( int maxLineWidth ) const;
-    QSize sizeForLabel( const QStringList& text ) const;
-    void drawLabel( QPainter* painter, const QStringList& text, const QColor& color, const QPoint& pos, bool selected );
+    Label makeLabel( const QModelIndex& index, const QStringList& texts, const QColor& color ) const;
+    void drawLabel( QPainter* painter, const Label& label, bool selected );
     QModelIndexList getIndexesToDraw( const QModelIndex& parent ) const;
     QStringList buildTexts( const QModelIndex& index ) const;
 
@@ -79,6 +102,10 @@ private:
 
     QString m_customNewRootLabel;
     QPersistentModelIndex m_hoveredIndex;
+
+    mutable QVector< Label > m_labels;
+    mutable bool m_labelsValid = false;
+    mutable int m_labelsWidth = -1;  ///< Width the positions were computed for
 };
 
 #endif  // PARTITIONLABELSVIEW_H
@@ -615,6 +615,7 @@ PartitionPage::updateFromCurrentDevice()
              &QItemSelectionModel::currentChanged,
              [this]( const QModelIndex&, const QModelIndex& ) { updateButtons(); } );
     connect( model, &QAbstractItemModel::modelReset, this, &PartitionPage::onPartitionModelReset );
+    connect( model, &PartitionModel::partitionsChanged, this, &PartitionPage::onPartitionModelReset );
 }
 
 void
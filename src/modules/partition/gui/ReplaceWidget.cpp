@@ -16,6 +16,7 @@
 #include "core/PartitionActions.h"
 #include "core/PartitionCoreModule.h"
 #include "core/PartitionInfo.h"
+#include "core/PartitionModel.h"
 
 #include "Branding.h"
 #include "GlobalStorage.h"
@@ -362,6 +363,7 @@ ReplaceWidget::updateFromCurrentDevice( QComboBox* devicesComboBox )
              &ReplaceWidget::onPartitionViewActivated );
 
     connect( model, &QAbstractItemModel::modelReset, this, &ReplaceWidget::onPartitionModelReset );
+    connect( model, &PartitionModel::partitionsChanged, this, &ReplaceWidget::onPartitionModelReset );
 }
 
 
@@ -21,17 +21,42 @@
 // KPMcore
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
+#include <kpmcore/fs/filesystem.h>
 #include <kpmcore/util/report.h>
 
-#include <QDir>
+#include <QFile>
 #include <QProcess>
+#include <QSet>
 #include <QStringList>
 
+#include <algorithm>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/swap.h>
+
 using CalamaresUtils::Partition::PartitionIterator;
 
+static QString
+deviceNames( const QList< Device* >& devices )
+{
+    QStringList names;
+    for ( const Device* d : devices )
+    {
+        names.append( d->deviceNode() );
+    }
+    return names.join( ", " );
+}
+
 ClearMountsJob::ClearMountsJob( Device* device )
+    : ClearMountsJob( QList< Device* > { device } )
+{
+}
+
+ClearMountsJob::ClearMountsJob( const QList< Device* >& devices )
     : Calamares::Job()
-    , m_device( device )
+    , m_devices( devices )
 {
 }
 
@@ -39,189 +64,109 @@ ClearMountsJob::ClearMountsJob( Device* device )
 QString
 ClearMountsJob::prettyName() const
 {
-    return tr( "Clear mounts for partitioning operations on %1" ).arg( m_device->deviceNode() );
+    return tr( "Clear mounts for partitioning operations on %1" ).arg( deviceNames( m_devices ) );
 }
 
 
 QString
 ClearMountsJob::prettyStatusMessage() const
 {
-    return tr( "Clearing mounts for partitioning operations on %1." ).arg( m_device->deviceNode() );
+    return tr( "Clearing mounts for partitioning operations on %1." ).arg( deviceNames( m_devices ) );
 }
 
 
-QStringList
-getPartitionsForDevice( const QString& deviceName )
-{
-    QStringList partitions;
-
-    QFile dev_partitions( "/proc/partitions" );
-    if ( dev_partitions.open( QFile::ReadOnly ) )
-    {
-        cDebug() << "Reading from" << dev_partitions.fileName();
-        QTextStream in( &dev_partitions );
-        (void)in.readLine();  // That's the header line, skip it
-        while ( !in.atEnd() )
-        {
-            // The fourth column (index from 0, so index 3) is the name of the device;
-            // keep it if it is followed by something.
-            QStringList columns = in.readLine().split( ' ', SplitSkipEmptyParts );
-            if ( ( columns.count() >= 4 ) && ( columns[ 3 ].startsWith( deviceName ) )
-                 && ( columns[ 3 ] != deviceName ) )
-            {
-                partitions.append( columns[ 3 ] );
-            }
-        }
-    }
-    else
-    {
-        cDebug() << "Could not open" << dev_partitions.fileName();
-    }
-
-    return partitions;
-}
-
 Calamares::JobResult
 ClearMountsJob::exec()
 {
     CalamaresUtils::Partition::Syncer s;
 
-    QString deviceName = m_device->deviceNode().split( '/' ).last();
-
     QStringList goodNews;
-    QProcess process;
 
-    QStringList partitionsList = getPartitionsForDevice( deviceName );
-
-    // Build a list of partitions of type 82 (Linux swap / Solaris).
-    // We then need to clear them just in case they contain something resumable from a
-    // previous suspend-to-disk.
-    QStringList swapPartitions;
-    process.start( "sfdisk", { "-d", m_device->deviceNode() } );
-    process.waitForFinished();
-    // Sample output:
-    //    % sudo sfdisk -d /dev/sda
-    //    label: dos
-    //    label-id: 0x000ced89
-    //    device: /dev/sda
-    //    unit: sectors
-
-    //    /dev/sda1 : start=          63, size=    29329345, type=83, bootable
-    //    /dev/sda2 : start=    29331456, size=     2125824, type=82
-
-    swapPartitions = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
-    swapPartitions = swapPartitions.filter( "type=82" );
-    for ( QStringList::iterator it = swapPartitions.begin(); it != swapPartitions.end(); ++it )
+    // Everything built on the devices, topmost first, so that each
+    // device is unused by the time it is taken down.
+    const BlockTopology topology = BlockTopology::snapshot();
+    QStringList stack;
+    for ( const Device* device : m_devices )
     {
-        *it = ( *it ).simplified().split( ' ' ).first();
+        for ( const QString& name : topology.stackedOn( device->deviceNode().split( '/' ).last() ) )
+        {
+            if ( !stack.contains( name ) )
+            {
+                stack.append( name );
+            }
+        }
     }
 
-    const QStringList cryptoDevices = getCryptoDevices();
-    for ( const QString& mapperPath : cryptoDevices )
-    {
-        tryUmount( mapperPath );
-        QString news = tryCryptoClose( mapperPath );
+    auto addNews = [&goodNews]( const QString& news ) {
         if ( !news.isEmpty() )
         {
             goodNews.append( news );
         }
-    }
+    };
 
-    // First we umount all LVM logical volumes we can find
-    process.start( "lvscan", { "-a" } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )  //means LVM2 tools are installed
+    // First stop using the devices: unmount them, and turn off swap
+    QStringList mountPoints;
+    for ( const QString& name : stack )
     {
-        const QStringList lvscanLines = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
-        for ( const QString& lvscanLine : lvscanLines )
+        const BlockTopology::Node* node = topology.node( name );
+        if ( isLiveDevice( *node ) )
         {
-            QString lvPath = lvscanLine.simplified().split( ' ' ).value( 1 );  //second column
-            lvPath = lvPath.replace( '\'', "" );
-
-            QString news = tryUmount( lvPath );
-            if ( !news.isEmpty() )
-            {
-                goodNews.append( news );
-            }
+            continue;
         }
-    }
-    else
-    {
-        cWarning() << "this system does not seem to have LVM2 tools.";
-    }
-
-    // Then we go looking for volume groups that use this device for physical volumes
-    process.start( "pvdisplay", { "-C", "--noheadings" } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )  //means LVM2 tools are installed
-    {
-        QString pvdisplayOutput = process.readAllStandardOutput();
-        if ( !pvdisplayOutput.simplified().isEmpty() )  //means there is at least one LVM PV
+        // Mounts on top of other mounts come later in the list
+        for ( auto it = node->mountPoints.crbegin(); it != node->mountPoints.crend(); ++it )
         {
-            QSet< QString > vgSet;
-
-            const QStringList pvdisplayLines = pvdisplayOutput.split( '\n' );
-            for ( const QString& pvdisplayLine : pvdisplayLines )
-            {
-                QString pvPath = pvdisplayLine.simplified().split( ' ' ).value( 0 );
-                QString vgName = pvdisplayLine.simplified().split( ' ' ).value( 1 );
-                if ( !pvPath.contains( deviceName ) )
-                {
-                    continue;
-                }
-
-                vgSet.insert( vgName );
-            }
-
-            foreach ( const QString& vgName, vgSet )
-            {
-                process.start( "vgchange", { "-an", vgName } );
-                process.waitForFinished();
-                if ( process.exitCode() == 0 )
-                {
-                    goodNews.append( QString( "Successfully disabled volume group %1." ).arg( vgName ) );
-                }
-            }
+            mountPoints.append( *it );
+        }
+        if ( node->isSwap )
+        {
+            addNews( trySwapOff( node->devicePath ) );
         }
     }
-    else
+    // Partitions may be mounted inside each other (e.g. /boot inside /), deepest first
+    std::stable_sort( mountPoints.begin(), mountPoints.end(), []( const QString& a, const QString& b ) {
+        return a.count( '/' ) > b.count( '/' );
+    } );
+    for ( const QString& mountPoint : mountPoints )
     {
-        cWarning() << "this system does not seem to have LVM2 tools.";
+        addNews( tryUmount( mountPoint ) );
     }
 
-    const QStringList cryptoDevices2 = getCryptoDevices();
-    for ( const QString& mapperPath : cryptoDevices2 )
+    // Then take down LVM volume groups and LUKS containers
+    QSet< QString > volumeGroups;
+    for ( const QString& name : stack )
     {
-        tryUmount( mapperPath );
-        QString news = tryCryptoClose( mapperPath );
-        if ( !news.isEmpty() )
+        const BlockTopology::Node* node = topology.node( name );
+        if ( isLiveDevice( *node ) )
         {
-            goodNews.append( news );
+            continue;
         }
-    }
-
-    for ( const QString& p : partitionsList )
-    {
-        QString partPath = QString( "/dev/%1" ).arg( p );
-
-        QString news = tryUmount( partPath );
-        if ( !news.isEmpty() )
+        if ( node->isLvm() && !volumeGroups.contains( node->volumeGroup() ) )
         {
-            goodNews.append( news );
+            volumeGroups.insert( node->volumeGroup() );
+            addNews( tryDeactivateVolumeGroup( node->volumeGroup() ) );
+        }
+        else if ( node->isCrypt() )
+        {
+            addNews( tryCryptoClose( node->devicePath ) );
         }
     }
 
-    foreach ( QString p, swapPartitions )
+    // Swap partitions may contain something resumable from a previous
+    // suspend-to-disk, so clear them.
+    for ( Device* device : m_devices )
     {
-        QString news = tryClearSwap( p );
-        if ( !news.isEmpty() )
+        for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
-            goodNews.append( news );
+            if ( ( *it )->fileSystem().type() == FileSystem::Type::LinuxSwap )
+            {
+                addNews( tryClearSwap( ( *it )->partitionPath(), ( *it )->fileSystem().uuid() ) );
+            }
         }
     }
 
     Calamares::JobResult ok = Calamares::JobResult::ok();
-    ok.setMessage( tr( "Cleared all mounts for %1" ).arg( m_device->deviceNode() ) );
+    ok.setMessage( tr( "Cleared all mounts for %1" ).arg( deviceNames( m_devices ) ) );
     ok.setDetails( goodNews.join( "\n" ) );
 
     cDebug() << "ClearMountsJob finished. Here's what was done:\n" << goodNews.join( "\n" );
@@ -230,41 +175,50 @@ ClearMountsJob::exec()
 }
 
 
+bool
+ClearMountsJob::isLiveDevice( const BlockTopology::Node& node )
+{
+    // Fedora live images use /dev/mapper/live-* internally. We must not
+    // unmount those devices, because they are used by the live image and
+    // because we need /dev/mapper/live-base in the unpackfs module.
+    return node.dmName.startsWith( "live-" );
+}
+
+
 QString
-ClearMountsJob::tryUmount( const QString& partPath )
+ClearMountsJob::tryUmount( const QString& mountPoint )
 {
-    QProcess process;
-    process.start( "umount", { partPath } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )
+    if ( ::umount( QFile::encodeName( mountPoint ).constData() ) == 0 )
     {
-        return QString( "Successfully unmounted %1." ).arg( partPath );
+        return QString( "Successfully unmounted %1." ).arg( mountPoint );
     }
+    cWarning() << "Could not unmount" << mountPoint << ':' << strerror( errno );
+    return QString();
+}
 
-    process.start( "swapoff", { partPath } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )
+
+QString
+ClearMountsJob::trySwapOff( const QString& partPath )
+{
+    if ( ::swapoff( QFile::encodeName( partPath ).constData() ) == 0 )
     {
         return QString( "Successfully disabled swap %1." ).arg( partPath );
     }
-
+    cWarning() << "Could not disable swap" << partPath << ':' << strerror( errno );
     return QString();
 }
 
 
 QString
-ClearMountsJob::tryClearSwap( const QString& partPath )
+ClearMountsJob::tryClearSwap( const QString& partPath, const QString& uuid )
 {
-    QProcess process;
-    process.start( "blkid", { "-s", "UUID", "-o", "value", partPath } );
-    process.waitForFinished();
-    QString swapPartUuid = QString::fromLocal8Bit( process.readAllStandardOutput() ).simplified();
-    if ( process.exitCode() != 0 || swapPartUuid.isEmpty() )
+    if ( uuid.isEmpty() )
     {
         return QString();
     }
 
-    process.start( "mkswap", { "-U", swapPartUuid, partPath } );
+    QProcess process;
+    process.start( "mkswap", { "-U", uuid, partPath } );
     process.waitForFinished();
     if ( process.exitCode() != 0 )
     {
@@ -276,38 +230,30 @@ ClearMountsJob::tryClearSwap( const QString& partPath )
 
 
 QString
-ClearMountsJob::tryCryptoClose( const QString& mapperPath )
+ClearMountsJob::tryDeactivateVolumeGroup( const QString& vgName )
 {
     QProcess process;
-    process.start( "cryptsetup", { "close", mapperPath } );
+    process.start( "vgchange", { "-an", vgName } );
     process.waitForFinished();
     if ( process.exitCode() == 0 )
     {
-        return QString( "Successfully closed mapper device %1." ).arg( mapperPath );
+        return QString( "Successfully disabled volume group %1." ).arg( vgName );
     }
 
     return QString();
 }
 
 
-QStringList
-ClearMountsJob::getCryptoDevices() const
+QString
+ClearMountsJob::tryCryptoClose( const QString& mapperPath )
 {
-    QDir mapperDir( "/dev/mapper" );
-    const QFileInfoList fiList = mapperDir.entryInfoList( QDir::Files );
-    QStringList list;
     QProcess process;
-    for ( const QFileInfo& fi : fiList )
+    process.start( "cryptsetup", { "close", mapperPath } );
+    process.waitForFinished();
+    if ( process.exitCode() == 0 )
     {
-        QString baseName = fi.baseName();
-        // Fedora live images use /dev/mapper/live-* internally. We must not
-        // unmount those devices, because they are used by the live image and
-        // because we need /dev/mapper/live-base in the unpackfs module.
-        if ( baseName == "control" || baseName.startsWith( "live-" ) )
-        {
-            continue;
-        }
-        list.append( fi.absoluteFilePath() );
+        return QString( "Successfully closed mapper device %1." ).arg( mapperPath );
     }
-    return list;
+
+    return QString();
 }
@@ -12,27 +12,37 @@
 
 #include "Job.h"
 
+#include "core/BlockTopology.h"
+
+#include <QList>
+
 class Device;
 
 /**
- * This job tries to free all mounts for the given device, so partitioning
+ * This job tries to free all mounts for the given devices, so partitioning
  * operations can proceed.
+ *
+ * Everything that is built on the devices (partitions, LVM volumes,
+ * LUKS containers) is unmounted and turned off, the topmost first.
  */
 class ClearMountsJob : public Calamares::Job
 {
     Q_OBJECT
 public:
     explicit ClearMountsJob( Device* device );
+    explicit ClearMountsJob( const QList< Device* >& devices );
     QString prettyName() const override;
     QString prettyStatusMessage() const override;
     Calamares::JobResult exec() override;
 
 private:
-    QString tryUmount( const QString& partPath );
-    QString tryClearSwap( const QString& partPath );
+    static bool isLiveDevice( const BlockTopology::Node& node );
+    QString tryUmount( const QString& mountPoint );
+    QString trySwapOff( const QString& partPath );
+    QString tryClearSwap( const QString& partPath, const QString& uuid );
+    QString tryDeactivateVolumeGroup( const QString& vgName );
     QString tryCryptoClose( const QString& mapperPath );
-    QStringList getCryptoDevices() const;
-    Device* m_device;
+    QList< Device* > m_devices;
 };
 
 #endif  // CLEARMOUNTSJOB_H
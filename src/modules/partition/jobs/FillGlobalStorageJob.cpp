@@ -19,6 +19,7 @@
 #include "JobQueue.h"
 #include "partition/FileSystem.h"
 #include "partition/PartitionIterator.h"
+#include "partition/Sync.h"
 #include "utils/Logger.h"
 
 #include <kpmcore/core/device.h>
@@ -37,32 +38,163 @@ using CalamaresUtils::Partition::userVisibleFS;
 
 typedef QHash< QString, QString > UuidForPartitionHash;
 
+/// @brief UUIDs found for partitions, by partition path
+struct PartitionUuids
+{
+    UuidForPartitionHash fs;  ///< Filesystem UUID (inside LUKS, if any)
+    UuidForPartitionHash luks;  ///< UUID of the LUKS container
+    UuidForPartitionHash part;  ///< Partition UUID, from the partition table
+};
+
+/** @brief Reads a udev /dev/disk/by-* directory
+ *
+ * Returns a map from the canonical device path (e.g. /dev/sda1) to
+ * the name of the link pointing to it (e.g. a UUID).
+ */
 static UuidForPartitionHash
-findPartitionUuids( QList< Device* > devices )
+readDiskLinks( const QString& directory )
 {
     UuidForPartitionHash hash;
+    QDir dir( directory );
+    const auto names = dir.entryList( QDir::Files | QDir::System | QDir::NoDotAndDotDot );
+    for ( const QString& name : names )
+    {
+        const QString target = QFileInfo( dir.filePath( name ) ).canonicalFilePath();
+        if ( !target.isEmpty() )
+        {
+            hash.insert( target, name );
+        }
+    }
+    return hash;
+}
+
+static QString
+canonicalDevicePath( const QString& path )
+{
+    const QString canonical = QFileInfo( path ).canonicalFilePath();
+    return canonical.isEmpty() ? path : canonical;
+}
+
+/** @brief Finds the UUIDs of all the partitions on @p devices
+ *
+ * The filesystem UUIDs (and partition UUIDs) are taken from the
+ * symlinks udev keeps in /dev/disk/by-uuid and /dev/disk/by-partuuid,
+ * which are read once for all partitions. Asking KPMcore for each
+ * partition would start blkid (or cryptsetup) every time; that is
+ * only done for partitions udev does not know about.
+ *
+ * For LUKS partitions, the returned UUID is that of the filesystem
+ * inside the container (like KPMcore does); the container UUID is
+ * kept separately in PartitionUuids::luks. The partitions themselves
+ * are not changed, @see storePartitionUuids().
+ */
+static PartitionUuids
+findPartitionUuids( QList< Device* > devices )
+{
+    const UuidForPartitionHash byUuid = readDiskLinks( QStringLiteral( "/dev/disk/by-uuid" ) );
+    const UuidForPartitionHash byPartUuid = readDiskLinks( QStringLiteral( "/dev/disk/by-partuuid" ) );
+
+    PartitionUuids uuids;
     foreach ( Device* device, devices )
     {
         for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
             Partition* p = *it;
-            QString path = p->partitionPath();
-            QString uuid = p->fileSystem().readUUID( p->partitionPath() );
-            hash.insert( path, uuid );
+            const QString path = p->partitionPath();
+            const QString canonical = canonicalDevicePath( path );
+
+            const QString partUuid = byPartUuid.value( canonical );
+            if ( !partUuid.isEmpty() )
+            {
+                uuids.part.insert( path, partUuid );
+            }
+
+            const FileSystem& fs = p->fileSystem();
+            QString uuid = byUuid.value( canonical );
+            // This is both LUKS1 and LUKS2, since FS::luks2 is a FS::luks
+            const FS::luks* luksFs = dynamic_cast< const FS::luks* >( &fs );
+            if ( luksFs )
+            {
+                if ( !uuid.isEmpty() )
+                {
+                    uuids.luks.insert( path, uuid );
+                }
+                if ( luksFs->innerFS() && !luksFs->mapperName().isEmpty() )
+                {
+                    uuid = byUuid.value( canonicalDevicePath( luksFs->mapperName() ) );
+                }
+            }
+
+            if ( uuid.isEmpty() )
+            {
+                uuid = fs.readUUID( path );
+            }
+            uuids.fs.insert( path, uuid );
         }
     }
 
-    if ( hash.isEmpty() )
+    if ( uuids.fs.isEmpty() )
     {
         cDebug() << "No UUIDs found for existing partitions.";
     }
-    return hash;
+    return uuids;
 }
 
+/** @brief Stores the UUIDs from findPartitionUuids() in the partitions
+ *
+ * This way, later jobs do not need to look them up again. It is done
+ * only when the job runs, after partitioning. Partitions that are new,
+ * or that are formatted, are skipped: KPMcore would use a UUID set on
+ * those when (re)creating the filesystem, e.g. for mkswap -U.
+ */
+static void
+storePartitionUuids( QList< Device* > devices, const PartitionUuids& uuids )
+{
+    for ( Device* device : devices )
+    {
+        for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
+        {
+            Partition* p = *it;
+            if ( p->state() == KPM_PARTITION_STATE( New ) || PartitionInfo::format( p ) )
+            {
+                continue;
+            }
+
+            const QString path = p->partitionPath();
+            const QString partUuid = uuids.part.value( path );
+            if ( !partUuid.isEmpty() && p->uuid().isEmpty() )
+            {
+                p->setUUID( partUuid );
+            }
+
+            const QString uuid = uuids.fs.value( path );
+            if ( uuid.isEmpty() )
+            {
+                continue;
+            }
+            FS::luks* luksFs = dynamic_cast< FS::luks* >( &p->fileSystem() );
+            if ( !luksFs )
+            {
+                p->fileSystem().setUUID( uuid );
+            }
+            else if ( luksFs->innerFS() )
+            {
+                luksFs->innerFS()->setUUID( uuid );
+            }
+        }
+    }
+}
 
+/// @brief The UUID of the LUKS container itself (not of the filesystem inside)
 static QString
-getLuksUuid( const QString& path )
+getLuksUuid( const QString& path, const PartitionUuids& uuids )
 {
+    const QString uuid = uuids.luks.value( path );
+    if ( !uuid.isEmpty() )
+    {
+        return uuid;
+    }
+
     QProcess process;
     process.setProgram( "cryptsetup" );
     process.setArguments( { "luksUUID", path } );
@@ -72,18 +204,19 @@ getLuksUuid( const QString& path )
     {
         return QString();
     }
-    QString uuid = QString::fromLocal8Bit( process.readAllStandardOutput() ).trimmed();
-    return uuid;
+    return QString::fromLocal8Bit( process.readAllStandardOutput() ).trimmed();
 }
 
 
 static QVariant
-mapForPartition( Partition* partition, const QString& uuid )
+mapForPartition( Partition* partition, const PartitionUuids& uuids )
 {
+    const QString uuid = uuids.fs.value( partition->partitionPath() );
     QVariantMap map;
     map[ "device" ] = partition->partitionPath();
     map[ "partlabel" ] = partition->label();
-    map[ "partuuid" ] = partition->uuid();
+    map[ "partuuid" ]
+        = partition->uuid().isEmpty() ? uuids.part.value( partition->partitionPath() ) : partition->uuid();
 #ifdef WITH_KPMCORE42API
     map[ "parttype" ] = partition->type();
     map[ "partattrs" ] = partition->attributes();
@@ -91,10 +224,10 @@ mapForPartition( Partition* partition, const QString& uuid )
     map[ "mountPoint" ] = PartitionInfo::mountPoint( partition );
     map[ "fsName" ] = userVisibleFS( partition->fileSystem() );
     map[ "fs" ] = untranslatedFS( partition->fileSystem() );
-    if ( partition->fileSystem().type() == FileSystem::Luks
-         && dynamic_cast< FS::luks& >( partition->fileSystem() ).innerFS() )
+    const FS::luks* luksFs = dynamic_cast< const FS::luks* >( &partition->fileSystem() );
+    if ( luksFs && luksFs->innerFS() )
     {
-        map[ "fs" ] = untranslatedFS( dynamic_cast< FS::luks& >( partition->fileSystem() ).innerFS() );
+        map[ "fs" ] = untranslatedFS( luksFs->innerFS() );
     }
     map[ "uuid" ] = uuid;
     map[ "claimed" ] = PartitionInfo::format( partition );  // If we formatted it, it's ours
@@ -112,12 +245,10 @@ mapForPartition( Partition* partition, const QString& uuid )
 
     if ( partition->roles().has( PartitionRole::Luks ) )
     {
-        const FileSystem& fsRef = partition->fileSystem();
-        const FS::luks* luksFs = dynamic_cast< const FS::luks* >( &fsRef );
         if ( luksFs )
         {
             map[ "luksMapperName" ] = luksFs->mapperName().split( "/" ).last();
-            map[ "luksUuid" ] = getLuksUuid( partition->partitionPath() );
+            map[ "luksUuid" ] = getLuksUuid( partition->partitionPath(), uuids );
             map[ "luksPassphrase" ] = luksFs->passphrase();
             deb << TR( "luksMapperName:", map[ "luksMapperName" ].toString() );
         }
@@ -144,7 +275,7 @@ FillGlobalStorageJob::prettyDescription() const
 {
     QStringList lines;
 
-    const auto partitionList = createPartitionList();
+    const auto partitionList = createPartitionList( findPartitionUuids( m_devices ) );
     for ( const QVariant& partitionItem : partitionList )
     {
         if ( partitionItem.type() == QVariant::Map )
@@ -250,7 +381,11 @@ Calamares::JobResult
 FillGlobalStorageJob::exec()
 {
     Calamares::GlobalStorage* storage = Calamares::JobQueue::instance()->globalStorage();
-    const auto partitions = createPartitionList();
+    // Let udev catch up with the partitioning, so that the UUID links are current
+    CalamaresUtils::Partition::sync();
+    const PartitionUuids uuids = findPartitionUuids( m_devices );
+    storePartitionUuids( m_devices, uuids );
+    const auto partitions = createPartitionList( uuids );
     cDebug() << "Saving partition information map to GlobalStorage[\"partitions\"]";
     storage->insert( "partitions", partitions );
     storeFSUse( storage, partitions );
@@ -274,9 +409,8 @@ FillGlobalStorageJob::exec()
 }
 
 QVariantList
-FillGlobalStorageJob::createPartitionList() const
+FillGlobalStorageJob::createPartitionList( const PartitionUuids& uuids ) const
 {
-    UuidForPartitionHash hash = findPartitionUuids( m_devices );
     QVariantList lst;
     cDebug() << "Building partition information map";
     for ( auto device : m_devices )
@@ -285,7 +419,7 @@ FillGlobalStorageJob::createPartitionList() const
         for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
             // Debug-logging is done when creating the map
-            lst << mapForPartition( *it, hash.value( ( *it )->partitionPath() ) );
+            lst << mapForPartition( *it, uuids );
         }
     }
     return lst;
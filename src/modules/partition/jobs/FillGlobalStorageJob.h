@@ -19,6 +19,7 @@
 class Config;
 class Device;
 class Partition;
+struct PartitionUuids;
 
 /**
  * This job does not touch devices. It inserts in GlobalStorage the
@@ -42,7 +43,7 @@ private:
     QList< Device* > m_devices;
     QString m_bootLoaderPath;
 
-    QVariantList createPartitionList() const;
+    QVariantList createPartitionList( const PartitionUuids& uuids ) const;
     QVariant createBootLoaderMap() const;
 };
 
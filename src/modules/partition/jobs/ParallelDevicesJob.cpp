@@ -0,0 +1,152 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "ParallelDevicesJob.h"
+
+#include "utils/Logger.h"
+
+#include <QFuture>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+
+#include <functional>
+#include <numeric>
+
+namespace
+{
+/// @brief A JobResult that can be copied out of a worker thread
+struct Outcome
+{
+    bool ok = true;
+    QString message;
+    QString details;
+};
+
+/** @brief Runs @p jobs in order, stopping at the first failure
+ *
+ * After each progress step, @p report is called with the weight
+ * of the jobs that are done (a part of the running job's weight).
+ */
+Outcome
+runJobs( const Calamares::JobList& jobs, const std::function< void( qreal ) >& report )
+{
+    qreal done = 0.0;
+    for ( const auto& job : jobs )
+    {
+        cDebug() << "Starting job" << job->prettyName();
+        const qreal weight = job->getJobWeight();
+        // The job emits progress from this thread, so this is a direct connection
+        auto connection = QObject::connect( job.data(), &Calamares::Job::progress, [&]( qreal percent ) {
+            report( done + weight * qBound( 0.0, percent, 1.0 ) );
+        } );
+        Calamares::JobResult r = job->exec();
+        QObject::disconnect( connection );
+        if ( !r )
+        {
+            return { false, r.message(), r.details() };
+        }
+        done += weight;
+        report( done );
+    }
+    return {};
+}
+}  // namespace
+
+ParallelDevicesJob::ParallelDevicesJob( const QList< Calamares::JobList >& jobsPerDevice )
+    : Calamares::Job()
+    , m_jobs( jobsPerDevice )
+{
+}
+
+int
+ParallelDevicesJob::getJobWeight() const
+{
+    int weight = 0;
+    for ( const auto& jobs : m_jobs )
+    {
+        for ( const auto& job : jobs )
+        {
+            weight += job->getJobWeight();
+        }
+    }
+    return qMax( 1, weight );
+}
+
+QString
+ParallelDevicesJob::prettyName() const
+{
+    return tr( "Partition %n disk(s)", "", m_jobs.count() );
+}
+
+QString
+ParallelDevicesJob::prettyDescription() const
+{
+    // The summary shows what happens to each disk, not how
+    QStringList lines;
+    for ( const auto& jobs : m_jobs )
+    {
+        for ( const auto& job : jobs )
+        {
+            if ( !job->prettyDescription().isEmpty() )
+            {
+                lines.append( job->prettyDescription() );
+            }
+        }
+    }
+    return lines.join( "<br/>" );
+}
+
+QString
+ParallelDevicesJob::prettyStatusMessage() const
+{
+    return tr( "Partitioning %n disk(s) at the same time.", "", m_jobs.count() );
+}
+
+Calamares::JobResult
+ParallelDevicesJob::exec()
+{
+    // A pool of our own, so that each disk gets a thread
+    QThreadPool pool;
+    pool.setMaxThreadCount( m_jobs.count() );
+
+    // Overall progress is the weight done on all the disks, like the JobQueue does it
+    const qreal totalWeight = getJobWeight();
+    QVector< qreal > doneWeight( m_jobs.count(), 0.0 );
+    QMutex progressMutex;
+
+    QList< QFuture< Outcome > > futures;
+    for ( int i = 0; i < m_jobs.count(); ++i )
+    {
+        std::function< void( qreal ) > report = [this, i, totalWeight, &doneWeight, &progressMutex]( qreal done ) {
+            QMutexLocker lock( &progressMutex );
+            doneWeight[ i ] = done;
+            emit progress( std::accumulate( doneWeight.cbegin(), doneWeight.cend(), 0.0 ) / totalWeight );
+        };
+        futures.append( QtConcurrent::run( &pool, runJobs, m_jobs.at( i ), report ) );
+    }
+
+    // Wait for all the disks, even if one fails: the others are still being changed
+    Outcome failure;
+    for ( auto& f : futures )
+    {
+        f.waitForFinished();
+        const Outcome o = f.result();
+        if ( !o.ok && failure.ok )
+        {
+            failure = o;
+        }
+    }
+
+    if ( failure.ok )
+    {
+        return Calamares::JobResult::ok();
+    }
+    return Calamares::JobResult::error( failure.message, failure.details );
+}
@@ -0,0 +1,49 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARALLELDEVICESJOB_H
+#define PARALLELDEVICESJOB_H
+
+#include "Job.h"
+
+#include <QList>
+
+/**
+ * This job runs the jobs for several disks at the same time.
+ *
+ * Each list of jobs is run in order, in a thread of its own, so all
+ * the changes to one disk are still serialized. Different disks do
+ * not depend on each other, so e.g. formatting a large /home disk
+ * does not have to wait until the system disk is done.
+ *
+ * This assumes that KPMcore operations on different devices can run
+ * at the same time; see parallelDevices in partition.conf.
+ *
+ * The progress of the jobs is forwarded, weighted by their job weight.
+ * If a job fails, the remaining jobs for that disk are skipped, but the
+ * other disks are always waited for.
+ */
+class ParallelDevicesJob : public Calamares::Job
+{
+    Q_OBJECT
+public:
+    /// @brief Runs each list in @p jobsPerDevice in parallel with the others
+    explicit ParallelDevicesJob( const QList< Calamares::JobList >& jobsPerDevice );
+
+    int getJobWeight() const override;
+    QString prettyName() const override;
+    QString prettyDescription() const override;
+    QString prettyStatusMessage() const override;
+    Calamares::JobResult exec() override;
+
+private:
+    QList< Calamares::JobList > m_jobs;
+};
+
+#endif  // PARALLELDEVICESJOB_H
@@ -9,16 +9,15 @@
 
 #include "ClearMountsJobTests.h"
 
+#include "core/BlockTopology.h"
+
 #include "utils/Logger.h"
 
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
 QTEST_GUILESS_MAIN( ClearMountsJobTests )
 
-
-/* Not exactly public API */
-QStringList getPartitionsForDevice( const QString& deviceName );
-
 QStringList
 getPartitionsForDevice_other( const QString& deviceName )
 {
@@ -50,11 +49,88 @@ ClearMountsJobTests::ClearMountsJobTests()
 void
 ClearMountsJobTests::testFindPartitions()
 {
-    QStringList partitions = getPartitionsForDevice( "sda" );
+    QStringList partitions = BlockTopology::snapshot().partitions( "sda" );
     QStringList other_part = getPartitionsForDevice_other( "sda" );
 
-    cDebug() << "Initial implementation:" << Logger::DebugList( partitions );
+    cDebug() << "Topology implementation:" << Logger::DebugList( partitions );
     cDebug() << "Other implementation:" << Logger::DebugList( other_part );
 
+    other_part.sort();
     QCOMPARE( partitions, other_part );
 }
+
+/// @brief Writes @p value to file @p name below @p dir, creating directories as needed
+static bool
+writeFile( const QDir& dir, const QString& name, const QByteArray& value )
+{
+    if ( !dir.mkpath( QFileInfo( dir.filePath( name ) ).path() ) )
+    {
+        return false;
+    }
+    QFile f( dir.filePath( name ) );
+    return f.open( QIODevice::WriteOnly ) && f.write( value ) == value.size();
+}
+
+/** @brief Adds block device @p name to a fake sysfs in @p dir
+ *
+ * Like the kernel, the device's directory is in devices/, below
+ * its @p parent for partitions, with a link from class/block.
+ */
+static bool
+addDevice( const QDir& dir, const QString& name, const QString& parent, const QByteArray& deviceNumber )
+{
+    const QString path = parent.isEmpty() ? QStringLiteral( "devices/%1" ).arg( name )
+                                          : QStringLiteral( "devices/%1/%2" ).arg( parent, name );
+    return dir.mkpath( path + QStringLiteral( "/holders" ) )
+        && writeFile( dir, path + QStringLiteral( "/dev" ), deviceNumber )
+        && ( parent.isEmpty() || writeFile( dir, path + QStringLiteral( "/partition" ), "1" ) )
+        && dir.mkpath( QStringLiteral( "class/block" ) )
+        && QFile::link( dir.filePath( path ), dir.filePath( QStringLiteral( "class/block/" ) + name ) );
+}
+
+void
+ClearMountsJobTests::testStackedOn()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    const QDir root( tempRoot.path() );
+
+    // LVM on LUKS on sda2, a plain sda1 and an unrelated sdb
+    QVERIFY( addDevice( root, "sda", QString(), "8:0" ) );
+    QVERIFY( addDevice( root, "sda1", "sda", "8:1" ) );
+    QVERIFY( addDevice( root, "sda2", "sda", "8:2" ) );
+    QVERIFY( addDevice( root, "dm-0", QString(), "253:0" ) );
+    QVERIFY( addDevice( root, "dm-1", QString(), "253:1" ) );
+    QVERIFY( addDevice( root, "sdb", QString(), "8:16" ) );
+    QVERIFY( root.mkpath( "devices/sda/sda2/holders/dm-0" ) );
+    QVERIFY( root.mkpath( "devices/dm-0/holders/dm-1" ) );
+    QVERIFY( writeFile( root, "devices/dm-0/dm/name", "luks-1234\n" ) );
+    QVERIFY( writeFile( root, "devices/dm-0/dm/uuid", "CRYPT-LUKS2-1234-luks-1234\n" ) );
+    QVERIFY( writeFile( root, "devices/dm-1/dm/name", "vg--sys-root\n" ) );
+    QVERIFY( writeFile( root, "devices/dm-1/dm/uuid", "LVM-5678\n" ) );
+    QVERIFY( writeFile( root,
+                        "proc/self/mountinfo",
+                        "22 1 253:1 / /tmp/calamares-root rw,relatime shared:1 - ext4 /dev/mapper/vg--sys-root rw\n"
+                        "23 22 8:1 / /mnt/my\\040stick rw,relatime shared:2 - vfat /dev/sda1 rw\n" ) );
+
+    const BlockTopology topology = BlockTopology::read( root.filePath( "class/block" ), root.filePath( "proc" ) );
+    QCOMPARE( topology.partitions( "sda" ), QStringList( { "sda1", "sda2" } ) );
+    QVERIFY( topology.partitions( "sdb" ).isEmpty() );
+
+    const auto* crypt = topology.node( "dm-0" );
+    QVERIFY( crypt );
+    QVERIFY( crypt->isCrypt() );
+    QCOMPARE( crypt->devicePath, QStringLiteral( "/dev/mapper/luks-1234" ) );
+    const auto* volume = topology.node( "dm-1" );
+    QVERIFY( volume );
+    QVERIFY( volume->isLvm() );
+    QCOMPARE( volume->volumeGroup(), QStringLiteral( "vg-sys" ) );
+    QCOMPARE( volume->mountPoints, QStringList( { "/tmp/calamares-root" } ) );
+    QCOMPARE( topology.node( "sda1" )->mountPoints, QStringList( { "/mnt/my stick" } ) );
+    QCOMPARE( topology.node( "sda2" )->parent, QStringLiteral( "sda" ) );
+
+    // Everything built on a device comes before it, and the disk comes last
+    QCOMPARE( topology.stackedOn( "sda" ), QStringList( { "sda1", "dm-1", "dm-0", "sda2", "sda" } ) );
+    QCOMPARE( topology.stackedOn( "sdb" ), QStringList( { "sdb" } ) );
+    QVERIFY( topology.stackedOn( "nvme0n1" ).isEmpty() );
+}
@@ -20,6 +20,7 @@ public:
 
 private Q_SLOTS:
     void testFindPartitions();
+    void testStackedOn();
 };
 
 #endif
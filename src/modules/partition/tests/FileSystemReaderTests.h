@@ -0,0 +1,28 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef FILESYSTEMREADERTESTS_H
+#define FILESYSTEMREADERTESTS_H
+
+#include <QObject>
+
+class FileSystemReaderTests : public QObject
+{
+    Q_OBJECT
+public:
+    FileSystemReaderTests();
+
+private Q_SLOTS:
+    void testNotAFileSystem();
+    void testExt_data();
+    void testExt();
+    void testBtrfs();
+};
+
+#endif
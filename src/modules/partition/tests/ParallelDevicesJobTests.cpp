@@ -0,0 +1,163 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "ParallelDevicesJobTests.h"
+
+#include "jobs/ParallelDevicesJob.h"
+
+#include "utils/Logger.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QtTest/QtTest>
+
+QTEST_GUILESS_MAIN( ParallelDevicesJobTests )
+
+namespace
+{
+/// @brief The names of the jobs that have run, in the order they finished
+struct RunLog
+{
+    QMutex mutex;
+    QStringList names;
+
+    void append( const QString& name )
+    {
+        QMutexLocker lock( &mutex );
+        names.append( name );
+    }
+};
+
+/// @brief A job that sleeps, reports half-way progress, and logs its name
+class FakeJob : public Calamares::Job
+{
+public:
+    FakeJob( RunLog& log, const QString& name, unsigned long msec, bool succeed = true, int weight = 1 )
+        : m_log( log )
+        , m_name( name )
+        , m_msec( msec )
+        , m_succeed( succeed )
+        , m_weight( weight )
+    {
+    }
+
+    int getJobWeight() const override { return m_weight; }
+    QString prettyName() const override { return m_name; }
+    Calamares::JobResult exec() override
+    {
+        QThread::msleep( m_msec / 2 );
+        emit progress( 0.5 );
+        QThread::msleep( m_msec / 2 );
+        m_log.append( m_name );
+        return m_succeed ? Calamares::JobResult::ok()
+                         : Calamares::JobResult::error( m_name + QStringLiteral( " failed" ) );
+    }
+
+private:
+    RunLog& m_log;
+    QString m_name;
+    unsigned long m_msec;
+    bool m_succeed;
+    int m_weight;
+};
+
+Calamares::job_ptr
+fake( RunLog& log, const QString& name, unsigned long msec, bool succeed = true, int weight = 1 )
+{
+    return Calamares::job_ptr( new FakeJob( log, name, msec, succeed, weight ) );
+}
+
+/// @brief The names in @p log that start with @p prefix, in order
+QStringList
+jobsOf( const RunLog& log, const QString& prefix )
+{
+    QStringList l;
+    for ( const auto& name : log.names )
+    {
+        if ( name.startsWith( prefix ) )
+        {
+            l.append( name );
+        }
+    }
+    return l;
+}
+}  // namespace
+
+ParallelDevicesJobTests::ParallelDevicesJobTests() {}
+
+void
+ParallelDevicesJobTests::testOrdering()
+{
+    RunLog log;
+    // The first jobs of sda are the slowest, so a free-for-all would finish them last
+    ParallelDevicesJob job( {
+        { fake( log, "sda-1", 60 ), fake( log, "sda-2", 40 ), fake( log, "sda-3", 0 ) },
+        { fake( log, "sdb-1", 0 ), fake( log, "sdb-2", 20 ), fake( log, "sdb-3", 0 ) },
+        { fake( log, "sdc-1", 10 ) },
+    } );
+
+    QCOMPARE( job.getJobWeight(), 7 );
+    QVERIFY( job.exec() );
+    QCOMPARE( log.names.count(), 7 );
+    QCOMPARE( jobsOf( log, "sda" ), QStringList( { "sda-1", "sda-2", "sda-3" } ) );
+    QCOMPARE( jobsOf( log, "sdb" ), QStringList( { "sdb-1", "sdb-2", "sdb-3" } ) );
+    QCOMPARE( jobsOf( log, "sdc" ), QStringList( { "sdc-1" } ) );
+    // The disks run at the same time, so sdb is done before sda's first job
+    QCOMPARE( log.names.last(), QStringLiteral( "sda-3" ) );
+}
+
+void
+ParallelDevicesJobTests::testFailure()
+{
+    RunLog log;
+    ParallelDevicesJob job( {
+        { fake( log, "sda-1", 0, false ), fake( log, "sda-2", 0 ) },
+        { fake( log, "sdb-1", 50 ), fake( log, "sdb-2", 50 ) },
+        { fake( log, "sdc-1", 20 ), fake( log, "sdc-2", 20, false ), fake( log, "sdc-3", 0 ) },
+    } );
+
+    const auto result = job.exec();
+    QVERIFY( !result );
+    // The first disk's failure is reported
+    QCOMPARE( result.message(), QStringLiteral( "sda-1 failed" ) );
+    // A failed disk stops, but the others are still waited for
+    QCOMPARE( jobsOf( log, "sda" ), QStringList( { "sda-1" } ) );
+    QCOMPARE( jobsOf( log, "sdb" ), QStringList( { "sdb-1", "sdb-2" } ) );
+    QCOMPARE( jobsOf( log, "sdc" ), QStringList( { "sdc-1", "sdc-2" } ) );
+}
+
+void
+ParallelDevicesJobTests::testProgress()
+{
+    RunLog log;
+    ParallelDevicesJob job( {
+        { fake( log, "sda-1", 20, true, 3 ), fake( log, "sda-2", 20, true, 1 ) },
+        { fake( log, "sdb-1", 40, true, 4 ) },
+    } );
+    QCOMPARE( job.getJobWeight(), 8 );
+
+    // Progress comes from the worker threads
+    QMutex mutex;
+    QList< qreal > reports;
+    QObject::connect( &job, &Calamares::Job::progress, [&]( qreal percent ) {
+        QMutexLocker lock( &mutex );
+        reports.append( percent );
+    } );
+
+    QVERIFY( job.exec() );
+    // Each job reports half-way and at the end
+    QCOMPARE( reports.count(), 6 );
+    QCOMPARE( reports.last(), 1.0 );
+    for ( int i = 1; i < reports.count(); ++i )
+    {
+        QVERIFY( reports.at( i - 1 ) < reports.at( i ) );
+    }
+    // Half of sda-1, or half of sdb-1, is reported first
+    QVERIFY( reports.first() == 1.5 / 8 || reports.first() == 2.0 / 8 );
+}
@@ -0,0 +1,27 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARALLELDEVICESJOBTESTS_H
+#define PARALLELDEVICESJOBTESTS_H
+
+#include <QObject>
+
+class ParallelDevicesJobTests : public QObject
+{
+    Q_OBJECT
+public:
+    ParallelDevicesJobTests();
+
+private Q_SLOTS:
+    void testOrdering();
+    void testFailure();
+    void testProgress();
+};
+
+#endif
@@ -0,0 +1,207 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "PartitionModelTests.h"
+
+#include "core/KPMHelpers.h"
+#include "core/PartitionModel.h"
+#include "jobs/CreatePartitionJob.h"
+#include "jobs/DeletePartitionJob.h"
+#include "jobs/ResizePartitionJob.h"
+
+#include "partition/KPMHelper.h"
+#include "partition/KPMManager.h"
+#include "partition/PartitionQuery.h"
+#include "utils/Logger.h"
+#include "utils/Units.h"
+
+#include <QSignalSpy>
+#include <QtTest/QtTest>
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 11, 0 )
+#include <QAbstractItemModelTester>
+#endif
+
+#include <memory>
+
+QTEST_GUILESS_MAIN( PartitionModelTests )
+
+using CalamaresUtils::operator""_MiB;
+using CalamaresUtils::Partition::isPartitionFreeSpace;
+
+static CalamaresUtils::Partition::KPMManager* kpmcore = nullptr;
+
+static constexpr qint64 sectorSize = 512;
+
+#ifdef WITH_KPMCORE4API
+// As in CreateLayoutsTests, there is no clean way to instantiate a test Device
+class SmartStatus;
+class DevicePrivate
+{
+public:
+    QString m_Name;
+    QString m_DeviceNode;
+    qint64 m_LogicalSectorSize;
+    qint64 m_TotalLogical;
+    PartitionTable* m_PartitionTable;
+    QString m_IconName;
+    std::shared_ptr< SmartStatus > m_SmartStatus;
+    Device::Type m_Type;
+};
+#endif
+
+/// @brief A 1GiB device with an (empty) MSDOS partition table
+class TestDevice : public Device
+{
+public:
+#ifdef WITH_KPMCORE4API
+    TestDevice()
+        : Device( std::make_shared< DevicePrivate >(),
+                  QStringLiteral( "test" ),
+                  QStringLiteral( "/dev/test" ),
+                  sectorSize,
+                  1024_MiB / sectorSize,
+                  QString(),
+                  Device::Type::Unknown_Device )
+#else
+    TestDevice()
+        : Device( QStringLiteral( "test" ),
+                  QStringLiteral( "/dev/test" ),
+                  sectorSize,
+                  1024_MiB / sectorSize,
+                  QString(),
+                  Device::Type::Unknown_Device )
+#endif
+    {
+        setPartitionTable( new PartitionTable( PartitionTable::msdos,
+                                               PartitionTable::defaultFirstUsable( *this, PartitionTable::msdos ),
+                                               PartitionTable::defaultLastUsable( *this, PartitionTable::msdos ) ) );
+        partitionTable()->updateUnallocated( *this );
+    }
+};
+
+static Partition*
+firstFreePartition( PartitionNode* parent )
+{
+    for ( auto* child : parent->children() )
+    {
+        if ( isPartitionFreeSpace( child ) )
+        {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+/// @brief Creates a partition at the start of the first free space in @p parent, like PartitionCoreModule does
+static Partition*
+createPartition( Device& device, PartitionNode* parent, PartitionRole::Roles role, FileSystem::Type type, qint64 size )
+{
+    Partition* freeSpace = firstFreePartition( parent );
+    if ( !freeSpace )
+    {
+        return nullptr;
+    }
+    const qint64 firstSector = freeSpace->firstSector();
+    const qint64 lastSector = size > 0 ? firstSector + size / sectorSize - 1 : freeSpace->lastSector();
+    Partition* partition = KPMHelpers::createNewPartition(
+        parent, device, PartitionRole( role ), type, firstSector, lastSector, PartitionTable::Flags() );
+    CreatePartitionJob( &device, partition ).updatePreview();
+    return partition;
+}
+
+/// @brief Checks that the rows below @p parent are the partitions in @p node
+static void
+compareRows( const PartitionModel& model, const QModelIndex& parent, PartitionNode* node )
+{
+    QCOMPARE( model.rowCount( parent ), node->children().count() );
+    for ( int row = 0; row < node->children().count(); ++row )
+    {
+        const QModelIndex index = model.index( row, 0, parent );
+        QCOMPARE( model.partitionForIndex( index ), node->children().at( row ) );
+        QCOMPARE( model.parent( index ), parent );
+        compareRows( model, index, node->children().at( row ) );
+    }
+}
+
+PartitionModelTests::PartitionModelTests() {}
+
+void
+PartitionModelTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    kpmcore = new CalamaresUtils::Partition::KPMManager();
+}
+
+void
+PartitionModelTests::cleanupTestCase()
+{
+    delete kpmcore;
+    kpmcore = nullptr;
+}
+
+void
+PartitionModelTests::testExtended()
+{
+    TestDevice device;
+    PartitionTable* table = device.partitionTable();
+    QVERIFY( createPartition( device, table, PartitionRole::Primary, FileSystem::Ext4, 100_MiB ) );
+    Partition* extended = createPartition( device, table, PartitionRole::Extended, FileSystem::Extended, 0 );
+    QVERIFY( extended );
+    Partition* logical = createPartition( device, extended, PartitionRole::Logical, FileSystem::Ext4, 100_MiB );
+    QVERIFY( logical );
+
+    PartitionModel model;
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 11, 0 )
+    QAbstractItemModelTester tester( &model, QAbstractItemModelTester::FailureReportingMode::QtTest );
+#endif
+    model.init( &device, OsproberEntryList() );
+    compareRows( model, QModelIndex(), table );
+
+    // Changes are signalled row-by-row, so views keep their indexes
+    QSignalSpy resets( &model, &QAbstractItemModel::modelReset );
+    QSignalSpy changes( &model, &PartitionModel::partitionsChanged );
+    const QPersistentModelIndex extendedIndex = model.index( table->children().indexOf( extended ), 0 );
+    const QPersistentModelIndex logicalIndex = model.index( 0, 0, extendedIndex );
+    QCOMPARE( model.partitionForIndex( logicalIndex ), logical );
+
+    // Create a second logical partition, in the free space after the first
+    Partition* second = nullptr;
+    {
+        PartitionModel::ResetHelper helper( &model );
+        second = createPartition( device, extended, PartitionRole::Logical, FileSystem::Ext4, 200_MiB );
+    }
+    QVERIFY( second );
+    compareRows( model, QModelIndex(), table );
+    QCOMPARE( model.partitionForIndex( logicalIndex ), logical );
+
+    // Shrink the first one, which makes free space in between
+    {
+        PartitionModel::ResetHelper helper( &model );
+        ResizePartitionJob(
+            &device, logical, logical->firstSector(), logical->firstSector() + 50_MiB / sectorSize - 1 )
+            .updatePreview();
+    }
+    compareRows( model, QModelIndex(), table );
+    QCOMPARE( model.partitionForIndex( logicalIndex ), logical );
+    QCOMPARE( model.rowCount( extendedIndex ), 4 );  // logical, free, second, free
+
+    // Delete the second one; the free space around it is merged
+    {
+        PartitionModel::ResetHelper helper( &model );
+        DeletePartitionJob( &device, second ).updatePreview();
+        delete second;
+    }
+    compareRows( model, QModelIndex(), table );
+    QCOMPARE( model.partitionForIndex( logicalIndex ), logical );
+    QCOMPARE( model.partitionForIndex( extendedIndex ), extended );
+    QCOMPARE( model.rowCount( extendedIndex ), 2 );
+
+    QCOMPARE( resets.count(), 0 );
+    QCOMPARE( changes.count(), 3 );
+}
@@ -0,0 +1,28 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PARTITIONMODELTESTS_H
+#define PARTITIONMODELTESTS_H
+
+#include <QObject>
+
+class PartitionModelTests : public QObject
+{
+    Q_OBJECT
+public:
+    PartitionModelTests();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testExtended();
+};
+
+#endif
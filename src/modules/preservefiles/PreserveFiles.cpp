@@ -12,13 +12,9 @@
 #include "JobQueue.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/CommandList.h"
+#include "utils/CopyFile.h"
 #include "utils/Logger.h"
 #include "utils/Permissions.h"
-#include "utils/Units.h"
-
-#include <QFile>
-
-using CalamaresUtils::operator""_MiB;
 
 QString
 targetPrefix()
@@ -79,37 +75,6 @@ PreserveFiles::prettyName() const
     return tr( "Saving files for later ..." );
 }
 
-static bool
-copy_file( const QString& source, const QString& dest )
-{
-    QFile sourcef( source );
-    if ( !sourcef.open( QFile::ReadOnly ) )
-    {
-        cWarning() << "Could not read" << source;
-        return false;
-    }
-
-    QFile destf( dest );
-    if ( !destf.open( QFile::WriteOnly ) )
-    {
-        sourcef.close();
-        cWarning() << "Could not open" << destf.fileName() << "for writing; could not copy" << source;
-        return false;
-    }
-
-    QByteArray b;
-    do
-    {
-        b = sourcef.read( 1_MiB );
-        destf.write( b );
-    } while ( b.count() > 0 );
-
-    sourcef.close();
-    destf.close();
-
-    return true;
-}
-
 Calamares::JobResult
 PreserveFiles::exec()
 {
@@ -152,7 +117,7 @@ PreserveFiles::exec()
         }
         else
         {
-            if ( copy_file( source, dest ) )
+            if ( CalamaresUtils::copyFile( source, dest ) )
             {
                 if ( it.perm.isValid() )
                 {
@@ -0,0 +1,581 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "AccountDatabase.h"
+
+#include "utils/Logger.h"
+
+#include <QByteArrayList>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+
+#include <sys/stat.h>
+#ifndef __FreeBSD__
+#include <sys/xattr.h>
+#endif
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+
+/** @brief Reads a file of settings, skipping comments
+ *
+ * /etc/login.defs has "KEY VALUE" lines, /etc/default/useradd has
+ * "KEY=VALUE" lines; @p separator tells which one it is.
+ */
+static QHash< QString, QString >
+readSettings( const QString& path, QChar separator )
+{
+    QHash< QString, QString > settings;
+    QFile f( path );
+    if ( !f.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        return settings;
+    }
+
+    const auto lines = f.readAll().split( '\n' );
+    for ( const QByteArray& rawLine : lines )
+    {
+        const QString line = QString::fromUtf8( rawLine ).simplified();
+        if ( line.isEmpty() || line.startsWith( '#' ) )
+        {
+            continue;
+        }
+        const int split = line.indexOf( separator );
+        if ( split < 1 )
+        {
+            continue;
+        }
+        QString value = line.mid( split + 1 ).trimmed();
+        if ( value.length() >= 2 && value.startsWith( '"' ) && value.endsWith( '"' ) )
+        {
+            value = value.mid( 1, value.length() - 2 );
+        }
+        settings.insert( line.left( split ).trimmed(), value );
+    }
+    return settings;
+}
+
+/// @brief Can @p s be stored in a field of the account files?
+static bool
+isValidField( const QString& s )
+{
+    return !s.contains( ':' ) && !s.contains( '\n' );
+}
+
+/** @brief Picks an unused id between @p min and @p max (inclusive)
+ *
+ * Like shadow-utils, system ids are taken from the top of the range
+ * down; other ids are one more than the highest one in use (or the
+ * lowest free one, if the top of the range is taken already).
+ * Returns -1 if the range is full.
+ */
+static int
+freeId( const QList< int >& used, int min, int max, bool fromTop )
+{
+    if ( fromTop )
+    {
+        for ( int id = max; id >= min; --id )
+        {
+            if ( !used.contains( id ) )
+            {
+                return id;
+            }
+        }
+        return -1;
+    }
+
+    int highest = min - 1;
+    for ( int id : used )
+    {
+        if ( id >= min && id <= max && id > highest )
+        {
+            highest = id;
+        }
+    }
+    if ( highest < max )
+    {
+        return highest + 1;
+    }
+    for ( int id = min; id <= max; ++id )
+    {
+        if ( !used.contains( id ) )
+        {
+            return id;
+        }
+    }
+    return -1;
+}
+
+/// @brief A number of days for /etc/shadow, or empty if @p value is not one
+static QByteArray
+shadowDays( const QString& value )
+{
+    bool ok = false;
+    const int days = value.toInt( &ok );
+    return ( ok && days >= 0 ) ? QByteArray::number( days ) : QByteArray();
+}
+
+/** @brief Gives the file open as @p fd the SELinux label of @p original
+ *
+ * The label is copied as an extended attribute, so this works whether
+ * or not the host system uses SELinux. A file without a label (or on
+ * a filesystem without labels) is fine, too.
+ */
+static bool
+copySecurityLabel( const QString& original, int fd )
+{
+#ifdef __FreeBSD__
+    Q_UNUSED( original )
+    Q_UNUSED( fd )
+    return true;
+#else
+    static const char name[] = "security.selinux";
+    const QByteArray path = QFile::encodeName( original );
+    const ssize_t size = ::getxattr( path.constData(), name, nullptr, 0 );
+    if ( size < 0 )
+    {
+        return errno == ENODATA || errno == ENOTSUP;
+    }
+    QByteArray label( static_cast< int >( size ), '\0' );
+    const ssize_t labelSize = ::getxattr( path.constData(), name, label.data(), static_cast< size_t >( size ) );
+    return labelSize >= 0 && ::fsetxattr( fd, name, label.constData(), static_cast< size_t >( labelSize ), 0 ) == 0;
+#endif
+}
+
+/** @brief Writes @p contents to @p temp, to replace @p original later
+ *
+ * The new file gets the owner, mode and SELinux label of the original,
+ * since e.g. /etc/shadow must not become world-readable, and a file
+ * labeled like /etc is not readable for login in an enforcing target.
+ */
+static bool
+writeReplacement( const QString& original, const QString& temp, const QByteArray& contents )
+{
+    struct stat st;
+    if ( ::stat( QFile::encodeName( original ).constData(), &st ) != 0 )
+    {
+        cWarning() << "Could not stat" << original;
+        return false;
+    }
+
+    QFile f( temp );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        cWarning() << "Could not open" << temp << "for writing.";
+        return false;
+    }
+    const int fd = f.handle();
+    bool ok = ::fchmod( fd, st.st_mode & 07777 ) == 0 && ::fchown( fd, st.st_uid, st.st_gid ) == 0;
+    if ( ok && !copySecurityLabel( original, fd ) )
+    {
+        cWarning() << "Could not copy the SELinux label of" << original;
+        ok = false;
+    }
+    ok = ok && f.write( contents ) == contents.size() && f.flush() && ::fsync( fd ) == 0;
+    f.close();
+    if ( !ok )
+    {
+        cWarning() << "Could not write" << temp;
+    }
+    return ok;
+}
+
+bool
+AccountDatabase::Table::load( const QString& filePath )
+{
+    path = filePath;
+    QFile f( path );
+    exists = f.exists();
+    if ( !exists || !f.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+
+    QByteArray data = f.readAll();
+    if ( data.endsWith( '\n' ) )
+    {
+        data.chop( 1 );
+    }
+    if ( !data.isEmpty() )
+    {
+        const auto lines = data.split( '\n' );
+        for ( const QByteArray& line : lines )
+        {
+            entries.append( line.split( ':' ) );
+        }
+    }
+    return true;
+}
+
+int
+AccountDatabase::Table::find( const QString& name ) const
+{
+    const QByteArray key = name.toUtf8();
+    for ( int i = 0; i < entries.count(); ++i )
+    {
+        if ( entries.at( i ).first() == key )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QList< int >
+AccountDatabase::Table::ids( int field ) const
+{
+    QList< int > result;
+    for ( const auto& entry : entries )
+    {
+        bool ok = false;
+        const int id = entry.value( field ).toInt( &ok );
+        if ( ok )
+        {
+            result.append( id );
+        }
+    }
+    return result;
+}
+
+void
+AccountDatabase::Table::append( const QList< QByteArray >& entry )
+{
+    entries.append( entry );
+    isChanged = true;
+}
+
+void
+AccountDatabase::Table::addMember( int index, int field, const QByteArray& member )
+{
+    QList< QByteArray >& entry = entries[ index ];
+    while ( entry.count() <= field )
+    {
+        entry.append( QByteArray() );
+    }
+
+    QByteArrayList members;
+    if ( !entry.at( field ).isEmpty() )
+    {
+        members = entry.at( field ).split( ',' );
+    }
+    if ( !members.contains( member ) )
+    {
+        members.append( member );
+        entry[ field ] = members.join( ',' );
+        isChanged = true;
+    }
+}
+
+QByteArray
+AccountDatabase::Table::contents() const
+{
+    QByteArray data;
+    for ( const auto& entry : entries )
+    {
+        data.append( entry.join( ':' ) );
+        data.append( '\n' );
+    }
+    return data;
+}
+
+AccountDatabase::AccountDatabase( const QString& rootPath )
+{
+#ifdef __FreeBSD__
+    // FreeBSD keeps accounts in master.passwd, with databases built by pwd_mkdb
+    Q_UNUSED( rootPath )
+#else
+    const QDir root( rootPath );
+    m_isValid = m_passwd.load( root.absoluteFilePath( "etc/passwd" ) )
+        && m_group.load( root.absoluteFilePath( "etc/group" ) )
+        && m_shadow.load( root.absoluteFilePath( "etc/shadow" ) );
+    if ( !m_isValid )
+    {
+        cDebug() << "Could not read the account files in" << rootPath;
+        return;
+    }
+
+    // These files are optional, but if they exist they are kept up-to-date
+    auto loadOptional = [this, &root]( Table& t, const char* name ) {
+        if ( !t.load( root.absoluteFilePath( name ) ) && t.exists )
+        {
+            cDebug() << "Could not read" << t.path;
+            m_isValid = false;
+        }
+    };
+    loadOptional( m_gshadow, "etc/gshadow" );
+    loadOptional( m_subuid, "etc/subuid" );
+    loadOptional( m_subgid, "etc/subgid" );
+
+    m_loginDefs = readSettings( root.absoluteFilePath( "etc/login.defs" ), ' ' );
+    m_useraddDefaults = readSettings( root.absoluteFilePath( "etc/default/useradd" ), '=' );
+#endif
+}
+
+bool
+AccountDatabase::hasUser( const QString& login ) const
+{
+    return m_passwd.find( login ) >= 0;
+}
+
+bool
+AccountDatabase::hasGroup( const QString& name ) const
+{
+    return m_group.find( name ) >= 0;
+}
+
+QString
+AccountDatabase::loginDefinition( const QString& key, const QString& defaultValue ) const
+{
+    return m_loginDefs.value( key, defaultValue );
+}
+
+QString
+AccountDatabase::useraddDefault( const QString& key, const QString& defaultValue ) const
+{
+    return m_useraddDefaults.value( key, defaultValue );
+}
+
+int
+AccountDatabase::idSetting( const QString& key, int defaultValue ) const
+{
+    bool ok = false;
+    const int value = loginDefinition( key ).toInt( &ok );
+    return ok ? value : defaultValue;
+}
+
+bool
+AccountDatabase::addGroup( const QString& name, bool isSystem )
+{
+    if ( !m_isValid || name.isEmpty() || !isValidField( name ) || hasGroup( name ) )
+    {
+        return false;
+    }
+
+    const int gid = isSystem
+        ? freeId( m_group.ids( 2 ), idSetting( "SYS_GID_MIN", 101 ), idSetting( "SYS_GID_MAX", 999 ), true )
+        : freeId( m_group.ids( 2 ), idSetting( "GID_MIN", 1000 ), idSetting( "GID_MAX", 60000 ), false );
+    if ( gid < 0 )
+    {
+        cWarning() << "No free group id for" << name;
+        return false;
+    }
+
+    const QByteArray n = name.toUtf8();
+    m_group.append( { n, "x", QByteArray::number( gid ), QByteArray() } );
+    if ( m_gshadow.exists )
+    {
+        m_gshadow.append( { n, "!", QByteArray(), QByteArray() } );
+    }
+    return true;
+}
+
+void
+AccountDatabase::addSubordinateIds( Table& table, const QString& login, const QString& prefix )
+{
+    const int count = idSetting( prefix + QStringLiteral( "_COUNT" ), 65536 );
+    if ( !table.exists || count <= 0 || table.find( login ) >= 0 )
+    {
+        return;
+    }
+
+    const qint64 max = idSetting( prefix + QStringLiteral( "_MAX" ), 600100000 );
+    qint64 start = idSetting( prefix + QStringLiteral( "_MIN" ), 100000 );
+    for ( const auto& entry : table.entries )
+    {
+        bool startOk = false;
+        bool countOk = false;
+        const qint64 entryStart = entry.value( 1 ).toLongLong( &startOk );
+        const qint64 entryCount = entry.value( 2 ).toLongLong( &countOk );
+        if ( startOk && countOk && entryStart + entryCount > start )
+        {
+            start = entryStart + entryCount;
+        }
+    }
+    if ( start + count - 1 > max )
+    {
+        // useradd only warns about this, too
+        cWarning() << "No free subordinate ids in" << table.path << "for" << login;
+        return;
+    }
+    table.append( { login.toUtf8(), QByteArray::number( start ), QByteArray::number( count ) } );
+}
+
+bool
+AccountDatabase::addUser( const QString& login, const QString& fullName, const QString& shell )
+{
+    if ( !m_isValid || login.isEmpty() || !isValidField( login ) || !isValidField( fullName ) || !isValidField( shell )
+         || hasUser( login ) || hasGroup( login ) )
+    {
+        return false;
+    }
+
+    const int uid = freeId( m_passwd.ids( 2 ), idSetting( "UID_MIN", 1000 ), idSetting( "UID_MAX", 60000 ), false );
+    // Like useradd -U, the user's own group gets the same id, if it is free
+    const QList< int > gids = m_group.ids( 2 );
+    const int gid = ( uid >= 0 && !gids.contains( uid ) )
+        ? uid
+        : freeId( gids, idSetting( "GID_MIN", 1000 ), idSetting( "GID_MAX", 60000 ), false );
+    if ( uid < 0 || gid < 0 )
+    {
+        cWarning() << "No free user or group id for" << login;
+        return false;
+    }
+
+    const QString userShell = shell.isEmpty() ? useraddDefault( "SHELL" ) : shell;
+    if ( !isValidField( userShell ) )
+    {
+        return false;
+    }
+
+    QString homeBase = useraddDefault( "HOME", QStringLiteral( "/home" ) );
+    if ( !homeBase.startsWith( '/' ) || !isValidField( homeBase ) )
+    {
+        homeBase = QStringLiteral( "/home" );
+    }
+
+    const QByteArray l = login.toUtf8();
+    const QByteArray home = QDir::cleanPath( homeBase + '/' + login ).toUtf8();
+    const QByteArray today = QByteArray::number( QDateTime::currentSecsSinceEpoch() / ( 24 * 60 * 60 ) );
+
+    m_group.append( { l, "x", QByteArray::number( gid ), QByteArray() } );
+    if ( m_gshadow.exists )
+    {
+        m_gshadow.append( { l, "!", QByteArray(), QByteArray() } );
+    }
+    m_passwd.append( { l, "x", QByteArray::number( uid ), QByteArray::number( gid ), fullName.toUtf8(), home,
+                       userShell.toUtf8() } );
+    m_shadow.append( { l,
+                       "!",
+                       today,
+                       shadowDays( loginDefinition( "PASS_MIN_DAYS" ) ),
+                       shadowDays( loginDefinition( "PASS_MAX_DAYS" ) ),
+                       shadowDays( loginDefinition( "PASS_WARN_AGE" ) ),
+                       shadowDays( useraddDefault( "INACTIVE" ) ),
+                       QByteArray(),
+                       QByteArray() } );
+    addSubordinateIds( m_subuid, login, QStringLiteral( "SUB_UID" ) );
+    addSubordinateIds( m_subgid, login, QStringLiteral( "SUB_GID" ) );
+    return true;
+}
+
+bool
+AccountDatabase::addToGroups( const QString& login, const QStringList& groups )
+{
+    if ( !m_isValid || !hasUser( login ) )
+    {
+        return false;
+    }
+
+    const QByteArray l = login.toUtf8();
+    for ( const QString& group : groups )
+    {
+        const int index = m_group.find( group );
+        if ( index < 0 )
+        {
+            cDebug() << "Group" << group << "does not exist.";
+            return false;
+        }
+        m_group.addMember( index, 3, l );
+
+        const int shadowIndex = m_gshadow.find( group );
+        if ( shadowIndex >= 0 )
+        {
+            m_gshadow.addMember( shadowIndex, 3, l );
+        }
+    }
+    return true;
+}
+
+bool
+AccountDatabase::setPasswordHash( const QString& login, const QString& hash )
+{
+    const int index = m_shadow.find( login );
+    if ( !m_isValid || index < 0 || !isValidField( hash ) || m_shadow.entries.at( index ).count() < 2 )
+    {
+        return false;
+    }
+
+    m_shadow.entries[ index ][ 1 ] = hash.isEmpty() ? QByteArray( "!" ) : hash.toUtf8();
+    m_shadow.isChanged = true;
+    return true;
+}
+
+int
+AccountDatabase::userId( const QString& login ) const
+{
+    const int index = m_passwd.find( login );
+    bool ok = false;
+    const int id = index < 0 ? -1 : m_passwd.entries.at( index ).value( 2 ).toInt( &ok );
+    return ok ? id : -1;
+}
+
+int
+AccountDatabase::groupId( const QString& login ) const
+{
+    const int index = m_passwd.find( login );
+    bool ok = false;
+    const int id = index < 0 ? -1 : m_passwd.entries.at( index ).value( 3 ).toInt( &ok );
+    return ok ? id : -1;
+}
+
+QString
+AccountDatabase::homeDirectory( const QString& login ) const
+{
+    const int index = m_passwd.find( login );
+    return index < 0 ? QString() : QString::fromUtf8( m_passwd.entries.at( index ).value( 5 ) );
+}
+
+bool
+AccountDatabase::save()
+{
+    if ( !m_isValid )
+    {
+        return false;
+    }
+
+    // Groups go first, so that a user never refers to a missing group
+    QList< Table* > changed;
+    for ( auto* t : { &m_group, &m_gshadow, &m_passwd, &m_shadow, &m_subuid, &m_subgid } )
+    {
+        if ( t->isChanged )
+        {
+            changed.append( t );
+        }
+    }
+
+    QStringList written;
+    for ( const Table* t : changed )
+    {
+        const QString temp = t->path + '+';
+        if ( !writeReplacement( t->path, temp, t->contents() ) )
+        {
+            QFile::remove( temp );
+            for ( const QString& w : written )
+            {
+                QFile::remove( w );
+            }
+            return false;
+        }
+        written.append( temp );
+    }
+
+    for ( Table* t : changed )
+    {
+        const QString temp = t->path + '+';
+        if ( std::rename( QFile::encodeName( temp ).constData(), QFile::encodeName( t->path ).constData() ) != 0 )
+        {
+            cError() << "Could not replace" << t->path;
+            return false;
+        }
+        t->isChanged = false;
+    }
+    return true;
+}
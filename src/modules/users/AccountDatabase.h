@@ -0,0 +1,120 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef USERS_ACCOUNTDATABASE_H
+#define USERS_ACCOUNTDATABASE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/** @brief The user and group files of a (target) system
+ *
+ * This reads /etc/passwd, /etc/group, /etc/shadow and /etc/gshadow
+ * (and /etc/subuid and /etc/subgid, if they exist) below a root
+ * directory. Users and groups are added in memory, the way useradd(8),
+ * groupadd(8) and usermod(8) would, and save() writes all the changed
+ * files in one go. That saves running a tool in the target system for
+ * each change.
+ *
+ * Only plain files are handled. When something is unusual (e.g. the
+ * files are missing, or a user to add already exists), the operations
+ * return @c false; the caller should then use the shadow-utils tools
+ * instead, which will also explain what is wrong.
+ */
+class AccountDatabase
+{
+public:
+    /// @brief Reads the account files below @p rootPath
+    explicit AccountDatabase( const QString& rootPath );
+
+    /// @brief Were all the required files read?
+    bool isValid() const { return m_isValid; }
+
+    bool hasUser( const QString& login ) const;
+    bool hasGroup( const QString& name ) const;
+
+    /// @brief Adds group @p name (like groupadd, or groupadd --system)
+    bool addGroup( const QString& name, bool isSystem );
+    /** @brief Adds user @p login (like useradd -m -U)
+     *
+     * The user gets a group of the same name, and <HOME>/<login> as
+     * home directory (which is not created here), where HOME comes from
+     * /etc/default/useradd and is /home by default. An empty @p shell
+     * uses the default from /etc/default/useradd, too.
+     */
+    bool addUser( const QString& login, const QString& fullName, const QString& shell );
+    /// @brief Adds @p login to each of the (existing) @p groups (like usermod -aG)
+    bool addToGroups( const QString& login, const QStringList& groups );
+    /** @brief Sets the (already hashed) password of @p login (like usermod -p)
+     *
+     * An empty @p hash locks the account instead (like passwd -dl).
+     */
+    bool setPasswordHash( const QString& login, const QString& hash );
+
+    /// @brief UID of @p login, or -1 if there is no such user
+    int userId( const QString& login ) const;
+    /// @brief Primary GID of @p login, or -1 if there is no such user
+    int groupId( const QString& login ) const;
+    /// @brief Home directory of @p login (in the target system), or empty if there is no such user
+    QString homeDirectory( const QString& login ) const;
+
+    /// @brief A setting from /etc/login.defs, or @p defaultValue
+    QString loginDefinition( const QString& key, const QString& defaultValue = QString() ) const;
+    /// @brief A setting from /etc/default/useradd, or @p defaultValue
+    QString useraddDefault( const QString& key, const QString& defaultValue = QString() ) const;
+
+    /** @brief Writes all the changed files
+     *
+     * Each file is written next to the original (with the same owner,
+     * mode and SELinux label) and flushed to disk. Only when all of them are written
+     * are they renamed over the originals. Returns @c false if anything
+     * failed; if that happened while writing, nothing has changed.
+     */
+    bool save();
+
+private:
+    /// @brief One of the colon-separated files, kept byte-for-byte
+    struct Table
+    {
+        QString path;
+        QList< QList< QByteArray > > entries;  ///< Each line, split on ':'
+        bool exists = false;
+        bool isChanged = false;
+
+        bool load( const QString& filePath );
+        /// @brief Index of the entry for @p name, or -1
+        int find( const QString& name ) const;
+        /// @brief The numeric field @p field of all the entries
+        QList< int > ids( int field ) const;
+        void append( const QList< QByteArray >& entry );
+        /// @brief Adds @p member to the comma-separated list in @p field of entry @p index
+        void addMember( int index, int field, const QByteArray& member );
+        QByteArray contents() const;
+    };
+
+    int idSetting( const QString& key, int defaultValue ) const;
+    void addSubordinateIds( Table& table, const QString& login, const QString& prefix );
+
+    bool m_isValid = false;
+
+    Table m_group;
+    Table m_gshadow;
+    Table m_passwd;
+    Table m_shadow;
+    Table m_subuid;
+    Table m_subgid;
+
+    QHash< QString, QString > m_loginDefs;
+    QHash< QString, QString > m_useraddDefaults;
+};
+
+#endif
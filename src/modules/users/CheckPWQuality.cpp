@@ -16,7 +16,10 @@
 #include "utils/Logger.h"
 
 #include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
+#include <QtConcurrent/QtConcurrent>
 
 #ifdef HAVE_LIBPWQUALITY
 #include <pwquality.h>
@@ -38,6 +41,108 @@ PasswordCheck::PasswordCheck( MessageFunc m, AcceptFunc a, Weight weight )
 {
 }
 
+/// Time without changes to the password before the checks run
+static constexpr int checkDelayMs = 300;
+
+PasswordChecker::PasswordChecker( const PasswordCheckList& checks, QObject* parent )
+    : QObject( parent )
+    , m_checks( checks )
+{
+    m_timer.setSingleShot( true );
+    m_timer.setInterval( checkDelayMs );
+    connect( &m_timer, &QTimer::timeout, this, &PasswordChecker::start );
+    connect( &m_watcher, &QFutureWatcher< QString >::finished, this, &PasswordChecker::finished );
+}
+
+PasswordChecker::~PasswordChecker()
+{
+    m_watcher.waitForFinished();
+}
+
+QString
+PasswordChecker::apply( const PasswordCheckList& checks, const QString& password )
+{
+    // The libpwquality check keeps the result of a check around to
+    // explain it, so checks may not run at the same time.
+    static QMutex mutex;
+    QMutexLocker lock( &mutex );
+
+    for ( const auto& pc : checks )
+    {
+        QString message = pc.filter( password );
+        if ( !message.isEmpty() )
+        {
+            return message;
+        }
+    }
+    return QString();
+}
+
+void
+PasswordChecker::schedule( const QString& password )
+{
+    if ( isChecked( password ) )
+    {
+        m_scheduled = password;
+        m_timer.stop();
+        return;
+    }
+    if ( password == m_scheduled && ( m_timer.isActive() || ( m_watcher.isRunning() && m_running == password ) ) )
+    {
+        return;
+    }
+    m_scheduled = password;
+    m_timer.start();
+}
+
+void
+PasswordChecker::clear()
+{
+    m_isChecked = false;
+    m_password.clear();
+    m_message.clear();
+}
+
+void
+PasswordChecker::start()
+{
+    if ( m_watcher.isRunning() )
+    {
+        // finished() will start again for the newest password
+        return;
+    }
+    if ( isChecked( m_scheduled ) )
+    {
+        return;
+    }
+
+    m_running = m_scheduled;
+    // The checks are copied, so they can't change under the worker
+    m_watcher.setFuture( QtConcurrent::run( &PasswordChecker::apply, m_checks, m_running ) );
+}
+
+void
+PasswordChecker::finished()
+{
+    if ( m_running == m_scheduled )
+    {
+        m_password = m_running;
+        m_message = m_watcher.result();
+        m_isChecked = true;
+        m_running.clear();
+        emit checked();
+    }
+    else
+    {
+        // The password changed while it was being checked
+        m_running.clear();
+        if ( !m_timer.isActive() )
+        {
+            start();
+        }
+    }
+}
+
 DEFINE_CHECK_FUNC( minLength )
 {
     int minLength = -1;
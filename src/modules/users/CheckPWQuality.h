@@ -10,7 +10,10 @@
 #ifndef CHECKPWQUALITY_H
 #define CHECKPWQUALITY_H
 
+#include <QFutureWatcher>
+#include <QObject>
 #include <QString>
+#include <QTimer>
 #include <QVariant>
 #include <QVector>
 
@@ -61,6 +64,71 @@ private:
 
 using PasswordCheckList = QVector< PasswordCheck >;
 
+/** @brief Runs the password checks in the background
+ *
+ * Some checks (libpwquality, with its dictionary lookups) are slow
+ * enough to make typing in a password field lag. A PasswordChecker
+ * waits until the password has not changed for a little while, then
+ * applies all the checks in a worker thread and emits checked().
+ *
+ * The result for the most-recently checked password is kept, so that
+ * asking for the message of that password again is cheap.
+ */
+class PasswordChecker : public QObject
+{
+    Q_OBJECT
+public:
+    /// @brief Uses the @p checks (which must outlive this checker)
+    PasswordChecker( const PasswordCheckList& checks, QObject* parent = nullptr );
+    ~PasswordChecker() override;
+
+    /** @brief Check @p password in the background, after a short delay
+     *
+     * Scheduling the password that is already waiting (or being checked)
+     * again does not delay the check any further.
+     */
+    void schedule( const QString& password );
+    /// @brief Has @p password been checked already?
+    bool isChecked( const QString& password ) const { return m_isChecked && password == m_password; }
+    /** @brief The message for @p password (empty if all the checks pass)
+     *
+     * This is only meaningful if isChecked() is true for @p password;
+     * the checks are never applied in the calling thread.
+     */
+    QString message( const QString& password ) const
+    {
+        return isChecked( password ) ? m_message : QString();
+    }
+    /// @brief Forget the kept result (e.g. when the checks change)
+    void clear();
+
+    /** @brief Applies all the @p checks to @p password
+     *
+     * Returns the message of the first check that fails, or an
+     * empty string if they all pass. This is safe to call from
+     * any thread.
+     */
+    static QString apply( const PasswordCheckList& checks, const QString& password );
+
+signals:
+    /// @brief Emitted when a scheduled check is done; see isChecked()
+    void checked();
+
+private:
+    void start();
+    void finished();
+
+    const PasswordCheckList& m_checks;
+    QTimer m_timer;  ///< Debounce, restarted for each schedule()
+    QString m_scheduled;  ///< Password most recently schedule()d
+    QFutureWatcher< QString > m_watcher;
+    QString m_running;  ///< Password being checked in the worker
+
+    bool m_isChecked = false;
+    QString m_password;  ///< Password most recently checked
+    QString m_message;  ///< .. and the result of the checks
+};
+
 /* Each of these functions adds a check (if possible) to the list
  * of checks; they use the configuration value(s) from the
  * variant. If the value doesn't make sense, each function
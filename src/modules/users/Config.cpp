@@ -78,9 +78,14 @@ hostNameActionNames()
 
 Config::Config( QObject* parent )
     : QObject( parent )
+    , m_userPasswordChecker( new PasswordChecker( m_passwordChecks, this ) )
+    , m_rootPasswordChecker( new PasswordChecker( m_passwordChecks, this ) )
 {
     emit readyChanged( m_isReady );  // false
 
+    connect( m_userPasswordChecker, &PasswordChecker::checked, this, &Config::updateUserPasswordStatus );
+    connect( m_rootPasswordChecker, &PasswordChecker::checked, this, &Config::updateRootPasswordStatus );
+
     // Gang together all the changes of status to one readyChanged() signal
     connect( this, &Config::hostNameStatusChanged, this, &Config::checkReady );
     connect( this, &Config::loginNameStatusChanged, this, &Config::checkReady );
@@ -448,8 +453,7 @@ Config::setUserPassword( const QString& s )
     if ( s != m_userPassword )
     {
         m_userPassword = s;
-        const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary );
-        emit userPasswordStatusChanged( p.first, p.second );
+        updateUserPasswordStatus();
         emit userPasswordChanged( s );
     }
 }
@@ -460,36 +464,59 @@ Config::setUserPasswordSecondary( const QString& s )
     if ( s != m_userPasswordSecondary )
     {
         m_userPasswordSecondary = s;
-        const auto p = passwordStatus( m_userPassword, m_userPasswordSecondary );
-        emit userPasswordStatusChanged( p.first, p.second );
+        updateUserPasswordStatus();
         emit userPasswordSecondaryChanged( s );
     }
 }
 
+/** @brief Reports the status of the user password, now or later
+ *
+ * Passwords that do not match are reported right away. Otherwise,
+ * the password checks are done in the background, and the status
+ * is reported when they are done (this is called again then).
+ */
+void
+Config::updateUserPasswordStatus()
+{
+    m_userPasswordChecker->schedule( m_userPassword );
+    if ( m_userPassword != m_userPasswordSecondary || m_userPasswordChecker->isChecked( m_userPassword ) )
+    {
+        const auto p = userPasswordStatus();
+        emit userPasswordStatusChanged( p.first, p.second );
+    }
+}
+
 /** @brief Checks two copies of the password for validity
  *
  * Given two copies of the password -- generally the password and
  * the secondary fields -- checks them for validity and returns
- * a pair of <validity, message>.
+ * a pair of <validity, message>. The strength checks are done
+ * by the @p checker, which keeps the most recent result.
  *
+ * The checks are not done here, since this is called from the GUI
+ * thread (e.g. through isReady()). A password that has not been
+ * checked yet is invalid until the checker is done; then the status
+ * changes.
  */
 Config::PasswordStatus
-Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
+Config::passwordStatus( const QString& pw1, const QString& pw2, PasswordChecker* checker ) const
 {
     if ( pw1 != pw2 )
     {
         return qMakePair( PasswordValidity::Invalid, tr( "Your passwords do not match!" ) );
     }
 
-    bool failureIsFatal = requireStrongPasswords();
-    for ( const auto& pc : m_passwordChecks )
+    if ( !checker->isChecked( pw1 ) )
     {
-        QString message = pc.filter( pw1 );
+        checker->schedule( pw1 );
+        return qMakePair( PasswordValidity::Invalid, tr( "Checking the password..." ) );
+    }
 
-        if ( !message.isEmpty() )
-        {
-            return qMakePair( failureIsFatal ? PasswordValidity::Invalid : PasswordValidity::Weak, message );
-        }
+    const QString message = checker->message( pw1 );
+    if ( !message.isEmpty() )
+    {
+        bool failureIsFatal = requireStrongPasswords();
+        return qMakePair( failureIsFatal ? PasswordValidity::Invalid : PasswordValidity::Weak, message );
     }
 
     return qMakePair( PasswordValidity::Valid, QString() );
@@ -499,7 +526,7 @@ Config::passwordStatus( const QString& pw1, const QString& pw2 ) const
 Config::PasswordStatus
 Config::userPasswordStatus() const
 {
-    return passwordStatus( m_userPassword, m_userPasswordSecondary );
+    return passwordStatus( m_userPassword, m_userPasswordSecondary, m_userPasswordChecker );
 }
 
 int
@@ -523,8 +550,7 @@ Config::setRootPassword( const QString& s )
     if ( writeRootPassword() && s != m_rootPassword )
     {
         m_rootPassword = s;
-        const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary );
-        emit rootPasswordStatusChanged( p.first, p.second );
+        updateRootPasswordStatus();
         emit rootPasswordChanged( s );
     }
 }
@@ -535,12 +561,23 @@ Config::setRootPasswordSecondary( const QString& s )
     if ( writeRootPassword() && s != m_rootPasswordSecondary )
     {
         m_rootPasswordSecondary = s;
-        const auto p = passwordStatus( m_rootPassword, m_rootPasswordSecondary );
-        emit rootPasswordStatusChanged( p.first, p.second );
+        updateRootPasswordStatus();
         emit rootPasswordSecondaryChanged( s );
     }
 }
 
+/// @brief Reports the status of the root password, like updateUserPasswordStatus()
+void
+Config::updateRootPasswordStatus()
+{
+    m_rootPasswordChecker->schedule( m_rootPassword );
+    if ( m_rootPassword != m_rootPasswordSecondary || m_rootPasswordChecker->isChecked( m_rootPassword ) )
+    {
+        const auto p = rootPasswordStatus();
+        emit rootPasswordStatusChanged( p.first, p.second );
+    }
+}
+
 QString
 Config::rootPassword() const
 {
@@ -574,7 +611,7 @@ Config::rootPasswordStatus() const
 {
     if ( writeRootPassword() && !reuseUserPasswordForRoot() )
     {
-        return passwordStatus( m_rootPassword, m_rootPasswordSecondary );
+        return passwordStatus( m_rootPassword, m_rootPasswordSecondary, m_rootPasswordChecker );
     }
     else
     {
@@ -785,6 +822,22 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
         addPasswordCheck( i.key(), i.value(), m_passwordChecks );
     }
     std::sort( m_passwordChecks.begin(), m_passwordChecks.end() );
+    m_userPasswordChecker->clear();
+    m_rootPasswordChecker->clear();
+
+    bool ok = false;
+    const auto passwordHash = CalamaresUtils::getSubMap( configurationMap, "passwordHash", ok );
+    const QString hashMethod = CalamaresUtils::getString( passwordHash, "method" );
+    if ( !hashMethod.isEmpty() )
+    {
+        m_passwordHashMethod = SetPasswordJob::hashMethodNames().find( hashMethod, ok );
+        if ( !ok )
+        {
+            cWarning() << "Unknown password hash method" << hashMethod << "using SHA512.";
+            m_passwordHashMethod = SetPasswordJob::HashMethod::SHA512;
+        }
+    }
+    m_passwordHashCost = static_cast< int >( CalamaresUtils::getInteger( passwordHash, "cost", 0 ) );
 
     updateGSAutoLogin( doAutoLogin(), loginName() );
     checkReady();
@@ -821,18 +874,10 @@ Config::createJobs() const
         jobs.append( Calamares::job_ptr( j ) );
     }
 
-    j = new SetupGroupsJob( this );
-    jobs.append( Calamares::job_ptr( j ) );
-
+    // This also sets up the groups and the passwords
     j = new CreateUserJob( this );
     jobs.append( Calamares::job_ptr( j ) );
 
-    j = new SetPasswordJob( loginName(), userPassword() );
-    jobs.append( Calamares::job_ptr( j ) );
-
-    j = new SetPasswordJob( "root", rootPassword() );
-    jobs.append( Calamares::job_ptr( j ) );
-
     j = new SetHostNameJob( hostName(), hostNameActions() );
     jobs.append( Calamares::job_ptr( j ) );
 
@@ -11,6 +11,7 @@
 #define USERS_CONFIG_H
 
 #include "CheckPWQuality.h"
+#include "SetPasswordJob.h"
 
 #include "Job.h"
 #include "utils/NamedEnum.h"
@@ -213,6 +214,11 @@ public:
     /// Current setting for "require strong password"?
     bool requireStrongPasswords() const { return m_requireStrongPasswords; }
 
+    /// How passwords are hashed (see SetPasswordJob)
+    SetPasswordJob::HashMethod passwordHashMethod() const { return m_passwordHashMethod; }
+    /// The cost for the hash method, 0 is the default cost
+    int passwordHashCost() const { return m_passwordHashCost; }
+
     const QList< GroupDescription >& defaultGroups() const { return m_defaultGroups; }
     /** @brief the names of all the groups for the current user
      *
@@ -299,7 +305,9 @@ signals:
     void readyChanged( bool ) const;
 
 private:
-    PasswordStatus passwordStatus( const QString&, const QString& ) const;
+    PasswordStatus passwordStatus( const QString&, const QString&, PasswordChecker* ) const;
+    void updateUserPasswordStatus();
+    void updateRootPasswordStatus();
     void checkReady();
 
     QList< GroupDescription > m_defaultGroups;
@@ -330,6 +338,11 @@ private:
 
     HostNameActions m_hostNameActions;
     PasswordCheckList m_passwordChecks;
+    PasswordChecker* m_userPasswordChecker;
+    PasswordChecker* m_rootPasswordChecker;
+
+    SetPasswordJob::HashMethod m_passwordHashMethod = SetPasswordJob::HashMethod::SHA512;
+    int m_passwordHashCost = 0;  ///< 0 is the default for the method
 };
 
 #endif
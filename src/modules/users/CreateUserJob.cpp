@@ -7,7 +7,10 @@
 
 #include "CreateUserJob.h"
 
+#include "AccountDatabase.h"
 #include "Config.h"
+#include "MiscJobs.h"
+#include "SetPasswordJob.h"
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
@@ -17,11 +20,16 @@
 
 #include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QProcess>
 #include <QTextStream>
 
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 CreateUserJob::CreateUserJob( const Config* config )
     : Calamares::Job()
@@ -107,6 +115,128 @@ setUserGroups( const QString& loginName, const QStringList& groups )
 }
 
 
+/// @brief Copies the skeleton directory @p from into the new home directory @p to
+static void
+copySkeleton( const QString& from, const QString& to )
+{
+    const QDir source( from );
+    QDirIterator it( from,
+                     QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                     QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        it.next();
+        const QFileInfo fi = it.fileInfo();
+        const QString target = to + '/' + source.relativeFilePath( fi.filePath() );
+        QDir().mkpath( QFileInfo( target ).path() );
+        if ( fi.isSymLink() )
+        {
+            // Copy the link itself, its target is relative to the target system
+            char link[ PATH_MAX ];
+            const ssize_t length = ::readlink( QFile::encodeName( fi.filePath() ).constData(), link, sizeof( link ) );
+            if ( length < 0 || length >= ssize_t( sizeof( link ) )
+                 || ::symlink( QByteArray( link, int( length ) ).constData(), QFile::encodeName( target ).constData() )
+                     != 0 )
+            {
+                cWarning() << "Could not copy skeleton link" << fi.filePath();
+            }
+        }
+        else if ( fi.isDir() )
+        {
+            QDir().mkpath( target );
+            QFile::setPermissions( target, fi.permissions() );
+        }
+        else if ( !QFile::copy( fi.filePath(), target ) )
+        {
+            cWarning() << "Could not copy skeleton file" << fi.filePath();
+        }
+    }
+}
+
+/** @brief Creates the home directory of @p login, like useradd -m does
+ *
+ * A new home directory gets a copy of the skeleton directory; an existing
+ * one (e.g. when re-using /home) is left as it is. Either way, everything
+ * in it is given to the user afterwards.
+ */
+static bool
+createHome( const QDir& root, const AccountDatabase& accounts, const QString& login )
+{
+    const QString homeDirectory = accounts.homeDirectory( login );
+    if ( homeDirectory.isEmpty() )
+    {
+        return false;
+    }
+    const QString home = root.absolutePath() + homeDirectory;
+    if ( !QFileInfo::exists( home ) )
+    {
+        bool ok = false;
+        mode_t mode = accounts.loginDefinition( QStringLiteral( "HOME_MODE" ) ).toUInt( &ok, 8 );
+        if ( !ok )
+        {
+            const uint umask = accounts.loginDefinition( QStringLiteral( "UMASK" ) ).toUInt( &ok, 8 );
+            mode = 0777 & ~( ok ? umask : 022 );
+        }
+        if ( !QDir().mkpath( home ) || ::chmod( QFile::encodeName( home ).constData(), mode ) != 0 )
+        {
+            cWarning() << "Could not create home directory" << home;
+            return false;
+        }
+
+        const QString skel = accounts.useraddDefault( QStringLiteral( "SKEL" ), QStringLiteral( "/etc/skel" ) );
+        copySkeleton( QDir::cleanPath( root.absolutePath() + '/' + skel ), home );
+    }
+    return CalamaresUtils::Permissions::applyRecursive( home, accounts.userId( login ), accounts.groupId( login ) );
+}
+
+
+bool
+CreateUserJob::stageAccounts( AccountDatabase& accounts ) const
+{
+    // Groups first, like SetupGroupsJob does
+    for ( const auto& group : m_config->defaultGroups() )
+    {
+        if ( !group.isValid() || accounts.hasGroup( group.name() ) )
+        {
+            continue;
+        }
+        if ( group.mustAlreadyExist() || !accounts.addGroup( group.name(), group.isSystemGroup() ) )
+        {
+            return false;
+        }
+    }
+    if ( m_config->doAutoLogin() && !m_config->autologinGroup().isEmpty()
+         && !accounts.hasGroup( m_config->autologinGroup() ) )
+    {
+        accounts.addGroup( m_config->autologinGroup(), false );
+    }
+
+    const QString login = m_config->loginName();
+    if ( !accounts.addUser( login, m_config->fullName(), m_config->userShell() )
+         || !accounts.addToGroups( login, m_config->groupsForThisUser() ) )
+    {
+        return false;
+    }
+
+    const auto method = m_config->passwordHashMethod();
+    const int cost = m_config->passwordHashCost();
+    const QString userHash = SetPasswordJob::hashPassword( m_config->userPassword(), method, cost );
+    if ( userHash.isEmpty() || !accounts.setPasswordHash( login, userHash ) )
+    {
+        return false;
+    }
+    // An empty root password locks the account, like SetPasswordJob does
+    const QString rootHash = m_config->rootPassword().isEmpty()
+        ? QString()
+        : SetPasswordJob::hashPassword( m_config->rootPassword(), method, cost );
+    if ( !m_config->rootPassword().isEmpty() && rootHash.isEmpty() )
+    {
+        return false;
+    }
+    return accounts.setPasswordHash( QStringLiteral( "root" ), rootHash );
+}
+
+
 Calamares::JobResult
 CreateUserJob::exec()
 {
@@ -138,6 +268,42 @@ CreateUserJob::exec()
         }
     }
 
+    // All the account changes are made in memory and written in one go;
+    // anything unusual is left to the tools in the target system.
+    AccountDatabase accounts( destDir.absolutePath() );
+    if ( accounts.isValid() && stageAccounts( accounts ) )
+    {
+        cDebug() << "[CREATEUSER]: creating user in the account files";
+
+        m_status = tr( "Creating user %1" ).arg( m_config->loginName() );
+        emit progress( 0.5 );
+        if ( accounts.save() )
+        {
+            m_status = tr( "Setting file permissions" );
+            emit progress( 0.9 );
+            if ( !createHome( destDir, accounts, m_config->loginName() ) )
+            {
+                return Calamares::JobResult::error(
+                    tr( "Cannot create home directory for user %1." ).arg( m_config->loginName() ) );
+            }
+            return Calamares::JobResult::ok();
+        }
+        cWarning() << "Could not write the account files, using the tools instead.";
+    }
+
+    return execWithTools();
+}
+
+Calamares::JobResult
+CreateUserJob::execWithTools()
+{
+    SetupGroupsJob groups( m_config );
+    auto groupsResult = groups.exec();
+    if ( !groupsResult )
+    {
+        return groupsResult;
+    }
+
     cDebug() << "[CREATEUSER]: creating user";
 
     m_status = tr( "Creating user %1" ).arg( m_config->loginName() );
@@ -167,5 +333,16 @@ CreateUserJob::exec()
         return commandResult.explainProcess( "chown", std::chrono::seconds( 10 ) /* bogus timeout */ );
     }
 
-    return Calamares::JobResult::ok();
+    SetPasswordJob userPassword(
+        m_config->loginName(), m_config->userPassword(), m_config->passwordHashMethod(), m_config->passwordHashCost() );
+    auto passwordResult = userPassword.exec();
+    if ( !passwordResult )
+    {
+        return passwordResult;
+    }
+    SetPasswordJob rootPassword( QStringLiteral( "root" ),
+                                 m_config->rootPassword(),
+                                 m_config->passwordHashMethod(),
+                                 m_config->passwordHashCost() );
+    return rootPassword.exec();
 }
@@ -12,6 +12,7 @@
 
 #include "Job.h"
 
+class AccountDatabase;
 class Config;
 
 class CreateUserJob : public Calamares::Job
@@ -25,6 +26,11 @@ public:
     Calamares::JobResult exec() override;
 
 private:
+    /// @brief Adds groups, user and passwords to @p accounts (in memory)
+    bool stageAccounts( AccountDatabase& accounts ) const;
+    /// @brief Does the same as exec() by running the tools in the target system
+    Calamares::JobResult execWithTools();
+
     const Config* m_config;
     QString m_status;
 };
@@ -26,13 +26,33 @@
 #include <unistd.h>
 
 
-SetPasswordJob::SetPasswordJob( const QString& userName, const QString& newPassword )
+SetPasswordJob::SetPasswordJob( const QString& userName,
+                                const QString& newPassword,
+                                HashMethod method,
+                                int cost )
     : Calamares::Job()
     , m_userName( userName )
     , m_newPassword( newPassword )
+    , m_hashMethod( method )
+    , m_hashCost( cost )
 {
 }
 
+const NamedEnumTable< SetPasswordJob::HashMethod >&
+SetPasswordJob::hashMethodNames()
+{
+    // *INDENT-OFF*
+    // clang-format off
+    static const NamedEnumTable< HashMethod > names {
+        { QStringLiteral( "sha512" ), HashMethod::SHA512 },
+        { QStringLiteral( "yescrypt" ), HashMethod::Yescrypt }
+    };
+    // clang-format on
+    // *INDENT-ON*
+
+    return names;
+}
+
 
 QString
 SetPasswordJob::prettyName() const
@@ -72,6 +92,43 @@ SetPasswordJob::make_salt( int length )
     return salt_string;
 }
 
+QString
+SetPasswordJob::make_setting( HashMethod method, int cost )
+{
+    if ( method == HashMethod::Yescrypt )
+    {
+#ifdef CRYPT_GENSALT_IMPLEMENTS_AUTO_ENTROPY
+        // libxcrypt gets the random bytes itself; a cost of 0 picks its default
+        const char* setting = crypt_gensalt( "$y$", static_cast< unsigned long >( qMax( cost, 0 ) ), nullptr, 0 );
+        if ( setting )
+        {
+            return QString::fromLatin1( setting );
+        }
+#endif
+        cWarning() << "The crypt library does not support yescrypt, using SHA512.";
+        return make_salt( 16 );
+    }
+
+    QString salt = make_salt( 16 );
+    if ( cost > 0 )
+    {
+        salt.insert( 3, QStringLiteral( "rounds=%1$" ).arg( cost ) );
+    }
+    return salt;
+}
+
+QString
+SetPasswordJob::hashPassword( const QString& password, HashMethod method, int cost )
+{
+    const char* hashed = crypt( password.toUtf8(), make_setting( method, cost ).toUtf8() );
+    // libxcrypt returns an invalid hash starting with * on failure
+    if ( !hashed || hashed[ 0 ] == '*' )
+    {
+        return QString();
+    }
+    return QString::fromLatin1( hashed );
+}
+
 Calamares::JobResult
 SetPasswordJob::exec()
 {
@@ -90,7 +147,12 @@ SetPasswordJob::exec()
         return Calamares::JobResult::ok();
     }
 
-    QString encrypted = QString::fromLatin1( crypt( m_newPassword.toUtf8(), make_salt( 16 ).toUtf8() ) );
+    QString encrypted = hashPassword( m_newPassword, m_hashMethod, m_hashCost );
+    if ( encrypted.isEmpty() )
+    {
+        return Calamares::JobResult::error( tr( "Cannot set password for user %1." ).arg( m_userName ),
+                                            tr( "The password could not be hashed." ) );
+    }
 
     int ec = CalamaresUtils::System::instance()->targetEnvCall( { "usermod", "-p", encrypted, m_userName } );
     if ( ec )
@@ -12,22 +12,53 @@
 #define SETPASSWORDJOB_H
 
 #include "Job.h"
+#include "utils/NamedEnum.h"
 
 
 class SetPasswordJob : public Calamares::Job
 {
     Q_OBJECT
 public:
-    SetPasswordJob( const QString& userName, const QString& newPassword );
+    /// @brief How the password is hashed for /etc/shadow
+    enum class HashMethod
+    {
+        SHA512,
+        Yescrypt
+    };
+
+    /** @brief Sets the password for @p userName
+     *
+     * The @p cost is the number of rounds for SHA512, and the cost
+     * factor (1 to 11) for yescrypt; 0 uses the default for @p method.
+     */
+    SetPasswordJob( const QString& userName,
+                    const QString& newPassword,
+                    HashMethod method = HashMethod::SHA512,
+                    int cost = 0 );
     QString prettyName() const override;
     QString prettyStatusMessage() const override;
     Calamares::JobResult exec() override;
 
     static QString make_salt( int length );
+    /** @brief Returns a setting (method, cost and salt) for crypt()
+     *
+     * If yescrypt is not supported by the crypt library, a
+     * SHA512 setting (with the default number of rounds) is returned.
+     */
+    static QString make_setting( HashMethod method, int cost );
+    /** @brief Hashes @p password for /etc/shadow
+     *
+     * Returns an empty string if the password could not be hashed.
+     */
+    static QString hashPassword( const QString& password, HashMethod method, int cost );
+
+    static const NamedEnumTable< HashMethod >& hashMethodNames();
 
 private:
     QString m_userName;
     QString m_newPassword;
+    HashMethod m_hashMethod;
+    int m_hashCost;
 };
 
 #endif /* SETPASSWORDJOB_H */
@@ -0,0 +1,220 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 agent <agent@local>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "AccountDatabase.h"
+
+#include "utils/Logger.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class AccountDatabaseTests : public QObject
+{
+    Q_OBJECT
+public:
+    AccountDatabaseTests() {}
+    ~AccountDatabaseTests() override {}
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testMissing();
+    void testAddGroup();
+    void testAddUser();
+    void testSave();
+
+private:
+    /// @brief Creates a minimal target system with account files in @p dir
+    static bool createTarget( const QTemporaryDir& dir );
+    static QByteArray readTarget( const QTemporaryDir& dir, const char* name );
+};
+
+static bool
+writeFile( const QString& path, const QByteArray& contents )
+{
+    QFile f( path );
+    return f.open( QIODevice::WriteOnly ) && f.write( contents ) == contents.size();
+}
+
+bool
+AccountDatabaseTests::createTarget( const QTemporaryDir& dir )
+{
+    const QDir root( dir.path() );
+    return root.mkpath( "etc/default" )
+        && writeFile( root.filePath( "etc/passwd" ),
+                      "root:x:0:0:root:/root:/bin/bash\n"
+                      "nobody:x:65534:65534:nobody:/nonexistent:/usr/sbin/nologin\n" )
+        && writeFile( root.filePath( "etc/group" ),
+                      "root:x:0:\n"
+                      "wheel:x:10:\n"
+                      "audio:x:29:pulse\n"
+                      "nogroup:x:65534:\n" )
+        && writeFile( root.filePath( "etc/shadow" ),
+                      "root:*:18000:0:99999:7:::\n"
+                      "nobody:*:18000:0:99999:7:::\n" )
+        && writeFile( root.filePath( "etc/gshadow" ), "root:*::\nwheel:*::\naudio:*::pulse\nnogroup:*::\n" )
+        && writeFile( root.filePath( "etc/login.defs" ),
+                      "# Comment\n"
+                      "UID_MIN 1000\n"
+                      "UID_MAX 60000\n"
+                      "SYS_GID_MIN 101\n"
+                      "SYS_GID_MAX 999\n"
+                      "PASS_MAX_DAYS 99999\n" )
+        && writeFile( root.filePath( "etc/default/useradd" ), "SHELL=/bin/sh\nSKEL=/etc/skel\n" );
+}
+
+QByteArray
+AccountDatabaseTests::readTarget( const QTemporaryDir& dir, const char* name )
+{
+    QFile f( QDir( dir.path() ).filePath( name ) );
+    return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+}
+
+void
+AccountDatabaseTests::initTestCase()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+AccountDatabaseTests::testMissing()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+
+    AccountDatabase accounts( dir.path() );
+    QVERIFY( !accounts.isValid() );
+    QVERIFY( !accounts.addGroup( QStringLiteral( "wheel" ), true ) );
+    QVERIFY( !accounts.save() );
+}
+
+void
+AccountDatabaseTests::testAddGroup()
+{
+#ifdef __FreeBSD__
+    QSKIP( "Accounts are not edited on FreeBSD" );
+#endif
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    QVERIFY( createTarget( dir ) );
+
+    AccountDatabase accounts( dir.path() );
+    QVERIFY( accounts.isValid() );
+    QVERIFY( accounts.hasGroup( QStringLiteral( "audio" ) ) );
+    QVERIFY( !accounts.hasGroup( QStringLiteral( "video" ) ) );
+
+    QVERIFY( !accounts.addGroup( QStringLiteral( "audio" ), true ) );  // Already there
+    QVERIFY( !accounts.addGroup( QStringLiteral( "no:way" ), true ) );
+    QVERIFY( accounts.addGroup( QStringLiteral( "video" ), true ) );
+    QVERIFY( accounts.addGroup( QStringLiteral( "sudo" ), true ) );
+    QVERIFY( accounts.addGroup( QStringLiteral( "users" ), false ) );
+    QVERIFY( accounts.hasGroup( QStringLiteral( "video" ) ) );
+    QVERIFY( accounts.save() );
+
+    // System groups from the top down, others from GID_MIN
+    const QByteArray group = readTarget( dir, "etc/group" );
+    QVERIFY( group.startsWith( "root:x:0:\n" ) );
+    QVERIFY( group.contains( "\nvideo:x:999:\n" ) );
+    QVERIFY( group.contains( "\nsudo:x:998:\n" ) );
+    QVERIFY( group.contains( "\nusers:x:1000:\n" ) );
+    QVERIFY( readTarget( dir, "etc/gshadow" ).contains( "\nvideo:!::\n" ) );
+}
+
+void
+AccountDatabaseTests::testAddUser()
+{
+#ifdef __FreeBSD__
+    QSKIP( "Accounts are not edited on FreeBSD" );
+#endif
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    QVERIFY( createTarget( dir ) );
+    QVERIFY( writeFile( QDir( dir.path() ).filePath( "etc/default/useradd" ), "SHELL=/bin/sh\nHOME=/srv/home/\n" ) );
+
+    AccountDatabase accounts( dir.path() );
+    QVERIFY( accounts.isValid() );
+    QVERIFY( !accounts.addUser( QStringLiteral( "root" ), QString(), QString() ) );
+    QVERIFY( !accounts.addUser( QStringLiteral( "wheel" ), QString(), QString() ) );  // Clashes with the group
+    QVERIFY( accounts.addUser( QStringLiteral( "alice" ), QStringLiteral( "Alice" ), QString() ) );
+    QVERIFY( accounts.addUser( QStringLiteral( "bob" ), QStringLiteral( "Bob" ), QStringLiteral( "/bin/zsh" ) ) );
+
+    QCOMPARE( accounts.userId( QStringLiteral( "alice" ) ), 1000 );
+    QCOMPARE( accounts.groupId( QStringLiteral( "alice" ) ), 1000 );
+    QCOMPARE( accounts.userId( QStringLiteral( "bob" ) ), 1001 );
+    QCOMPARE( accounts.userId( QStringLiteral( "carol" ) ), -1 );
+    // HOME from /etc/default/useradd
+    QCOMPARE( accounts.homeDirectory( QStringLiteral( "alice" ) ), QStringLiteral( "/srv/home/alice" ) );
+    QCOMPARE( accounts.homeDirectory( QStringLiteral( "root" ) ), QStringLiteral( "/root" ) );
+    QCOMPARE( accounts.homeDirectory( QStringLiteral( "carol" ) ), QString() );
+
+    QVERIFY( !accounts.addToGroups( QStringLiteral( "alice" ), { QStringLiteral( "video" ) } ) );
+    QVERIFY(
+        accounts.addToGroups( QStringLiteral( "alice" ), { QStringLiteral( "wheel" ), QStringLiteral( "audio" ) } ) );
+    QVERIFY( !accounts.setPasswordHash( QStringLiteral( "carol" ), QStringLiteral( "$6$x" ) ) );
+    QVERIFY( accounts.setPasswordHash( QStringLiteral( "alice" ), QStringLiteral( "$6$salt$hash" ) ) );
+    QVERIFY( accounts.setPasswordHash( QStringLiteral( "root" ), QString() ) );
+}
+
+void
+AccountDatabaseTests::testSave()
+{
+#ifdef __FreeBSD__
+    QSKIP( "Accounts are not edited on FreeBSD" );
+#endif
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    QVERIFY( createTarget( dir ) );
+    const QString shadowPath = QDir( dir.path() ).filePath( "etc/shadow" );
+    QVERIFY( QFile::setPermissions( shadowPath, QFileDevice::ReadOwner | QFileDevice::WriteOwner ) );
+
+    {
+        AccountDatabase accounts( dir.path() );
+        QVERIFY( accounts.addUser( QStringLiteral( "alice" ), QStringLiteral( "Alice" ), QString() ) );
+        QVERIFY( accounts.addToGroups( QStringLiteral( "alice" ), { QStringLiteral( "audio" ) } ) );
+        QVERIFY( accounts.setPasswordHash( QStringLiteral( "alice" ), QStringLiteral( "$6$salt$hash" ) ) );
+        QVERIFY( accounts.setPasswordHash( QStringLiteral( "root" ), QString() ) );
+
+        // Nothing is written until save()
+        QVERIFY( !readTarget( dir, "etc/passwd" ).contains( "alice" ) );
+        QVERIFY( accounts.save() );
+    }
+
+    const QByteArray passwd = readTarget( dir, "etc/passwd" );
+    QVERIFY( passwd.startsWith( "root:x:0:0:root:/root:/bin/bash\n" ) );
+    QVERIFY( passwd.endsWith( "\nalice:x:1000:1000:Alice:/home/alice:/bin/sh\n" ) );
+
+    const QByteArray group = readTarget( dir, "etc/group" );
+    QVERIFY( group.contains( "\naudio:x:29:pulse,alice\n" ) );
+    QVERIFY( group.endsWith( "\nalice:x:1000:\n" ) );
+    QVERIFY( readTarget( dir, "etc/gshadow" ).contains( "\naudio:*::pulse,alice\n" ) );
+
+    const QByteArray shadow = readTarget( dir, "etc/shadow" );
+    QVERIFY( shadow.startsWith( "root:!:18000:" ) );
+    QVERIFY( shadow.contains( "\nalice:$6$salt$hash:" ) );
+    QVERIFY( shadow.endsWith( ":99999::::\n" ) );
+    QCOMPARE( QFile::permissions( shadowPath ) & 0x0077, QFileDevice::Permissions() );  // Not readable by others
+
+    // No temporary files left behind
+    QVERIFY( !QFile::exists( shadowPath + '+' ) );
+
+    // The new files can be read again
+    AccountDatabase again( dir.path() );
+    QVERIFY( again.isValid() );
+    QVERIFY( again.hasUser( QStringLiteral( "alice" ) ) );
+    QCOMPARE( again.userId( QStringLiteral( "alice" ) ), 1000 );
+}
+
+
+QTEST_GUILESS_MAIN( AccountDatabaseTests )
+
+#include "utils/moc-warnings.h"
+
+#include "TestAccountDatabase.moc"
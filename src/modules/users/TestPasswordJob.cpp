@@ -21,6 +21,7 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testSalt();
+    void testSetting();
 };
 
 PasswordTests::PasswordTests() {}
@@ -48,6 +49,27 @@ PasswordTests::testSalt()
     qDebug() << "Obtained salt" << s;
 }
 
+void
+PasswordTests::testSetting()
+{
+    QString s = SetPasswordJob::make_setting( SetPasswordJob::HashMethod::SHA512, 0 );
+    QCOMPARE( s.length(), 4 + 16 );
+    QVERIFY( s.startsWith( "$6$" ) );
+
+    s = SetPasswordJob::make_setting( SetPasswordJob::HashMethod::SHA512, 10000 );
+    QVERIFY( s.startsWith( "$6$rounds=10000$" ) );
+    QCOMPARE( s.length(), 16 + 16 + 1 );
+
+    // Falls back to SHA512 if yescrypt is not supported
+    s = SetPasswordJob::make_setting( SetPasswordJob::HashMethod::Yescrypt, 0 );
+    QVERIFY( s.startsWith( "$y$" ) || s.startsWith( "$6$" ) );
+    qDebug() << "Obtained setting" << s;
+
+    bool ok = false;
+    QCOMPARE( SetPasswordJob::hashMethodNames().find( "yescrypt", ok ), SetPasswordJob::HashMethod::Yescrypt );
+    QVERIFY( ok );
+}
+
 QTEST_GUILESS_MAIN( PasswordTests )
 
 #include "utils/moc-warnings.h"
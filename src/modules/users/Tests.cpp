@@ -274,13 +274,15 @@ UserTests::testUserPassword()
         QVERIFY( c.userPassword().isEmpty() );
         QVERIFY( c.userPasswordSecondary().isEmpty() );
         // There are no validity checks, so no check for nonempty
-        QCOMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
+        // (but the password is invalid until the checker is done)
+        QCOMPARE( c.userPasswordValidity(), Config::PasswordValidity::Invalid );
+        QTRY_COMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
 
         c.setUserPassword( "bogus" );
         QCOMPARE( c.userPasswordValidity(), Config::PasswordValidity::Invalid );
         QCOMPARE( c.userPassword(), "bogus" );
         c.setUserPasswordSecondary( "bogus" );
-        QCOMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
+        QTRY_COMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
     }
 
     {
@@ -301,12 +303,12 @@ UserTests::testUserPassword()
         QVERIFY( c.userPassword().isEmpty() );
         QVERIFY( c.userPasswordSecondary().isEmpty() );
         // There is now a nonempty check, but weak passwords are ok
-        QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Weak ) );
+        QTRY_COMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Weak ) );
 
         c.setUserPassword( "bogus" );
         QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Invalid ) );
         c.setUserPasswordSecondary( "bogus" );
-        QCOMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Weak ) );
+        QTRY_COMPARE( c.userPasswordValidity(), int( Config::PasswordValidity::Weak ) );
 
         QVERIFY( !c.requireStrongPasswords() );
         c.setRequireStrongPasswords( true );
@@ -319,7 +321,7 @@ UserTests::testUserPassword()
     {
         Config c;
         QVERIFY( c.userPassword().isEmpty() );
-        QCOMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
+        QTRY_COMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
 
         QSignalSpy spy_pwChanged( &c, &Config::userPasswordChanged );
         QSignalSpy spy_pwSecondaryChanged( &c, &Config::userPasswordSecondaryChanged );
@@ -334,8 +336,11 @@ UserTests::testUserPassword()
         c.setUserPasswordSecondary( "sugob" );
         QCOMPARE( spy_pwChanged.count(), 2 );
         QCOMPARE( spy_pwSecondaryChanged.count(), 1 );
-        QCOMPARE( spy_pwStatusChanged.count(), 3 );
+        // Matching passwords are checked in the background
+        QCOMPARE( spy_pwStatusChanged.count(), 2 );
+        QTRY_COMPARE( spy_pwStatusChanged.count(), 3 );
         QCOMPARE( c.userPasswordValidity(), Config::PasswordValidity::Valid );
+        QCOMPARE( spy_pwStatusChanged.last().at( 0 ).toInt(), int( Config::PasswordValidity::Valid ) );
     }
 }
 
@@ -18,8 +18,10 @@
 #include "Settings.h"
 #include "modulesystem/Requirement.h"
 #include "network/Manager.h"
+#include "partition/Disks.h"
 #include "utils/CalamaresUtilsGui.h"
 #include "utils/CalamaresUtilsSystem.h"
+#include "utils/HostInfo.h"
 #include "utils/Logger.h"
 #include "utils/Retranslator.h"
 #include "utils/Units.h"
@@ -31,14 +33,13 @@
 
 #include <QDBusConnection>
 #include <QDBusInterface>
-#include <QDir>
-#include <QFile>
-#include <QFileInfo>
 #include <QGuiApplication>
 #include <QScreen>
 
 #include <unistd.h>  //geteuid
 
+#include <algorithm>
+
 GeneralRequirements::GeneralRequirements( QObject* parent )
     : QObject( parent )
     , m_requiredStorageGiB( -1 )
@@ -331,8 +332,17 @@ GeneralRequirements::setConfigurationMap( const QVariantMap& configurationMap )
 bool
 GeneralRequirements::checkEnoughStorage( qint64 requiredSpace )
 {
+    // The kernel's list of disks is enough to know their sizes;
+    // libparted opens (and probes) every device.
+    const auto disks = CalamaresUtils::Partition::disks();
+    if ( !disks.isEmpty() )
+    {
+        return std::any_of( disks.cbegin(), disks.cend(), [requiredSpace]( const auto& d ) {
+            return d.isInstallTarget() && d.size >= requiredSpace;
+        } );
+    }
+
 #ifdef WITHOUT_LIBPARTED
-    Q_UNUSED( requiredSpace )
     cWarning() << "GeneralRequirements is configured without libparted.";
     return false;
 #else
@@ -354,29 +364,7 @@ GeneralRequirements::checkEnoughRam( qint64 requiredRam )
 bool
 GeneralRequirements::checkBatteryExists()
 {
-    const QFileInfo basePath( "/sys/class/power_supply" );
-
-    if ( !( basePath.exists() && basePath.isDir() ) )
-    {
-        return false;
-    }
-
-    QDir baseDir( basePath.absoluteFilePath() );
-    const auto entries = baseDir.entryList( QDir::AllDirs | QDir::Readable | QDir::NoDotAndDotDot );
-    for ( const auto& item : entries )
-    {
-        QFileInfo typePath( baseDir.absoluteFilePath( QString( "%1/type" ).arg( item ) ) );
-        QFile typeFile( typePath.absoluteFilePath() );
-        if ( typeFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
-        {
-            if ( typeFile.readAll().startsWith( "Battery" ) )
-            {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    return CalamaresUtils::hostInfo().hasBattery;
 }
 
 